@@ -9,6 +9,9 @@ set(CMAKE_POSITION_INDEPENDENT_CODE ON)
 
 option(ENABLE_PACKAGE_BUILD "Build package using Conan" OFF)
 option(ENABLE_TESTS "Build unit tests" OFF)
+option(ENABLE_BENCHMARKS "Build benchmarks" OFF)
+option(ENABLE_CLI "Build the musher-analyze command-line analyzer" ON)
+option(ENABLE_INSTRUMENTATION "Time the stages of the key pipeline (see src/core/instrumentation.h)" OFF)
 
 if(NOT CMAKE_BUILD_TYPE OR CMAKE_BUILD_TYPE STREQUAL "")
     string(REGEX MATCH "release|debug" _match ${CMAKE_BINARY_DIR})
@@ -10,6 +10,7 @@ class MusherConan(ConanFile):
 
     def requirements(self):
         self.requires("gtest/[>=1.10.0]")
+        self.requires("benchmark/[>=1.5.2]")
         # self.requires("functionalplus/v0.2.10-p0@dobiasd/stable")
 
     def set_version(self):
@@ -351,6 +351,22 @@ def extra_compile_args() -> list:
     return args
 
 
+def define_macros() -> list:
+    """Preprocessor definitions
+
+    Set MUSHER_INSTRUMENTATION=1 in the environment to build with the per-stage timings of
+    src/core/instrumentation.h compiled in.
+
+    Returns:
+        list: Macros as (name, value) tuples
+    """
+    macros = []
+    if os.environ.get('MUSHER_INSTRUMENTATION', '0') not in ('', '0'):
+        macros += [('MUSHER_INSTRUMENTATION', None)]
+
+    return macros
+
+
 def extra_link_args() -> list:
     """Platform dependent extras
 
@@ -362,6 +378,10 @@ def extra_link_args() -> list:
         # Something with OS X Mojave causes libstd not to be found
         args += ['-stdlib=libc++', '-mmacosx-version-min=10.12']
 
+    if os.name != 'nt':
+        # Batch processing runs on std::thread.
+        args += ['-pthread']
+
     return args
 
 
@@ -386,11 +406,23 @@ setup(
                  'src/core/key.cpp',
                  'src/core/hpcp.cpp',
                  'src/core/framecutter.cpp',
+                 'src/core/streaming_framecutter.cpp',
                  'src/core/windowing.cpp',
                  'src/core/peak_detect.cpp',
                  'src/core/spectral_peaks.cpp',
                  'src/core/spectrum.cpp',
-                 'src/core/mono_mixer.cpp'
+                 'src/core/mono_mixer.cpp',
+                 'src/core/resample.cpp',
+                 'src/core/batch.cpp',
+                 'src/core/fft_convolve.cpp',
+                 'src/core/bpm.cpp',
+                 'src/core/onset.cpp',
+                 'src/core/analyze.cpp',
+                 'src/core/beat_tracker.cpp',
+                 'src/core/threading.cpp',
+                 'src/core/audio_buffer.cpp',
+                 'src/core/instrumentation.cpp',
+                 'src/core/trace.cpp'
              ],
              depends=[
                  'src/python/module.h',
@@ -401,12 +433,26 @@ setup(
                  'src/core/key.h'
                  'src/core/hpcp.h',
                  'src/core/framecutter.h',
+                 'src/core/streaming_framecutter.h',
                  'src/core/windowing.h',
                  'src/core/peak_detect.h',
                  'src/core/spectral_peaks.h',
                  'src/core/spectrum.h',
-                 'src/core/mono_mixer.h'
+                 'src/core/mono_mixer.h',
+                 'src/core/resample.h',
+                 'src/core/batch.h',
+                 'src/core/fft_convolve.h',
+                 'src/core/bpm.h',
+                 'src/core/onset.h',
+                 'src/core/analyze.h',
+                 'src/core/beat_tracker.h',
+                 'src/core/threading.h',
+                 'src/core/span.h',
+                 'src/core/audio_buffer.h',
+                 'src/core/instrumentation.h',
+                 'src/core/trace.h'
              ],
+             define_macros=define_macros(),
              extra_compile_args=extra_compile_args(),
              extra_link_args=extra_link_args(),
          )
@@ -0,0 +1,287 @@
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "src/core/analyze.h"
+#include "src/core/audio_decoders.h"
+#include "src/core/key.h"
+#include "src/core/threading.h"
+#include "src/core/trace.h"
+#include "src/core/utils.h"
+
+using namespace musher::core;
+
+namespace {
+
+const char* kUsage = R"(Usage: musher-analyze [options] PATH...
+
+Detect the key and the tempo of .wav and .mp3 files, searching directories recursively. Prints one JSON object per
+file on stdout as soon as it is analysed (in completion order), and the throughput on stderr once done.
+
+Options:
+  -j, --threads N   Number of files analysed in parallel (default: number of hardware threads).
+  --key-only        Only detect the key, skipping the tempo.
+  --profile NAME    Key profile, see DetectKey (default: Bgate).
+  --trace FILE      Write a Chrome trace of the run to FILE (needs a build with ENABLE_INSTRUMENTATION).
+  -h, --help        Show this message.
+)";
+
+struct Options {
+  std::vector<std::string> paths;
+  unsigned int num_threads = 0;
+  bool key_only = false;
+  std::string profile_type = "Bgate";
+  std::string trace_path;
+  bool help = false;
+};
+
+/**
+ * @brief Parse the command line, returns false if no path was given.
+ */
+bool ParseOptions(int argc, char** argv, Options& options) {
+  for (int i = 1; i < argc; i++) {
+    const std::string arg = argv[i];
+    auto value = [&]() -> std::string {
+      if (i + 1 >= argc) throw std::runtime_error("Missing value for " + arg + ".");
+      return argv[++i];
+    };
+    if (arg == "-h" || arg == "--help") {
+      options.help = true;
+      return true;
+    } else if (arg == "-j" || arg == "--threads") {
+      const std::string num_threads = value();
+      char* end = nullptr;
+      const long parsed = std::strtol(num_threads.c_str(), &end, 10);
+      if (num_threads.empty() || *end != '\0' || parsed < 0) {
+        throw std::runtime_error("Invalid number of threads: " + num_threads + ".");
+      }
+      options.num_threads = static_cast<unsigned int>(parsed);
+    } else if (arg == "--key-only") {
+      options.key_only = true;
+    } else if (arg == "--profile") {
+      options.profile_type = value();
+    } else if (arg == "--trace") {
+      // Without instrumentation no stage is ever recorded, so the trace would silently come out empty.
+      if (!InstrumentationCompiled()) {
+        throw std::runtime_error("--trace needs a build with ENABLE_INSTRUMENTATION, this one records no stages.");
+      }
+      options.trace_path = value();
+    } else if (!arg.empty() && arg[0] == '-') {
+      throw std::runtime_error("Unknown option: " + arg + ".");
+    } else {
+      options.paths.push_back(arg);
+    }
+  }
+  return !options.paths.empty();
+}
+
+bool IsDirectory(const std::string& path) {
+  struct stat info;
+  return stat(path.c_str(), &info) == 0 && (info.st_mode & S_IFMT) == S_IFDIR;
+}
+
+bool IsAudioFile(const std::string& path) {
+  const size_t dot = path.rfind('.');
+  if (dot == std::string::npos) return false;
+  std::string extension = path.substr(dot + 1);
+  std::transform(extension.begin(), extension.end(), extension.begin(),
+                 [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+  return extension == "wav" || extension == "mp3";
+}
+
+/**
+ * @brief Names of the entries of a directory, without "." and "..".
+ */
+std::vector<std::string> ListDirectory(const std::string& directory) {
+  std::vector<std::string> names;
+#ifdef _WIN32
+  WIN32_FIND_DATAA find_data;
+  HANDLE handle = FindFirstFileA((directory + "\\*").c_str(), &find_data);
+  if (handle == INVALID_HANDLE_VALUE) throw std::runtime_error("Could not open directory: " + directory);
+  do {
+    names.push_back(find_data.cFileName);
+  } while (FindNextFileA(handle, &find_data));
+  FindClose(handle);
+#else
+  DIR* dir = opendir(directory.c_str());
+  if (!dir) throw std::runtime_error("Could not open directory: " + directory);
+  while (const dirent* entry = readdir(dir)) names.push_back(entry->d_name);
+  closedir(dir);
+#endif
+  names.erase(std::remove_if(names.begin(), names.end(),
+                             [](const std::string& name) { return name == "." || name == ".."; }),
+              names.end());
+  return names;
+}
+
+/**
+ * @brief Add the audio files of a path to file_paths, walking directories recursively in name order.
+ */
+void CollectAudioFiles(const std::string& path, std::vector<std::string>& file_paths) {
+  if (!IsDirectory(path)) {
+    // Explicitly listed files are always analysed, so an unsupported one shows up as an error.
+    file_paths.push_back(path);
+    return;
+  }
+  std::vector<std::string> names = ListDirectory(path);
+  std::sort(names.begin(), names.end());
+  const std::string prefix = path.back() == '/' ? path : path + "/";
+  for (const std::string& name : names) {
+    const std::string entry_path = prefix + name;
+    if (IsDirectory(entry_path)) {
+      CollectAudioFiles(entry_path, file_paths);
+    } else if (IsAudioFile(entry_path)) {
+      file_paths.push_back(entry_path);
+    }
+  }
+}
+
+/**
+ * @brief Write a number as JSON, null if it is not finite.
+ */
+void WriteJsonNumber(std::ostream& output, double number) {
+  if (std::isfinite(number)) {
+    output << number;
+  } else {
+    output << "null";
+  }
+}
+
+/**
+ * @brief Result of the analysis of a file as a single line of JSON.
+ */
+std::string AnalysisToJsonLine(const std::string& file_path,
+                               double duration,
+                               double seconds,
+                               const TrackAnalysis& analysis,
+                               bool key_only) {
+  std::ostringstream line;
+  line.precision(10);
+  line << "{\"file\":" << JsonQuote(file_path) << ",\"ok\":true,\"duration\":";
+  WriteJsonNumber(line, duration);
+  line << ",\"seconds\":";
+  WriteJsonNumber(line, seconds);
+  line << ",\"key\":" << JsonQuote(analysis.key) << ",\"scale\":" << JsonQuote(analysis.scale) << ",\"strength\":";
+  WriteJsonNumber(line, analysis.strength);
+  line << ",\"first_to_second_relative_strength\":";
+  WriteJsonNumber(line, analysis.first_to_second_relative_strength);
+  line << ",\"frames_processed\":" << analysis.frames_processed;
+  if (!key_only) {
+    line << ",\"bpm\":";
+    WriteJsonNumber(line, analysis.bpm);
+    line << ",\"beats\":" << analysis.beat_times.size();
+  }
+  line << "}";
+  return line.str();
+}
+
+std::string ErrorToJsonLine(const std::string& file_path, const std::string& error) {
+  return "{\"file\":" + JsonQuote(file_path) + ",\"ok\":false,\"error\":" + JsonQuote(error) + "}";
+}
+
+int Run(const Options& options) {
+  std::vector<std::string> file_paths;
+  for (const std::string& path : options.paths) CollectAudioFiles(path, file_paths);
+  if (file_paths.empty()) {
+    std::cerr << "musher-analyze: No .wav or .mp3 files found." << std::endl;
+    return 1;
+  }
+
+  std::shared_ptr<Tracer> tracer;
+  if (!options.trace_path.empty()) {
+    tracer = std::make_shared<Tracer>();
+    SetTracer(tracer);
+  }
+
+  std::mutex output_mutex;
+  std::atomic<size_t> next_file(0);
+  std::atomic<size_t> num_failed(0);
+  std::atomic<uint64_t> audio_microseconds(0);
+  const auto start = std::chrono::steady_clock::now();
+
+  // One range per worker, every worker then takes the next file as it frees up so long files do not hold up the rest.
+  const unsigned int num_threads =
+      static_cast<unsigned int>(std::min<size_t>(ResolveNumThreads(options.num_threads), file_paths.size()));
+  ParallelFor(num_threads, num_threads, [&](size_t, size_t) {
+    for (size_t i = next_file++; i < file_paths.size(); i = next_file++) {
+      const std::string& file_path = file_paths[i];
+      std::string line;
+      try {
+        TraceFileScope trace_file(file_path);
+        const auto file_start = std::chrono::steady_clock::now();
+        double sample_rate = 0.;
+        AudioBuffer mono_samples;
+        {
+          std::vector<uint8_t> file_data = LoadAudioFile(file_path);
+          mono_samples = DecodeMonoFromData(file_path, file_data, sample_rate);
+        }
+        TrackAnalysis analysis;
+        if (options.key_only) {
+          static_cast<KeyOutput&>(analysis) = DetectKey(mono_samples.channel(0), sample_rate, options.profile_type);
+        } else {
+          analysis = AnalyzeTrack(mono_samples.channel(0), sample_rate, options.profile_type);
+        }
+        const double duration = static_cast<double>(mono_samples.frames()) / sample_rate;
+        const double seconds =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - file_start).count();
+        audio_microseconds += static_cast<uint64_t>(duration * 1e6);
+        line = AnalysisToJsonLine(file_path, duration, seconds, analysis, options.key_only);
+      } catch (const std::exception& e) {
+        num_failed++;
+        line = ErrorToJsonLine(file_path, e.what());
+      }
+      std::lock_guard<std::mutex> lock(output_mutex);
+      std::cout << line << std::endl;
+    }
+  });
+
+  const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  const double audio_hours = static_cast<double>(audio_microseconds) * 1e-6 / 3600.;
+  std::cerr << "Analyzed " << file_paths.size() << " files (" << num_failed << " failed, " << audio_hours
+            << " hours of audio) in " << seconds << " s with " << num_threads << " threads: "
+            << static_cast<double>(file_paths.size()) / seconds << " files/s, " << audio_hours / seconds
+            << " audio-hours/s" << std::endl;
+
+  if (tracer) {
+    SetTracer(nullptr);
+    const size_t num_events = tracer->write_json(options.trace_path);
+    std::cerr << "Wrote " << num_events << " trace events to " << options.trace_path << std::endl;
+  }
+  return num_failed == 0 ? 0 : 1;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options options;
+  try {
+    if (!ParseOptions(argc, argv, options) || options.help) {
+      std::cerr << kUsage;
+      return options.help ? 0 : 2;
+    }
+    return Run(options);
+  } catch (const std::exception& e) {
+    std::cerr << "musher-analyze: " << e.what() << std::endl;
+    return 2;
+  }
+}
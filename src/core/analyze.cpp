@@ -0,0 +1,86 @@
+#include "src/core/analyze.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "src/core/audio_decoders.h"
+#include "src/core/beat_tracker.h"
+#include "src/core/bpm.h"
+#include "src/core/key.h"
+#include "src/core/onset.h"
+#include "src/core/trace.h"
+#include "src/core/windowing.h"
+
+namespace musher {
+namespace core {
+
+namespace {
+
+/**
+ * @brief Number of adjacent spectrum bins summed into one band of the onset strength.
+ *
+ * Tempo only needs coarse frequency resolution, and compressing a few hundred bands instead of every bin keeps the
+ * onset envelope cheap next to the HPCP.
+ */
+const size_t kOnsetBinsPerBand = 16;
+
+/**
+ * @brief Sum consecutive groups of bins_per_band bins of a spectrum into bands, the remaining bins are dropped.
+ */
+void SumBands(const std::vector<double>& spectrum, size_t bins_per_band, std::vector<double>& bands) {
+  bands.assign(spectrum.size() / bins_per_band, 0.);
+  for (size_t band = 0; band < bands.size(); band++) {
+    const size_t first_bin = band * bins_per_band;
+    for (size_t bin = first_bin; bin < first_bin + bins_per_band; bin++) bands[band] += spectrum[bin];
+  }
+}
+
+}  // namespace
+
+TrackAnalysis AnalyzeTrack(Span<const double> mono_samples,
+                           double sample_rate,
+                           const std::string profile_type,
+                           const int frame_size,
+                           const int hop_size,
+                           double min_bpm,
+                           double max_bpm) {
+  OnsetStrength onset_strength;
+  std::vector<double> bands;
+  // The spectra DetectKey computes for the HPCP are the only ones taken, the onset envelope reuses them.
+  auto accumulate_onset = [&onset_strength, &bands](const std::vector<double>& spectrum) {
+    SumBands(spectrum, kOnsetBinsPerBand, bands);
+    onset_strength.process(bands);
+  };
+
+  TrackAnalysis track_analysis;
+  KeyOutput& key_output = track_analysis;
+  key_output = DetectKey(mono_samples, sample_rate, profile_type, true, true, 4, 0.6, false, 36, frame_size, hop_size,
+                         BlackmanHarris62dB, 100, .5, 0, 3, 0.01, 0., accumulate_onset);
+
+  const double frame_rate = sample_rate / static_cast<double>(hop_size);
+  const std::vector<double>& onset_envelope = onset_strength.envelope();
+  track_analysis.bpm = BPMFromOnsetStrength(onset_envelope, frame_rate, min_bpm, max_bpm);
+  if (track_analysis.bpm > 0.) track_analysis.beat_times = BeatTrack(onset_envelope, frame_rate, track_analysis.bpm);
+  return track_analysis;
+}
+
+TrackAnalysis AnalyzeTrack(const std::string& file_path,
+                           const std::string profile_type,
+                           const int frame_size,
+                           const int hop_size,
+                           double min_bpm,
+                           double max_bpm) {
+  TraceFileScope trace_file(file_path);
+  double sample_rate = 0.;
+  AudioBuffer mono_samples;
+  {
+    // Only the mono mix is kept, the encoded file is freed before the analysis.
+    std::vector<uint8_t> file_data = LoadAudioFile(file_path);
+    mono_samples = DecodeMonoFromData(file_path, file_data, sample_rate);
+  }
+  return AnalyzeTrack(mono_samples.channel(0), sample_rate, profile_type, frame_size, hop_size, min_bpm, max_bpm);
+}
+
+}  // namespace core
+}  // namespace musher
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "src/core/key.h"
+#include "src/core/span.h"
+
+namespace musher {
+namespace core {
+
+/**
+ * @brief Key and tempo of a track.
+ *
+ */
+struct TrackAnalysis : KeyOutput {
+  double bpm = 0.;                 //!< Tempo in beats per minute (0 if no tempo could be found).
+  std::vector<double> beat_times;  //!< Time of every beat \[Seconds\], see BeatTrack.
+};
+
+/**
+ * @brief Detect the key and the tempo of a track in a single pass over its frames.
+ *
+ * Every frame is cut, windowed and transformed once. Its magnitude spectrum feeds both the HPCP accumulator of the
+ * key detection and an onset strength envelope, whose autocorrelation gives the tempo and which the beats are tracked
+ * on. Calling DetectKey and a BPM detector separately would frame and transform the audio (or decode it) twice.
+ *
+ * @param mono_samples Single channel of normalized samples.
+ * @param sample_rate Sampling rate of the audio signal \[Hz\].
+ * @param profile_type The type of polyphic profile to use for key correlation calculation, see DetectKey.
+ * @param frame_size Number of samples in each frame.
+ * @param hop_size Number of samples between the starts of consecutive frames.
+ * @param min_bpm Lowest tempo that can be detected.
+ * @param max_bpm Highest tempo that can be detected.
+ * @return TrackAnalysis Key, scale, strength, tempo and beats of the track.
+ */
+TrackAnalysis AnalyzeTrack(Span<const double> mono_samples,
+                           double sample_rate,
+                           const std::string profile_type = "Bgate",
+                           const int frame_size = 4096,
+                           const int hop_size = 512,
+                           double min_bpm = 40.,
+                           double max_bpm = 220.);
+
+/**
+ * @brief Overloaded AnalyzeTrack that decodes a .wav or .mp3 file, mixing it down to mono while decoding.
+ *
+ * @param file_path Path of the audio file.
+ * @param profile_type The type of polyphic profile to use for key correlation calculation, see DetectKey.
+ * @param frame_size Number of samples in each frame.
+ * @param hop_size Number of samples between the starts of consecutive frames.
+ * @param min_bpm Lowest tempo that can be detected.
+ * @param max_bpm Highest tempo that can be detected.
+ * @return TrackAnalysis Key, scale, strength, tempo and beats of the track.
+ */
+TrackAnalysis AnalyzeTrack(const std::string& file_path,
+                           const std::string profile_type = "Bgate",
+                           const int frame_size = 4096,
+                           const int hop_size = 512,
+                           double min_bpm = 40.,
+                           double max_bpm = 220.);
+
+}  // namespace core
+}  // namespace musher
@@ -0,0 +1,81 @@
+#include "src/core/audio_buffer.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace musher {
+namespace core {
+
+constexpr size_t AudioBuffer::kAlignment;
+
+AudioBuffer::AudioBuffer(size_t channels, size_t frames) : data_(nullptr), channels_(channels), frames_(frames) {
+  if (size() == 0) return;
+  // Over-allocate by one alignment so the first sample can be moved up to the next boundary.
+  const size_t padding = kAlignment / sizeof(double);
+  storage_.reset(new double[size() + padding]());
+  const uintptr_t address = reinterpret_cast<uintptr_t>(storage_.get());
+  const uintptr_t aligned_address = (address + kAlignment - 1) & ~static_cast<uintptr_t>(kAlignment - 1);
+  data_ = storage_.get() + (aligned_address - address) / sizeof(double);
+}
+
+AudioBuffer::AudioBuffer(const AudioBuffer &other) : AudioBuffer(other.channels_, other.frames_) {
+  std::copy(other.data_, other.data_ + other.size(), data_);
+}
+
+AudioBuffer &AudioBuffer::operator=(const AudioBuffer &other) {
+  if (this != &other) *this = AudioBuffer(other);
+  return *this;
+}
+
+AudioBuffer::AudioBuffer(AudioBuffer &&other) noexcept
+    : storage_(std::move(other.storage_)), data_(other.data_), channels_(other.channels_), frames_(other.frames_) {
+  other.data_ = nullptr;
+  other.channels_ = 0;
+  other.frames_ = 0;
+}
+
+AudioBuffer &AudioBuffer::operator=(AudioBuffer &&other) noexcept {
+  storage_ = std::move(other.storage_);
+  data_ = other.data_;
+  channels_ = other.channels_;
+  frames_ = other.frames_;
+  other.data_ = nullptr;
+  other.channels_ = 0;
+  other.frames_ = 0;
+  return *this;
+}
+
+AudioBuffer AudioBuffer::FromInterleaved(Span<const double> interleaved, size_t channels) {
+  if (channels == 0 || interleaved.size() % channels != 0) {
+    throw std::runtime_error("Interleaved samples must hold the same number of samples for every channel.");
+  }
+  AudioBuffer buffer(channels, interleaved.size() / channels);
+  const double *frame = interleaved.data();
+  for (size_t i = 0; i < buffer.frames_; i++, frame += channels) {
+    for (size_t c = 0; c < channels; c++) buffer.data_[c * buffer.frames_ + i] = frame[c];
+  }
+  return buffer;
+}
+
+std::vector<Span<const double>> AudioBuffer::channel_spans() const {
+  std::vector<Span<const double>> spans;
+  spans.reserve(channels_);
+  for (size_t c = 0; c < channels_; c++) spans.push_back(channel(c));
+  return spans;
+}
+
+std::vector<double> AudioBuffer::interleaved() const {
+  std::vector<double> output(size());
+  for (size_t c = 0; c < channels_; c++) {
+    const double *samples = data_ + c * frames_;
+    for (size_t i = 0; i < frames_; i++) output[i * channels_ + c] = samples[i];
+  }
+  return output;
+}
+
+}  // namespace core
+}  // namespace musher
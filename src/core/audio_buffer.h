@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "src/core/span.h"
+
+namespace musher {
+namespace core {
+
+/**
+ * @brief Multichannel audio in a single aligned allocation.
+ *
+ * Samples are planar: channel c holds frames() samples starting at data() + c * frames(). Every channel starts on a
+ * kAlignment byte boundary when frames() is a multiple of kAlignment / sizeof(double), and always does for channel 0,
+ * so channels can be handed to FFT or SIMD code and to numpy as they are.
+ *
+ * @code
+ *   AudioBuffer buffer(2, 44100);
+ *   for (size_t c = 0; c < buffer.channels(); c++) FillChannel(buffer.channel(c));
+ *   std::vector<double> mixed = MonoMixer(buffer);
+ * @endcode
+ */
+class AudioBuffer {
+ private:
+  std::unique_ptr<double[]> storage_;
+  double *data_;
+  size_t channels_;
+  size_t frames_;
+
+ public:
+  using value_type = double;
+
+  static constexpr size_t kAlignment = 64;  //!< Alignment of the first sample \[bytes\].
+
+  AudioBuffer() : data_(nullptr), channels_(0), frames_(0) {}
+
+  /**
+   * @brief Construct a new AudioBuffer object with every sample set to 0.
+   *
+   * @param channels Number of channels.
+   * @param frames Number of samples per channel.
+   */
+  AudioBuffer(size_t channels, size_t frames);
+
+  AudioBuffer(const AudioBuffer &other);
+  AudioBuffer &operator=(const AudioBuffer &other);
+  AudioBuffer(AudioBuffer &&other) noexcept;
+  AudioBuffer &operator=(AudioBuffer &&other) noexcept;
+
+  /**
+   * @brief Deinterleave samples (frame after frame, as decoders and sound cards produce them) into a new buffer.
+   *
+   * @param interleaved Interleaved samples, its size must be a multiple of channels.
+   * @param channels Number of channels.
+   * @return AudioBuffer Planar copy of the samples.
+   */
+  static AudioBuffer FromInterleaved(Span<const double> interleaved, size_t channels);
+
+  size_t channels() const { return channels_; }
+  size_t frames() const { return frames_; }
+  size_t size() const { return channels_ * frames_; }
+  bool empty() const { return size() == 0; }
+
+  double *data() { return data_; }
+  const double *data() const { return data_; }
+
+  /**
+   * @brief View of every sample of a channel.
+   */
+  Span<double> channel(size_t index) { return Span<double>(data_ + index * frames_, frames_); }
+  Span<const double> channel(size_t index) const { return Span<const double>(data_ + index * frames_, frames_); }
+
+  /**
+   * @brief View of num_frames samples of a channel, starting at first_frame.
+   */
+  Span<const double> channel(size_t index, size_t first_frame, size_t num_frames) const {
+    return channel(index).subspan(first_frame, num_frames);
+  }
+
+  /**
+   * @brief Views of every channel, in the form MonoMixer takes.
+   */
+  std::vector<Span<const double>> channel_spans() const;
+
+  /**
+   * @brief Copy of the samples interleaved (frame after frame).
+   */
+  std::vector<double> interleaved() const;
+};
+
+}  // namespace core
+}  // namespace musher
@@ -1,15 +1,20 @@
 #include "src/core/audio_decoders.h"
 
 #include <algorithm>
+#include <cctype>
+#include <fstream>
 #include <iostream>
 #include <iterator>
 #include <sstream>
+#include <stdexcept>
 #include <string>
+#include <utility>
 #include <vector>
 
 #define MINIMP3_IMPLEMENTATION
 #include <minimp3/minimp3_ex.h>
 
+#include "src/core/instrumentation.h"
 #include "src/core/utils.h"
 
 namespace musher {
@@ -21,28 +26,24 @@ std::vector<uint8_t> LoadAudioFile(const std::string& file_path) {
   if (file_path.empty()) {
     throw std::runtime_error("No file provided");
   }
-  std::ifstream audio_file(file_path, std::ios::binary);
-
-  // skip white space
-  audio_file.unsetf(std::ios::skipws);
-  std::istream_iterator<uint8_t> begin(audio_file), end;
-  if (audio_file.fail()) {
+  // Open at the end to size the buffer, then read the whole file in one go.
+  std::ifstream audio_file(file_path, std::ios::binary | std::ios::ate);
+  std::streamoff file_size = audio_file.fail() ? -1 : static_cast<std::streamoff>(audio_file.tellg());
+  if (file_size < 0) {
     std::stringstream ss;
     ss << "Failed to load file '" << file_path << "'";
     throw std::runtime_error(ss.str().c_str());
   }
 
-  std::vector<uint8_t> file_data(begin, end);
+  std::vector<uint8_t> file_data(static_cast<size_t>(file_size));
+  audio_file.seekg(0, std::ios::beg);
+  audio_file.read(reinterpret_cast<char*>(file_data.data()), file_size);
+  file_data.resize(static_cast<size_t>(audio_file.gcount()));
   return file_data;
 }
 
-WavDecoded DecodeWav(const std::vector<uint8_t>& file_data) {
-  std::vector<std::vector<double>> samples;
-
-  if (!samples.empty()) {
-    std::string err_message = "Audio Buffer must be empty";
-    throw std::runtime_error(err_message);
-  }
+WavDecoded DecodeWav(Span<const uint8_t> file_data, bool mono_downmix) {
+  MUSHER_STAGE_BEGIN(decode_timer, Stage::kDecode);
   // -----------------------------------------------------------
   // HEADER CHUNK
   std::string header_chunk_id(file_data.begin(), file_data.begin() + 4);
@@ -123,46 +124,60 @@ WavDecoded DecodeWav(const std::vector<uint8_t>& file_data) {
   int num_samples = data_chunk_size / (num_channels * bit_depth / 8);
   int samples_start_index = data_chunk_index + 8;
 
-  samples.resize(num_channels);
-
-  for (int i = 0; i < num_samples; i++) {
-    for (int channel = 0; channel < num_channels; channel++) {
-      int sample_index = samples_start_index + (num_bytes_per_block * i) + channel * num_bytes_per_sample;
-
-      if (bit_depth == 8) {
-        // Normalize samples to between -1 and 1
-        double sample = NormalizeInt8_t(file_data[sample_index]);
-        samples[channel].push_back(sample);
-      } else if (bit_depth == 16) {
-        int16_t sample_as_int = TwoBytesToInt(file_data, sample_index);
-        // Normalize samples to between -1 and 1
-        double sample = NormalizeInt16_t(sample_as_int);
-        samples[channel].push_back(sample);
-      } else if (bit_depth == 24) {
-        int32_t sample_as_int = 0;
-        sample_as_int =
-            (file_data[sample_index + 2] << 16) | (file_data[sample_index + 1] << 8) | file_data[sample_index];
-
-        if (sample_as_int & 0x800000)  // if the 24th bit is set, this is a negative number in 24-bit world
-          sample_as_int = sample_as_int | ~0xFFFFFF;  // so make sure sign is extended to the 32 bit float
-
-        // Normalize samples to between -1 and 1
-        // double sample = NormalizeInt32_t(sample_as_int);
-        double sample = static_cast<double>(sample_as_int);
-        samples[channel].push_back(sample);
-      } else {
-        std::string err_message =
-            "This file has a bit depth that is not 8, 16 or 24 bits, not sure how you got past the first error check.";
-        throw std::runtime_error(err_message);
+  auto decode_sample = [&file_data, bit_depth](int sample_index) -> double {
+    if (bit_depth == 8) {
+      // Normalize samples to between -1 and 1
+      return NormalizeInt8_t(file_data[sample_index]);
+    } else if (bit_depth == 16) {
+      int16_t sample_as_int = TwoBytesToInt(file_data, sample_index);
+      // Normalize samples to between -1 and 1
+      return NormalizeInt16_t(sample_as_int);
+    } else if (bit_depth == 24) {
+      int32_t sample_as_int = 0;
+      sample_as_int =
+          (file_data[sample_index + 2] << 16) | (file_data[sample_index + 1] << 8) | file_data[sample_index];
+
+      if (sample_as_int & 0x800000)  // if the 24th bit is set, this is a negative number in 24-bit world
+        sample_as_int = sample_as_int | ~0xFFFFFF;  // so make sure sign is extended to the 32 bit float
+
+      // Normalize samples to between -1 and 1
+      // double sample = NormalizeInt32_t(sample_as_int);
+      return static_cast<double>(sample_as_int);
+    } else {
+      std::string err_message =
+          "This file has a bit depth that is not 8, 16 or 24 bits, not sure how you got past the first error check.";
+      throw std::runtime_error(err_message);
+    }
+  };
+
+  // Every channel is written straight into one planar buffer, channel after channel.
+  const int num_buffer_channels = mono_downmix ? 1 : static_cast<int>(num_channels);
+  const int num_samples_per_channel = std::max(num_samples, 0);
+  AudioBuffer samples(num_buffer_channels, num_samples_per_channel);
+  double* planar = samples.data();
+  if (mono_downmix) {
+    // Average the channels while converting, so only a single channel is ever allocated.
+    const double channel_weight = 1.0 / num_channels;
+    for (int i = 0; i < num_samples; i++) {
+      int block_index = samples_start_index + (num_bytes_per_block * i);
+      double sum = 0.;
+      for (int channel = 0; channel < num_channels; channel++) {
+        sum += decode_sample(block_index + channel * num_bytes_per_sample);
+      }
+      planar[i] = channel_weight * sum;
+    }
+  } else {
+    for (int i = 0; i < num_samples; i++) {
+      for (int channel = 0; channel < num_channels; channel++) {
+        int sample_index = samples_start_index + (num_bytes_per_block * i) + channel * num_bytes_per_sample;
+        planar[static_cast<size_t>(channel) * num_samples_per_channel + i] = decode_sample(sample_index);
       }
     }
   }
 
   int num_channels_int = static_cast<int>(num_channels);
-  bool mono = num_channels == 1;
-  bool stereo = num_channels == 2;
-  int num_samples_per_channel = 0;
-  if (samples.size() > 0) num_samples_per_channel = static_cast<int>(samples[0].size());
+  bool mono = num_buffer_channels == 1;
+  bool stereo = num_buffer_channels == 2;
   double length_in_seconds = static_cast<double>(num_samples_per_channel) / static_cast<double>(sample_rate);
   std::string file_type = "wav";
   int avg_bitrate_kbps = (sample_rate * bit_depth * num_channels_int) / 1000;
@@ -170,64 +185,135 @@ WavDecoded DecodeWav(const std::vector<uint8_t>& file_data) {
   WavDecoded wav_decoded;
   wav_decoded.sample_rate = sample_rate;
   wav_decoded.bit_depth = bit_depth;
-  wav_decoded.channels = num_channels_int;
+  wav_decoded.channels = num_buffer_channels;
   wav_decoded.mono = mono;
   wav_decoded.stereo = stereo;
   wav_decoded.samples_per_channel = num_samples_per_channel;
   wav_decoded.length_in_seconds = length_in_seconds;
   wav_decoded.file_type = file_type;
   wav_decoded.avg_bitrate_kbps = avg_bitrate_kbps;
-  wav_decoded.normalized_samples = samples;
+  wav_decoded.normalized_samples = std::move(samples);
 
+  MUSHER_STAGE_END(decode_timer, num_samples_per_channel, wav_decoded.normalized_samples.size() * sizeof(double));
   return wav_decoded;
 }
 
-WavDecoded DecodeWav(const std::string& file_path) {
+WavDecoded DecodeWav(const std::string& file_path, bool mono_downmix) {
   std::vector<uint8_t> file_data = LoadAudioFile(file_path);
-  return DecodeWav(file_data);
+  return DecodeWav(file_data, mono_downmix);
 }
 
-Mp3Decoded DecodeMp3(const std::string file_path) {
-  mp3dec_t mp3d;
-  mp3dec_file_info_t info;
-  if (mp3dec_load(&mp3d, file_path.c_str(), &info, NULL, NULL)) {
-    // error
-    throw std::runtime_error("Unable to decode MP3.");
-  }
+namespace {
 
-  std::vector<int32_t> interleaved_samples(info.buffer, info.buffer + info.samples);
-  free(info.buffer);
+/**
+ * @brief Convert the output of minimp3 into Mp3Decoded and release the decoder's buffer.
+ */
+Mp3Decoded ConvertMp3FileInfo(mp3dec_file_info_t& info, bool mono_downmix) {
   int num_samples = static_cast<int>(info.samples);
-  bool mono = info.channels == 1;
-  bool stereo = info.channels == 2;
-  int samples_per_channel;
-  if (stereo) {
-    samples_per_channel = num_samples / 2;
+  int samples_per_channel = info.channels > 0 ? num_samples / info.channels : 0;
+
+  const int channels = mono_downmix ? 1 : info.channels;
+  AudioBuffer samples(channels, samples_per_channel);
+  double* planar = samples.data();
+  const mp3d_sample_t* block = info.buffer;
+  if (mono_downmix) {
+    // Average the channels straight out of the decoder's interleaved buffer.
+    const double channel_weight = 1.0 / info.channels;
+    for (int i = 0; i < samples_per_channel; i++, block += info.channels) {
+      double sum = 0.;
+      for (int channel = 0; channel < info.channels; channel++) {
+        sum += static_cast<double>(block[channel]);
+      }
+      planar[i] = channel_weight * sum;
+    }
   } else {
-    samples_per_channel = static_cast<int>(info.samples);
+    // Deinterleave straight out of the decoder's buffer into the planar one.
+    for (int i = 0; i < samples_per_channel; i++, block += info.channels) {
+      for (int channel = 0; channel < info.channels; channel++) {
+        planar[static_cast<size_t>(channel) * samples_per_channel + i] = static_cast<double>(block[channel]);
+      }
+    }
   }
+  free(info.buffer);
+
+  bool mono = channels == 1;
+  bool stereo = channels == 2;
 
   uint32_t sample_rate = info.hz;
   double length_in_seconds = static_cast<double>(samples_per_channel) / static_cast<double>(sample_rate);
   std::string file_type = "mp3";
 
-  std::vector<double> interleaved_normalized_samples(interleaved_samples.size());
-  std::transform(interleaved_samples.begin(), interleaved_samples.end(), interleaved_normalized_samples.begin(),
-                 [](const int32_t x) { return static_cast<double>(x); });
-
   Mp3Decoded mp3_decoded;
   mp3_decoded.sample_rate = sample_rate;
-  mp3_decoded.channels = info.channels;
+  mp3_decoded.channels = channels;
   mp3_decoded.mono = mono;
   mp3_decoded.stereo = stereo;
   mp3_decoded.samples_per_channel = samples_per_channel;
   mp3_decoded.length_in_seconds = length_in_seconds;
   mp3_decoded.file_type = file_type;
   mp3_decoded.avg_bitrate_kbps = info.avg_bitrate_kbps;
-  mp3_decoded.normalized_samples = Deinterweave(interleaved_normalized_samples);
+  mp3_decoded.normalized_samples = std::move(samples);
 
   return mp3_decoded;
 }
 
+std::string FileExtension(const std::string& file_path) {
+  size_t dot = file_path.find_last_of('.');
+  size_t separator = file_path.find_last_of("/\\");
+  if (dot == std::string::npos || (separator != std::string::npos && dot < separator)) return "";
+  std::string extension = file_path.substr(dot + 1);
+  std::transform(extension.begin(), extension.end(), extension.begin(),
+                 [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+  return extension;
+}
+
+}  // namespace
+
+Mp3Decoded DecodeMp3(const std::string file_path, bool mono_downmix) {
+  MUSHER_STAGE_BEGIN(decode_timer, Stage::kDecode);
+  mp3dec_t mp3d;
+  mp3dec_file_info_t info;
+  if (mp3dec_load(&mp3d, file_path.c_str(), &info, NULL, NULL)) {
+    // error
+    throw std::runtime_error("Unable to decode MP3.");
+  }
+  Mp3Decoded mp3_decoded = ConvertMp3FileInfo(info, mono_downmix);
+  MUSHER_STAGE_END(decode_timer, mp3_decoded.samples_per_channel,
+                   mp3_decoded.normalized_samples.size() * sizeof(double));
+  return mp3_decoded;
+}
+
+Mp3Decoded DecodeMp3(Span<const uint8_t> file_data, bool mono_downmix) {
+  MUSHER_STAGE_BEGIN(decode_timer, Stage::kDecode);
+  mp3dec_t mp3d;
+  mp3dec_file_info_t info;
+  mp3dec_load_buf(&mp3d, file_data.data(), file_data.size(), &info, NULL, NULL);
+  if (!info.samples) {
+    free(info.buffer);
+    throw std::runtime_error("Unable to decode MP3.");
+  }
+  Mp3Decoded mp3_decoded = ConvertMp3FileInfo(info, mono_downmix);
+  MUSHER_STAGE_END(decode_timer, mp3_decoded.samples_per_channel,
+                   mp3_decoded.normalized_samples.size() * sizeof(double));
+  return mp3_decoded;
+}
+
+AudioBuffer DecodeMonoFromData(const std::string& file_path,
+                               Span<const uint8_t> file_data,
+                               double& sample_rate) {
+  const std::string extension = FileExtension(file_path);
+  if (extension == "wav") {
+    WavDecoded wav_decoded = DecodeWav(file_data, true);
+    sample_rate = wav_decoded.sample_rate;
+    return std::move(wav_decoded.normalized_samples);
+  }
+  if (extension == "mp3") {
+    Mp3Decoded mp3_decoded = DecodeMp3(file_data, true);
+    sample_rate = mp3_decoded.sample_rate;
+    return std::move(mp3_decoded.normalized_samples);
+  }
+  throw std::runtime_error("Unsupported audio file type '" + extension + "', expected wav or mp3.");
+}
+
 }  // namespace core
 }  // namespace musher
@@ -1,8 +1,12 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
+#include "src/core/audio_buffer.h"
+#include "src/core/span.h"
+
 namespace musher {
 namespace core {
 
@@ -12,7 +16,7 @@ namespace core {
  */
 struct AudioDecoded {
   uint32_t sample_rate;     //!< Sampling rate of the audio signal \[Hz\].
-  int channels;             //!< Number of audio channels in the buffer.
+  int channels;             //!< Number of audio channels in the buffer (1 if the audio was downmixed).
   bool mono;                //!< True is audio is mono.
   bool stereo;              //!< True if audio is stereo.
   int samples_per_channel;  //!< Number of samples per channel.
@@ -20,13 +24,12 @@ struct AudioDecoded {
                                 Based on the number of samples and the sample rate.*/
   std::string file_type;    //!< Type of the file decoded.
   int avg_bitrate_kbps;     //!< Average bitrate of the buffer \[kbps\]
-  std::vector<std::vector<double>>
-      normalized_samples; /*!< Normalized samples of the audio file.
+  AudioBuffer normalized_samples; /*!< Normalized samples of the audio file.
 
-                              normalized_samples[0] holds channel 1
+                                      normalized_samples.channel(0) holds channel 1
 
-                              normalized_samples[1] holds channel 2 (Will not exist if mono audio)
-                              */
+                                      normalized_samples.channel(1) holds channel 2 (Will not exist if mono audio)
+                                      */
 };
 
 /**
@@ -50,7 +53,7 @@ struct Mp3Decoded : AudioDecoded {};
 /**
  * @brief Load the data from an audio file.
  *
- * @param file_path File path to a .wav file.
+ * @param file_path File path to an audio file.
  * @return std::vector<uint8_t> Audio file data.
  */
 std::vector<uint8_t> LoadAudioFile(const std::string& file_path);
@@ -58,26 +61,52 @@ std::vector<uint8_t> LoadAudioFile(const std::string& file_path);
 /**
  * @brief Decode a wav file.
  *
- * @param file_data WAV file data.
+ * @param file_data WAV file data, read in place.
+ * @param mono_downmix If true, the channels are averaged while the samples are converted and normalized_samples
+ * holds a single channel. This gives the same samples as MonoMixer without allocating every channel first.
  * @return WavDecoded .wav file information.
  */
-WavDecoded DecodeWav(const std::vector<uint8_t>& file_data);
+WavDecoded DecodeWav(Span<const uint8_t> file_data, bool mono_downmix = false);
 
 /**
  * @brief Overloaded wrapper around DecodeWav that accepts a file path to a .wav file.
  *
  * @param file_path File path to a .wav file.
+ * @param mono_downmix If true, the channels are averaged into a single channel while decoding.
  * @return WavDecoded .wav file information.
  */
-WavDecoded DecodeWav(const std::string& file_path);
+WavDecoded DecodeWav(const std::string& file_path, bool mono_downmix = false);
 
 /**
  * @brief Decode an mp3 file.
  *
  * @param file_path File path to a .mp3 file.
+ * @param mono_downmix If true, the channels are averaged straight from the decoder output and normalized_samples
+ * holds a single channel. This gives the same samples as MonoMixer without allocating every channel first.
  * @return Mp3Decoded .mp3 file information.
  */
-Mp3Decoded DecodeMp3(const std::string file_path);
+Mp3Decoded DecodeMp3(const std::string file_path, bool mono_downmix = false);
+
+/**
+ * @brief Overloaded DecodeMp3 that decodes mp3 file data that is already in memory.
+ *
+ * @param file_data MP3 file data, read in place.
+ * @param mono_downmix If true, the channels are averaged into a single channel while decoding.
+ * @return Mp3Decoded .mp3 file information.
+ */
+Mp3Decoded DecodeMp3(Span<const uint8_t> file_data, bool mono_downmix = false);
+
+/**
+ * @brief Decode an audio file straight to mono, picking the decoder from the file extension (.wav or .mp3).
+ *
+ * @param file_path Path of the file the data was read from, only used for its extension.
+ * @param file_data Audio file data.
+ * @param sample_rate Output, sampling rate of the decoded audio \[Hz\].
+ * @return AudioBuffer Normalized mono samples (a single channel).
+ */
+AudioBuffer DecodeMonoFromData(const std::string& file_path,
+                               Span<const uint8_t> file_data,
+                               double& sample_rate);
 
 }  // namespace core
 }  // namespace musher
@@ -0,0 +1,170 @@
+#include "src/core/batch.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "src/core/audio_decoders.h"
+#include "src/core/key.h"
+#include "src/core/threading.h"
+#include "src/core/trace.h"
+
+namespace musher {
+namespace core {
+
+namespace {
+
+/**
+ * @brief A loaded file waiting for a worker, or the error raised while loading it.
+ */
+struct LoadedFile {
+  size_t index;
+  std::vector<uint8_t> file_data;
+  std::string error;
+};
+
+/**
+ * @brief Blocking queue of loaded files with a fixed capacity.
+ */
+class LoadedFileQueue {
+ private:
+  const size_t capacity_;
+  std::deque<LoadedFile> files_;
+  bool closed_ = false;
+  std::mutex mutex_;
+  std::condition_variable not_full_;
+  std::condition_variable not_empty_;
+
+ public:
+  explicit LoadedFileQueue(size_t capacity) : capacity_(capacity) {}
+
+  void Push(LoadedFile file) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    not_full_.wait(lock, [this] { return files_.size() < capacity_; });
+    files_.push_back(std::move(file));
+    not_empty_.notify_one();
+  }
+
+  /**
+   * @brief Pop the oldest file, returns false once the queue is closed and drained.
+   */
+  bool Pop(LoadedFile& file) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    not_empty_.wait(lock, [this] { return !files_.empty() || closed_; });
+    if (files_.empty()) return false;
+    file = std::move(files_.front());
+    files_.pop_front();
+    not_full_.notify_one();
+    return true;
+  }
+
+  void Close() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    closed_ = true;
+    not_empty_.notify_all();
+  }
+};
+
+/**
+ * @brief Worker threads popping from a LoadedFileQueue, closed and joined when going out of scope.
+ *
+ * Joining in the destructor means an exception thrown while starting the workers or feeding the queue never leaves a
+ * joinable std::thread behind (which would call std::terminate).
+ */
+class QueueWorkers {
+ private:
+  LoadedFileQueue& queue_;
+  std::vector<std::thread> threads_;
+
+ public:
+  explicit QueueWorkers(LoadedFileQueue& queue) : queue_(queue) {}
+  QueueWorkers(const QueueWorkers&) = delete;
+  QueueWorkers& operator=(const QueueWorkers&) = delete;
+
+  ~QueueWorkers() {
+    queue_.Close();
+    for (std::thread& thread : threads_) thread.join();
+  }
+
+  void Start(unsigned int num_threads, const std::function<void()>& worker) {
+    threads_.reserve(threads_.size() + num_threads);
+    for (unsigned int i = 0; i < num_threads; i++) threads_.emplace_back(worker);
+  }
+};
+
+}  // namespace
+
+std::vector<KeyBatchResult> DetectKeyBatch(
+    const std::vector<std::string>& file_paths,
+    unsigned int num_threads,
+    unsigned int max_files_in_flight,
+    const std::function<KeyOutput(Span<const double>, double)>& detect_key_func) {
+  num_threads = ResolveNumThreads(num_threads);
+  num_threads = static_cast<unsigned int>(std::min<size_t>(num_threads, std::max<size_t>(1, file_paths.size())));
+  if (max_files_in_flight == 0) max_files_in_flight = 2 * num_threads;
+
+  std::function<KeyOutput(Span<const double>, double)> detect_key = detect_key_func;
+  if (!detect_key) {
+    detect_key = [](Span<const double> mono_samples, double sample_rate) {
+      return DetectKey(mono_samples, sample_rate);
+    };
+  }
+
+  std::vector<KeyBatchResult> results(file_paths.size());
+  for (size_t i = 0; i < file_paths.size(); i++) results[i].file_path = file_paths[i];
+
+  LoadedFileQueue queue(max_files_in_flight);
+
+  // Every worker writes to its own result slots, so results needs no locking.
+  auto worker = [&queue, &results, &detect_key]() {
+    LoadedFile file;
+    while (queue.Pop(file)) {
+      KeyBatchResult& result = results[file.index];
+      if (!file.error.empty()) {
+        result.error = file.error;
+        continue;
+      }
+      try {
+        TraceFileScope trace_file(result.file_path);
+        double sample_rate = 0.;
+        AudioBuffer mono_samples = DecodeMonoFromData(result.file_path, file.file_data, sample_rate);
+        // The encoded data is no longer needed, free it before the analysis.
+        std::vector<uint8_t>().swap(file.file_data);
+        result.key_output = detect_key(mono_samples.channel(0), sample_rate);
+        result.ok = true;
+      } catch (const std::exception& e) {
+        result.error = e.what();
+      }
+    }
+  };
+
+  {
+    QueueWorkers workers(queue);
+    workers.Start(num_threads, worker);
+
+    // The calling thread does the reading, handing files to the workers as they free up.
+    for (size_t i = 0; i < file_paths.size(); i++) {
+      LoadedFile file;
+      file.index = i;
+      try {
+        file.file_data = LoadAudioFile(file_paths[i]);
+      } catch (const std::exception& e) {
+        file.error = e.what();
+      }
+      queue.Push(std::move(file));
+    }
+  }  // Closes the queue and joins the workers.
+
+  return results;
+}
+
+}  // namespace core
+}  // namespace musher
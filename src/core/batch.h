@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "src/core/key.h"
+#include "src/core/span.h"
+
+namespace musher {
+namespace core {
+
+/**
+ * @brief Key estimate, or the reason there is none, for one file of a batch.
+ *
+ */
+struct KeyBatchResult {
+  std::string file_path;  //!< Path of the file that was analysed.
+  bool ok = false;        //!< True if the file was decoded and analysed without errors.
+  std::string error;      //!< Error message if ok is false.
+  KeyOutput key_output;   //!< Key estimate, only meaningful if ok is true.
+};
+
+/**
+ * @brief Detect the key of many audio files in parallel.
+ *
+ * The calling thread loads the raw files from disk while a pool of workers decodes and analyses them, so file I/O
+ * overlaps with computation. The reader blocks once max_files_in_flight files are waiting to be analysed, which
+ * bounds memory to roughly (max_files_in_flight + num_threads) encoded files plus num_threads decoded tracks.
+ *
+ * Errors are reported per file; one unreadable file does not stop the batch.
+ *
+ * @param file_paths Paths of .wav or .mp3 files.
+ * @param num_threads Number of worker threads (set to 0 to use the library default, see SetNumThreads).
+ * @param max_files_in_flight Maximum number of loaded files waiting for a worker (set to 0 to use 2 * num_threads).
+ * @param detect_key_func Function computing the key of mono samples at a sample rate. If empty, DetectKey is called
+ * with its default parameters.
+ * @return std::vector<KeyBatchResult> One result per path, in the same order as file_paths.
+ */
+std::vector<KeyBatchResult> DetectKeyBatch(
+    const std::vector<std::string>& file_paths,
+    unsigned int num_threads = 0,
+    unsigned int max_files_in_flight = 0,
+    const std::function<KeyOutput(Span<const double>, double)>& detect_key_func = nullptr);
+
+}  // namespace core
+}  // namespace musher
@@ -0,0 +1,152 @@
+#include "src/core/beat_tracker.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+
+#include "src/core/fft_convolve.h"
+#include "src/core/peak_detect.h"
+
+namespace musher {
+namespace core {
+
+namespace {
+
+/**
+ * @brief Onset envelope divided by its standard deviation and smoothed by a Gaussian one beat period wide.
+ */
+std::vector<double> BeatLocalScore(const std::vector<double> &onset_envelope, double period) {
+  const double mean =
+      std::accumulate(onset_envelope.begin(), onset_envelope.end(), 0.) / static_cast<double>(onset_envelope.size());
+  double variance = 0.;
+  for (const double x : onset_envelope) variance += (x - mean) * (x - mean);
+  const double std_dev = std::sqrt(variance / static_cast<double>(onset_envelope.size()));
+  if (std_dev == 0.) return std::vector<double>();
+
+  std::vector<double> normalized(onset_envelope.size());
+  std::transform(onset_envelope.begin(), onset_envelope.end(), normalized.begin(),
+                 [std_dev](const double x) { return x / std_dev; });
+
+  // Odd and symmetric, so the 'same' convolution stays aligned with the envelope.
+  const long half_width = static_cast<long>(std::round(period));
+  std::vector<double> window(static_cast<size_t>(2 * half_width + 1));
+  for (long k = -half_width; k <= half_width; k++) {
+    const double x = static_cast<double>(k) * 32. / period;
+    window[static_cast<size_t>(k + half_width)] = std::exp(-.5 * x * x);
+  }
+  return FFTConvolve(normalized, window);
+}
+
+/**
+ * @brief Drop beats at both ends whose local score is under half the RMS of the local score at every beat.
+ */
+void TrimBeats(const std::vector<double> &local_score, std::vector<size_t> &beats) {
+  double sum_squares = 0.;
+  for (const size_t beat : beats) sum_squares += local_score[beat] * local_score[beat];
+  const double threshold = .5 * std::sqrt(sum_squares / static_cast<double>(beats.size()));
+
+  auto first = std::find_if(beats.begin(), beats.end(),
+                            [&local_score, threshold](const size_t beat) { return local_score[beat] > threshold; });
+  auto last = std::find_if(beats.rbegin(), beats.rend(),
+                           [&local_score, threshold](const size_t beat) { return local_score[beat] > threshold; })
+                  .base();
+  if (first >= last) {
+    beats.clear();
+    return;
+  }
+  beats = std::vector<size_t>(first, last);
+}
+
+}  // namespace
+
+std::vector<size_t> BeatTrackFrames(const std::vector<double> &onset_envelope,
+                                    double frame_rate,
+                                    double bpm,
+                                    double tightness,
+                                    bool trim) {
+  if (bpm <= 0. || frame_rate <= 0.) throw std::runtime_error("BeatTrackFrames: bpm and frame_rate must be positive.");
+  std::vector<size_t> beats;
+  if (onset_envelope.empty()) return beats;
+
+  const double period = 60. * frame_rate / bpm;
+  std::vector<double> local_score = BeatLocalScore(onset_envelope, period);
+  if (local_score.empty()) return beats;
+
+  // Previous beats are searched between half and twice a period back.
+  const size_t min_interval = std::max<size_t>(1, static_cast<size_t>(std::round(period / 2.)));
+  const size_t max_interval = std::max(min_interval, static_cast<size_t>(std::round(2. * period)));
+  std::vector<double> transition_cost(max_interval + 1, 0.);
+  for (size_t interval = min_interval; interval <= max_interval; interval++) {
+    const double log_ratio = std::log(static_cast<double>(interval) / period);
+    transition_cost[interval] = -tightness * log_ratio * log_ratio;
+  }
+
+  const size_t size = local_score.size();
+  std::vector<double> cumulative_score(size);
+  std::vector<long> backlink(size, -1);
+  const double max_local_score = *std::max_element(local_score.begin(), local_score.end());
+  bool first_beat = true;
+  for (size_t i = 0; i < size; i++) {
+    double best_score = -std::numeric_limits<double>::infinity();
+    long best_previous = -1;
+    for (size_t interval = min_interval; interval <= max_interval; interval++) {
+      // A previous beat before the start of the envelope scores nothing, and ends the chain.
+      const bool in_range = interval <= i;
+      const double score = (in_range ? cumulative_score[i - interval] : 0.) + transition_cost[interval];
+      if (score > best_score) {
+        best_score = score;
+        best_previous = in_range ? static_cast<long>(i - interval) : -1;
+      }
+    }
+    cumulative_score[i] = local_score[i] + best_score;
+    backlink[i] = best_previous;
+
+    // Frames before the first strong onset should not be linked to the silence before them.
+    if (first_beat && local_score[i] < .01 * max_local_score) {
+      backlink[i] = -1;
+    } else {
+      first_beat = false;
+    }
+  }
+
+  // The last beat is the last cumulative score peak above half the median peak height.
+  std::vector<std::tuple<double, double>> peaks = PeakDetect(cumulative_score, -1000.0, false, "position");
+  if (peaks.empty()) return beats;
+  std::vector<double> peak_heights(peaks.size());
+  std::transform(peaks.begin(), peaks.end(), peak_heights.begin(),
+                 [](const std::tuple<double, double> &peak) { return std::get<1>(peak); });
+  std::nth_element(peak_heights.begin(), peak_heights.begin() + peak_heights.size() / 2, peak_heights.end());
+  const double threshold = .5 * peak_heights[peak_heights.size() / 2];
+  long beat = -1;
+  for (auto peak = peaks.rbegin(); peak != peaks.rend(); ++peak) {
+    if (std::get<1>(*peak) > threshold) {
+      beat = static_cast<long>(std::get<0>(*peak));
+      break;
+    }
+  }
+
+  for (; beat >= 0; beat = backlink[static_cast<size_t>(beat)]) beats.push_back(static_cast<size_t>(beat));
+  std::reverse(beats.begin(), beats.end());
+
+  if (trim && !beats.empty()) TrimBeats(local_score, beats);
+  return beats;
+}
+
+std::vector<double> BeatTrack(const std::vector<double> &onset_envelope,
+                              double frame_rate,
+                              double bpm,
+                              double tightness,
+                              bool trim) {
+  std::vector<size_t> beat_frames = BeatTrackFrames(onset_envelope, frame_rate, bpm, tightness, trim);
+  std::vector<double> beat_times(beat_frames.size());
+  std::transform(beat_frames.begin(), beat_frames.end(), beat_times.begin(),
+                 [frame_rate](const size_t frame) { return static_cast<double>(frame) / frame_rate; });
+  return beat_times;
+}
+
+}  // namespace core
+}  // namespace musher
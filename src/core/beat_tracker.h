@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace musher {
+namespace core {
+
+/**
+ * @brief Track the beats of an onset strength envelope with dynamic programming.
+ *
+ * Follows Ellis, "Beat Tracking by Dynamic Programming" (2007). The envelope is smoothed with a Gaussian window one
+ * beat period wide to get a local score. Every frame then takes the best cumulative score of the frames between half
+ * and twice a period before it, penalised by tightness * log(interval / period)^2. The transition penalties only
+ * depend on the interval, so they are computed once, which makes the search O(frames * period). The beats are read
+ * back from the strongest cumulative score peak near the end of the envelope.
+ *
+ * @param onset_envelope Onset strength, one value per frame (see OnsetStrength).
+ * @param frame_rate Number of envelope values per second (sample rate / hop size) \[Hz\].
+ * @param bpm Tempo estimate, for example from BPMFromOnsetStrength.
+ * @param tightness How strictly beats have to follow the tempo, larger values allow less deviation.
+ * @param trim Remove weak beats from the start and end (before the music starts and after it fades out).
+ * @return std::vector<size_t> Envelope frame of every beat, in increasing order. Empty if there are no onsets.
+ */
+std::vector<size_t> BeatTrackFrames(const std::vector<double> &onset_envelope,
+                                    double frame_rate,
+                                    double bpm,
+                                    double tightness = 100.,
+                                    bool trim = true);
+
+/**
+ * @brief Overloaded BeatTrackFrames that returns the time of every beat.
+ *
+ * @param onset_envelope Onset strength, one value per frame (see OnsetStrength).
+ * @param frame_rate Number of envelope values per second (sample rate / hop size) \[Hz\].
+ * @param bpm Tempo estimate, for example from BPMFromOnsetStrength.
+ * @param tightness How strictly beats have to follow the tempo, larger values allow less deviation.
+ * @param trim Remove weak beats from the start and end.
+ * @return std::vector<double> Time of every beat \[Seconds\], in increasing order.
+ */
+std::vector<double> BeatTrack(const std::vector<double> &onset_envelope,
+                              double frame_rate,
+                              double bpm,
+                              double tightness = 100.,
+                              bool trim = true);
+
+}  // namespace core
+}  // namespace musher
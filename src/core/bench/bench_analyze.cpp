@@ -0,0 +1,44 @@
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "src/core/analyze.h"
+#include "src/core/audio_decoders.h"
+#include "src/core/bpm.h"
+#include "src/core/key.h"
+
+using namespace musher::core;
+
+namespace {
+
+const std::string kTrackPath = BENCH_DATA_DIR + std::string("audio_files/126bpm.mp3");
+
+}  // namespace
+
+/**
+ * @brief Key and tempo from separate calls, each decoding the file on its own.
+ *
+ */
+static void BM_SeparateKeyAndTempo(benchmark::State& state) {
+  for (auto _ : state) {
+    Mp3Decoded key_decoded = DecodeMp3(kTrackPath, true);
+    KeyOutput key_output = DetectKey(key_decoded.normalized_samples, key_decoded.sample_rate);
+    Mp3Decoded bpm_decoded = DecodeMp3(kTrackPath, true);
+    double bpm = BPMOverWindow(bpm_decoded.normalized_samples.channel(0), bpm_decoded.sample_rate);
+    benchmark::DoNotOptimize(key_output);
+    benchmark::DoNotOptimize(bpm);
+  }
+}
+BENCHMARK(BM_SeparateKeyAndTempo)->Unit(benchmark::kMillisecond);
+
+/**
+ * @brief Key and tempo from a single decode and a single pass over the frames.
+ *
+ */
+static void BM_AnalyzeTrack(benchmark::State& state) {
+  for (auto _ : state) {
+    TrackAnalysis track_analysis = AnalyzeTrack(kTrackPath);
+    benchmark::DoNotOptimize(track_analysis);
+  }
+}
+BENCHMARK(BM_AnalyzeTrack)->Unit(benchmark::kMillisecond);
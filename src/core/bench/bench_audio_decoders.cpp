@@ -0,0 +1,54 @@
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "src/core/audio_decoders.h"
+#include "src/core/bench/utils.h"
+
+using namespace musher::core;
+using namespace musher::core::bench;
+
+/**
+ * @brief Decode a WAV file that is already in memory.
+ *
+ */
+static void BM_DecodeWav(benchmark::State& state, const std::string& file_name) {
+  const std::vector<uint8_t> file_data = LoadAudioFile(BenchAudioFile(file_name));
+  for (auto _ : state) {
+    WavDecoded wav_decoded = DecodeWav(file_data);
+    benchmark::DoNotOptimize(wav_decoded.normalized_samples.data());
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * file_data.size()));
+}
+BENCHMARK_CAPTURE(BM_DecodeWav, CantinaBand3sec, std::string("CantinaBand3sec.wav"))->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_DecodeWav, 700kb, std::string("700kb.wav"))->Unit(benchmark::kMillisecond);
+
+/**
+ * @brief Decode an MP3 file that is already in memory.
+ *
+ */
+static void BM_DecodeMp3(benchmark::State& state, const std::string& file_name) {
+  const std::vector<uint8_t> file_data = LoadAudioFile(BenchAudioFile(file_name));
+  for (auto _ : state) {
+    Mp3Decoded mp3_decoded = DecodeMp3(file_data);
+    benchmark::DoNotOptimize(mp3_decoded.normalized_samples.data());
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * file_data.size()));
+}
+BENCHMARK_CAPTURE(BM_DecodeMp3, 700kb, std::string("700kb.mp3"))->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_DecodeMp3, mozart_c_major_30sec, std::string("mozart_c_major_30sec.mp3"))
+    ->Unit(benchmark::kMillisecond);
+
+/**
+ * @brief Decode an MP3 file straight to mono.
+ *
+ */
+static void BM_DecodeMp3MonoDownmix(benchmark::State& state) {
+  const std::vector<uint8_t> file_data = LoadAudioFile(BenchAudioFile("mozart_c_major_30sec.mp3"));
+  for (auto _ : state) {
+    Mp3Decoded mp3_decoded = DecodeMp3(file_data, true);
+    benchmark::DoNotOptimize(mp3_decoded.normalized_samples.data());
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * file_data.size()));
+}
+BENCHMARK(BM_DecodeMp3MonoDownmix)->Unit(benchmark::kMillisecond);
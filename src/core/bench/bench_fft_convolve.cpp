@@ -0,0 +1,57 @@
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "src/core/bench/utils.h"
+#include "src/core/fft_convolve.h"
+
+using namespace musher::core;
+using namespace musher::core::bench;
+
+/**
+ * @brief Autocorrelation as the BPM detector used to take it, padding and reversing by hand for FFTConvolve.
+ *
+ */
+static void BM_AutocorrelationFFTConvolve(benchmark::State& state) {
+  const std::vector<double> signal = BenchSignal(static_cast<size_t>(state.range(0)));
+  for (auto _ : state) {
+    std::vector<double> padded(signal);
+    padded.resize(2 * signal.size(), 0.);
+    std::vector<double> reversed(signal.rbegin(), signal.rend());
+    std::vector<double> correlation = FFTConvolve(padded, reversed);
+    benchmark::DoNotOptimize(correlation.data());
+  }
+}
+BENCHMARK(BM_AutocorrelationFFTConvolve)->RangeMultiplier(4)->Range(1 << 10, 1 << 18);
+
+/**
+ * @brief Autocorrelation from the power spectrum with a reused Correlator.
+ *
+ */
+static void BM_AutocorrelationCorrelator(benchmark::State& state) {
+  const std::vector<double> signal = BenchSignal(static_cast<size_t>(state.range(0)));
+  Correlator correlator;
+  std::vector<double> correlation;
+  for (auto _ : state) {
+    correlator.autocorrelate(signal, correlation);
+    benchmark::DoNotOptimize(correlation.data());
+  }
+}
+BENCHMARK(BM_AutocorrelationCorrelator)->RangeMultiplier(4)->Range(1 << 10, 1 << 18);
+
+/**
+ * @brief Long signal against a short kernel with one FFT of the whole output (arg 0) or overlap-add (arg 1).
+ *
+ */
+static void BM_ConvolveLongSignal(benchmark::State& state) {
+  const std::vector<double> signal = BenchSignal(static_cast<size_t>(state.range(0)));
+  const std::vector<double> kernel = BenchSignal(511);
+  Convolver convolver("same", state.range(1) == 0 ? "fft" : "overlap-add");
+  std::vector<double> output;
+  for (auto _ : state) {
+    convolver.compute(signal, kernel, output);
+    benchmark::DoNotOptimize(output.data());
+  }
+}
+BENCHMARK(BM_ConvolveLongSignal)
+    ->ArgsProduct({ { 1 << 16, 1 << 20, 1 << 23 }, { 0, 1 } })
+    ->Unit(benchmark::kMillisecond);
@@ -0,0 +1,28 @@
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "src/core/bench/utils.h"
+#include "src/core/framecutter.h"
+
+using namespace musher::core;
+using namespace musher::core::bench;
+
+/**
+ * @brief Cut every frame (hop of a quarter frame) of a signal, state.range(0) is the frame size and state.range(1)
+ * the length of the signal in seconds.
+ *
+ */
+static void BM_Framecutter(benchmark::State& state) {
+  const int frame_size = static_cast<int>(state.range(0));
+  const std::vector<double> signal = BenchSignal(static_cast<size_t>(state.range(1) * kBenchSampleRate));
+  int64_t num_frames = 0;
+  for (auto _ : state) {
+    Framecutter framecutter(Span<const double>(signal), frame_size, frame_size / 4);
+    for (const std::vector<double>& frame : framecutter) {
+      benchmark::DoNotOptimize(frame.data());
+      num_frames++;
+    }
+  }
+  state.SetItemsProcessed(num_frames);
+}
+BENCHMARK(BM_Framecutter)->Apply(FrameSizesAndLengths)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,29 @@
+#include <tuple>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "src/core/bench/utils.h"
+#include "src/core/hpcp.h"
+#include "src/core/spectral_peaks.h"
+#include "src/core/spectrum.h"
+#include "src/core/windowing.h"
+
+using namespace musher::core;
+using namespace musher::core::bench;
+
+/**
+ * @brief HPCP of the spectral peaks of one frame of state.range(0) samples, with the parameters DetectKey uses.
+ *
+ */
+static void BM_HPCP(benchmark::State& state) {
+  const std::vector<double> spectrum =
+      ConvertToFrequencySpectrum(Windowing(BenchSignal(static_cast<size_t>(state.range(0))), BlackmanHarris62dB));
+  const std::vector<std::tuple<double, double>> peaks = SpectralPeaks(
+      spectrum, -1000.0, "height", 100, kBenchSampleRate, 0, static_cast<int>(kBenchSampleRate / 2));
+  for (auto _ : state) {
+    std::vector<double> hpcp = HPCP(peaks, 36, 440.0, 3, true, 500.0, 40.0, 5000.0, "squared cosine", .5);
+    benchmark::DoNotOptimize(hpcp.data());
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * peaks.size()));
+}
+BENCHMARK(BM_HPCP)->RangeMultiplier(2)->Range(1024, 8192);
@@ -0,0 +1,59 @@
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "src/core/audio_decoders.h"
+#include "src/core/bench/utils.h"
+#include "src/core/key.h"
+
+using namespace musher::core;
+using namespace musher::core::bench;
+
+/**
+ * @brief Key of an averaged HPCP of state.range(0) bins.
+ *
+ */
+static void BM_EstimateKey(benchmark::State& state) {
+  const size_t pcp_size = static_cast<size_t>(state.range(0));
+  std::vector<double> pcp(pcp_size);
+  // A C major triad, spread over the bins of each semitone.
+  for (size_t i = 0; i < pcp_size; i++) {
+    const size_t semitone = i * 12 / pcp_size;
+    pcp[i] = (semitone == 3 || semitone == 7 || semitone == 10) ? 1. : .1;
+  }
+  for (auto _ : state) {
+    KeyOutput key_output = EstimateKey(pcp, true, true, 4, 0.6, "Temperley");
+    benchmark::DoNotOptimize(key_output);
+  }
+}
+BENCHMARK(BM_EstimateKey)->Arg(12)->Arg(36);
+
+/**
+ * @brief Full DetectKey on a synthetic signal, state.range(0) is the frame size and state.range(1) the length of the
+ * signal in seconds. The hop is an eighth of the frame, as 512 is of the default 4096.
+ *
+ */
+static void BM_DetectKey(benchmark::State& state) {
+  const int frame_size = static_cast<int>(state.range(0));
+  const std::vector<double> signal = BenchSignal(static_cast<size_t>(state.range(1) * kBenchSampleRate));
+  for (auto _ : state) {
+    KeyOutput key_output = DetectKey(signal, kBenchSampleRate, "Bgate", true, true, 4, 0.6, false, 36, frame_size,
+                                     frame_size / 8);
+    benchmark::DoNotOptimize(key_output);
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * signal.size()));
+}
+BENCHMARK(BM_DetectKey)->Apply(FrameSizesAndLengths)->Unit(benchmark::kMillisecond);
+
+/**
+ * @brief Full DetectKey on a decoded track, with the default parameters.
+ *
+ */
+static void BM_DetectKeyTrack(benchmark::State& state) {
+  const Mp3Decoded mp3_decoded = DecodeMp3(BenchAudioFile("mozart_c_major_30sec.mp3"));
+  for (auto _ : state) {
+    KeyOutput key_output = DetectKey(mp3_decoded.normalized_samples, mp3_decoded.sample_rate);
+    benchmark::DoNotOptimize(key_output);
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * mp3_decoded.normalized_samples.size()));
+}
+BENCHMARK(BM_DetectKeyTrack)->Unit(benchmark::kMillisecond);
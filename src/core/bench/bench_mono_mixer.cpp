@@ -0,0 +1,20 @@
+#include "benchmark/benchmark.h"
+#include "src/core/bench/utils.h"
+#include "src/core/mono_mixer.h"
+
+using namespace musher::core;
+using namespace musher::core::bench;
+
+/**
+ * @brief Downmix a stereo signal of state.range(0) seconds.
+ *
+ */
+static void BM_MonoMixer(benchmark::State& state) {
+  const AudioBuffer stereo = BenchStereoSignal(static_cast<size_t>(state.range(0) * kBenchSampleRate));
+  for (auto _ : state) {
+    std::vector<double> mixed_audio = MonoMixer(stereo);
+    benchmark::DoNotOptimize(mixed_audio.data());
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * stereo.frames()));
+}
+BENCHMARK(BM_MonoMixer)->Arg(10)->Arg(60)->Arg(300)->Unit(benchmark::kMillisecond);
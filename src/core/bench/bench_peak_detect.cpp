@@ -0,0 +1,64 @@
+#include <tuple>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "src/core/bench/utils.h"
+#include "src/core/peak_detect.h"
+#include "src/core/spectral_peaks.h"
+#include "src/core/spectrum.h"
+#include "src/core/windowing.h"
+
+using namespace musher::core;
+using namespace musher::core::bench;
+
+namespace {
+
+std::vector<double> BenchSpectrum(size_t frame_size) {
+  return ConvertToFrequencySpectrum(Windowing(BenchSignal(frame_size), BlackmanHarris62dB));
+}
+
+}  // namespace
+
+/**
+ * @brief Every peak of the spectrum of a frame of state.range(0) samples, sorted by position.
+ *
+ */
+static void BM_PeakDetect(benchmark::State& state) {
+  const std::vector<double> spectrum = BenchSpectrum(static_cast<size_t>(state.range(0)));
+  for (auto _ : state) {
+    std::vector<std::tuple<double, double>> peaks = PeakDetect(spectrum);
+    benchmark::DoNotOptimize(peaks.data());
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * spectrum.size()));
+}
+BENCHMARK(BM_PeakDetect)->RangeMultiplier(2)->Range(512, 8192);
+
+/**
+ * @brief The 100 highest spectral peaks of the whole spectrum.
+ *
+ */
+static void BM_SpectralPeaks(benchmark::State& state) {
+  const std::vector<double> spectrum = BenchSpectrum(static_cast<size_t>(state.range(0)));
+  for (auto _ : state) {
+    std::vector<std::tuple<double, double>> peaks =
+        SpectralPeaks(spectrum, -1000.0, "height", 100, kBenchSampleRate, 0, static_cast<int>(kBenchSampleRate / 2));
+    benchmark::DoNotOptimize(peaks.data());
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * spectrum.size()));
+}
+BENCHMARK(BM_SpectralPeaks)->RangeMultiplier(2)->Range(512, 8192);
+
+/**
+ * @brief The 100 highest spectral peaks within the HPCP frequency range, as DetectKey searches them.
+ *
+ */
+static void BM_SpectralPeaksInRange(benchmark::State& state) {
+  const std::vector<double> spectrum = BenchSpectrum(static_cast<size_t>(state.range(0)));
+  for (auto _ : state) {
+    std::vector<std::tuple<double, double>> peaks =
+        SpectralPeaksInRange(spectrum, -1000.0, "height", 100, kBenchSampleRate, 40., 5000.);
+    benchmark::DoNotOptimize(peaks.data());
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * spectrum.size()));
+}
+BENCHMARK(BM_SpectralPeaksInRange)->RangeMultiplier(2)->Range(512, 8192);
@@ -0,0 +1,71 @@
+#include <tuple>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "src/core/bench/utils.h"
+#include "src/core/spectral_peaks.h"
+#include "src/core/spectrum.h"
+
+using namespace musher::core;
+using namespace musher::core::bench;
+
+/**
+ * @brief Spectra of a 30 second track (4096 samples, 512 hop at 44.1 kHz) one frame at a time.
+ *
+ */
+static void BM_FrequencySpectrumPerFrame(benchmark::State& state) {
+  const std::vector<std::vector<double>> frames = BenchFrames(2584, 4096, 512);
+  for (auto _ : state) {
+    for (const std::vector<double>& frame : frames) {
+      std::vector<double> spectrum = ConvertToFrequencySpectrum(frame);
+      benchmark::DoNotOptimize(spectrum.data());
+    }
+  }
+}
+BENCHMARK(BM_FrequencySpectrumPerFrame)->Unit(benchmark::kMillisecond);
+
+/**
+ * @brief The same spectra batched, across thread counts.
+ *
+ */
+static void BM_FrequencySpectra(benchmark::State& state) {
+  const std::vector<std::vector<double>> frames = BenchFrames(2584, 4096, 512);
+  for (auto _ : state) {
+    std::vector<std::vector<double>> spectra =
+        ConvertToFrequencySpectra(frames, static_cast<unsigned int>(state.range(0)));
+    benchmark::DoNotOptimize(spectra.data());
+  }
+}
+BENCHMARK(BM_FrequencySpectra)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+/**
+ * @brief Spectrum of a single windowed frame of state.range(0) samples.
+ *
+ */
+static void BM_FrequencySpectrum(benchmark::State& state) {
+  const std::vector<double> frame = BenchSignal(static_cast<size_t>(state.range(0)));
+  for (auto _ : state) {
+    std::vector<double> spectrum = ConvertToFrequencySpectrum(frame);
+    benchmark::DoNotOptimize(spectrum.data());
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * frame.size()));
+}
+BENCHMARK(BM_FrequencySpectrum)->RangeMultiplier(2)->Range(512, 8192);
+
+/**
+ * @brief The same spectrum with only the bins of the HPCP frequency range computed, as DetectKey computes it.
+ *
+ */
+static void BM_FrequencySpectrumBandLimited(benchmark::State& state) {
+  const std::vector<double> frame = BenchSignal(static_cast<size_t>(state.range(0)));
+  int min_bin;
+  int max_bin;
+  std::tie(min_bin, max_bin) = SpectralPeaksBinRange(FrequencySpectrumSize(frame.size()), 44100., 40., 5000.);
+  for (auto _ : state) {
+    std::vector<double> spectrum =
+        ConvertToFrequencySpectrum(frame, static_cast<size_t>(min_bin), static_cast<size_t>(max_bin));
+    benchmark::DoNotOptimize(spectrum.data());
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * frame.size()));
+}
+BENCHMARK(BM_FrequencySpectrumBandLimited)->RangeMultiplier(2)->Range(512, 8192);
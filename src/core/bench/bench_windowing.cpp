@@ -0,0 +1,22 @@
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "src/core/bench/utils.h"
+#include "src/core/windowing.h"
+
+using namespace musher::core;
+using namespace musher::core::bench;
+
+/**
+ * @brief Window a single frame of state.range(0) samples.
+ *
+ */
+static void BM_Windowing(benchmark::State& state) {
+  const std::vector<double> frame = BenchSignal(static_cast<size_t>(state.range(0)));
+  for (auto _ : state) {
+    std::vector<double> windowed_frame = Windowing(frame, BlackmanHarris62dB);
+    benchmark::DoNotOptimize(windowed_frame.data());
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * frame.size()));
+}
+BENCHMARK(BM_Windowing)->RangeMultiplier(2)->Range(512, 8192);
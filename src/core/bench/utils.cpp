@@ -0,0 +1,66 @@
+#include "src/core/bench/utils.h"
+
+#include <cmath>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace musher {
+namespace core {
+namespace bench {
+
+std::vector<double> BenchSignal(size_t num_samples) {
+  const double pi = std::acos(-1.);
+  const std::vector<double> fundamentals = { 261.63, 329.63, 392.00 };
+  std::vector<double> signal(num_samples);
+  for (size_t i = 0; i < num_samples; i++) {
+    const double t = static_cast<double>(i) / kBenchSampleRate;
+    double sample = 0.;
+    for (const double fundamental : fundamentals) {
+      for (int harmonic = 1; harmonic <= 4; harmonic++) {
+        sample += std::sin(2. * pi * fundamental * harmonic * t) / (harmonic * harmonic);
+      }
+    }
+    signal[i] = .2 * (.75 + .25 * std::sin(2. * pi * .5 * t)) * sample;
+  }
+  return signal;
+}
+
+std::vector<std::vector<double>> BenchFrames(size_t num_frames, size_t frame_size, size_t hop_size) {
+  if (num_frames == 0) return {};
+  const std::vector<double> signal = BenchSignal((num_frames - 1) * hop_size + frame_size);
+  std::vector<std::vector<double>> frames;
+  frames.reserve(num_frames);
+  for (size_t i = 0; i < num_frames; i++) {
+    const auto frame_begin = signal.begin() + static_cast<std::ptrdiff_t>(i * hop_size);
+    frames.emplace_back(frame_begin, frame_begin + static_cast<std::ptrdiff_t>(frame_size));
+  }
+  return frames;
+}
+
+AudioBuffer BenchStereoSignal(size_t num_frames) {
+  const size_t delay = static_cast<size_t>(.005 * kBenchSampleRate);
+  const std::vector<double> signal = BenchSignal(num_frames + delay);
+  AudioBuffer buffer(2, num_frames);
+  Span<double> left = buffer.channel(0);
+  Span<double> right = buffer.channel(1);
+  for (size_t i = 0; i < num_frames; i++) {
+    left[i] = signal[i + delay];
+    right[i] = signal[i];
+  }
+  return buffer;
+}
+
+std::string BenchAudioFile(const std::string& file_name) {
+  return BENCH_DATA_DIR + std::string("audio_files/") + file_name;
+}
+
+void FrameSizesAndLengths(benchmark::internal::Benchmark* benchmark) {
+  for (const int frame_size : { 1024, 4096, 8192 }) {
+    for (const int seconds : { 10, 60 }) benchmark->Args({ frame_size, seconds });
+  }
+}
+
+}  // namespace bench
+}  // namespace core
+}  // namespace musher
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "src/core/audio_buffer.h"
+
+namespace musher {
+namespace core {
+namespace bench {
+
+const double kBenchSampleRate = 44100.;  //!< Sampling rate of the synthetic signals \[Hz\].
+
+/**
+ * @brief Synthetic mono signal: a C major triad with a few harmonics and a slow amplitude swell, so spectra have
+ * realistic peaks for the key stages to work on.
+ *
+ * @param num_samples Number of samples.
+ * @return std::vector<double> Signal between -1 and 1, sampled at kBenchSampleRate.
+ */
+std::vector<double> BenchSignal(size_t num_samples);
+
+/**
+ * @brief Frames cut from BenchSignal, one hop_size apart, as the key stages see them.
+ *
+ * @param num_frames Number of frames.
+ * @param frame_size Number of samples per frame.
+ * @param hop_size Number of samples between the starts of two frames.
+ * @return std::vector<std::vector<double>> Every frame.
+ */
+std::vector<std::vector<double>> BenchFrames(size_t num_frames, size_t frame_size, size_t hop_size);
+
+/**
+ * @brief Synthetic stereo signal, the right channel is the left one delayed by a few milliseconds.
+ *
+ * @param num_frames Number of samples per channel.
+ * @return AudioBuffer Two channels sampled at kBenchSampleRate.
+ */
+AudioBuffer BenchStereoSignal(size_t num_frames);
+
+/**
+ * @brief Path of a file in data/audio_files.
+ */
+std::string BenchAudioFile(const std::string& file_name);
+
+/**
+ * @brief Register every (frame size, signal length in seconds) pair used by the frame based benchmarks.
+ */
+void FrameSizesAndLengths(benchmark::internal::Benchmark* benchmark);
+
+}  // namespace bench
+}  // namespace core
+}  // namespace musher
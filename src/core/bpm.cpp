@@ -1,183 +1,265 @@
+#include "src/core/bpm.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "src/core/fft_convolve.h"
+#include "src/core/peak_detect.h"
+#include "src/core/utils.h"
 
 namespace musher {
 namespace core {
 
-// double BPMDetection(std::vector<double>& samples, uint32_t sample_rate) {
-//   wave_object obj;
-//   wt_object wt;
-//   int J = 1;
-
-//   const int total_levels = 4;
-//   const int max_decimation = std::pow(2, (total_levels - 1));
-
-//   double min_index = 60. / 220 * (sample_rate / max_decimation);
-//   double max_index = 60. / 40 * (sample_rate / max_decimation);
-
-//   const char* name = "db4";
-//   obj = wave_init(name);  // Initialize the wavelet
-
-//   size_t cD_min_len;
-//   double decimated_signal_sum, decimated_signal_mean;
-//   std::vector<double> cD, cD_sum, cD_filtered, cD_decimated_signal, cD_mean_removed_signal,
-//       cD_mean_removed_signal_partial;
-//   std::vector<double> cA, cA_filtered, cA_mean_removed_signal_partial;
-//   for (int level = 0; level < total_levels; level++) {
-//     // Discrete Wavelet Transform
-//     if (level == 0) {
-//       // Initialize the wavelet transform object on input
-//       wt = wt_init(obj, (char*)"dwt", samples.size(), J);
-//       setDWTExtension(wt, (char*)"sym");
-//       setWTConv(wt, (char*)"direct");
-
-//       // Perform DWT
-//       dwt(wt, samples.data());
-
-//       cD_min_len = wt->length[1] / max_decimation + 1;
-//       cD_sum.resize(cD_min_len, 0.0);
-//       cD_mean_removed_signal_partial.resize(cD_min_len);
-//     } else {
-//       // Initialize the wavelet transform object
-//       wt = wt_init(obj, (char*)"dwt", cA.size(), J);
-//       setDWTExtension(wt, (char*)"sym");
-//       setWTConv(wt, (char*)"direct");
-
-//       // Perform remaining DWT's on cA
-//       dwt(wt, cA.data());
-//     }
-
-//     // Fill cA
-//     cA.clear();
-//     for (int i = 0; i < wt->length[0]; ++i) {
-//       cA.push_back(wt->output[i]);
-//     }
-
-//     // Fill cD
-//     for (int i = wt->length[1]; i < wt->outlength; ++i) {
-//       cD.push_back(wt->output[i]);
-//     }
-
-//     // Perform One Pole filter on cD
-//     cD_filtered = OnePoleFilter(cD);
-
-//     // Decimate
-//     int dc = std::pow(2, (total_levels - level - 1));
-//     for (int ax = 0; ax < cD_filtered.size(); ax += dc) {
-//       cD_decimated_signal.push_back(std::abs(cD_filtered[ax]));
-//     }
-
-//     decimated_signal_sum = std::accumulate(cD_decimated_signal.begin(), cD_decimated_signal.end(), 0.0);
-//     decimated_signal_mean = decimated_signal_sum / static_cast<double>(cD_decimated_signal.size());
-
-//     // Remove the mean
-//     cD_mean_removed_signal.resize(cD_decimated_signal.size());
-//     auto remove_mean = [decimated_signal_mean](const double x) { return x - decimated_signal_mean; };
-//     std::transform(cD_decimated_signal.begin(), cD_decimated_signal.end(), cD_mean_removed_signal.begin(),
-//     remove_mean);
-
-//     // Reconstruct
-//     std::copy_n(cD_mean_removed_signal.begin(), cD_min_len, cD_mean_removed_signal_partial.begin());
-//     // Perform element-wise sum of 2 vectors and store into cD_sum
-//     std::transform(cD_sum.begin(), cD_sum.end(), cD_mean_removed_signal_partial.begin(), cD_sum.begin(),
-//                    std::plus<double>());
-
-//     // Clear variables
-//     wt_free(wt);
-//     cD.clear();
-//     cD_filtered.clear();
-//     cD_decimated_signal.clear();
-//     cD_mean_removed_signal.clear();
-//     // cD_mean_removed_signal_partial.clear();
-//   }
-//   wave_free(obj);
-
-//   // Check if cA has any useful data
-//   bool zeros = std::all_of(cA.begin(), cA.end(), [](const double d) { return d == 0.0; });
-//   if (zeros) return 0.0;
-
-//   // Filter cA
-//   cA_filtered = OnePoleFilter(cA);
-
-//   // Make cA_filtered absolute
-//   std::vector<double> cA_absolute(cA_filtered.size());
-//   auto absolute_val = [](const double x) { return std::abs(x); };
-//   std::transform(cA_filtered.begin(), cA_filtered.end(), cA_absolute.begin(), absolute_val);
-
-//   // Get mean
-//   double cA_absolute_sum = std::accumulate(cA_absolute.begin(), cA_absolute.end(), 0.0);
-//   double cA_absolute_mean = cA_absolute_sum / static_cast<double>(cA_absolute.size());
-
-//   std::vector<double> cA_mean_removed_signal(cA_absolute.size());
-//   auto remove_mean = [cA_absolute_mean](const double x) { return x - cA_absolute_mean; };
-//   std::transform(cA_absolute.begin(), cA_absolute.end(), cA_mean_removed_signal.begin(), remove_mean);
-
-//   cA_mean_removed_signal_partial.resize(cD_min_len);
-//   std::copy_n(cA_mean_removed_signal.begin(), cD_min_len, cA_mean_removed_signal_partial.begin());
-//   // Add elements of cD_sum and cD_mean_removed_signal_partial together and store into cD_sum
-//   std::transform(cD_sum.begin(), cD_sum.end(), cA_mean_removed_signal_partial.begin(), cD_sum.begin(),
-//                  std::plus<double>());
-
-//   size_t data_len = cD_sum.size();
-//   std::vector<double> b(data_len * 2);
-
-//   // Fill a section of b with cD_sum data
-//   int k = 0;
-//   for (int i = data_len / 2; i < (data_len / 2) + data_len; ++i) {
-//     b[i] = cD_sum[k];
-//     k += 1;
-//   }
-
-//   // Reverse cD_sum
-//   std::vector<double> reverse_cD(cD_sum);
-//   std::reverse(reverse_cD.begin(), reverse_cD.end());
-
-//   // Perform an array flipped convolution, which is the same as a cross-correlation on the samples.
-//   std::vector<double> correl = FFTConvolve(b, reverse_cD);
-//   correl.pop_back();  // We don't need the last element
-//   size_t midpoint = correl.size() / 2;
-//   std::vector<double> correl_midpoint_tmp(correl.begin() + midpoint, correl.end());
-//   std::vector<double> sliced_correl_midpoint_tmp(correl_midpoint_tmp.begin() + std::floor(min_index),
-//                                                  correl_midpoint_tmp.begin() + std::floor(max_index));
-
-//   // Peak Detection
-//   std::vector<double> sliced_correl_midpoint_tmp_abs(sliced_correl_midpoint_tmp.size());
-//   std::transform(sliced_correl_midpoint_tmp.begin(), sliced_correl_midpoint_tmp.end(),
-//                  sliced_correl_midpoint_tmp_abs.begin(), [](const double x) { return std::abs(x); });
-//   std::vector<std::tuple<double, double>> peaks;
-//   double threshold = -1000.0;
-//   bool interpolate = true;
-//   std::string sort_by = "height";
-//   peaks = PeakDetect(sliced_correl_midpoint_tmp_abs, threshold, interpolate, sort_by);
-
-//   // Get the first item from peaks because we want the highest peak
-//   const double peak_index = std::get<0>(peaks[0]);
-
-//   if (peak_index == 0.0) return 0.0;
-//   double peak_index_adjusted = peak_index + min_index;
-//   double bpm = 60. / peak_index_adjusted * (sample_rate / max_decimation);
-
-//   return bpm;
-// }
-
-// double BPMOverWindow(std::vector<double>& samples, uint32_t sample_rate, unsigned int window_seconds) {
-//   int num_samples = samples.size();
-//   int window_samples = window_seconds * sample_rate;
-//   int sample_index = 0;
-//   int max_windows_index = num_samples / window_samples;
-//   std::vector<double> bpms(max_windows_index, 0.0);
-//   std::vector<double> seconds_mid(max_windows_index, 0.0);
-
-//   for (int window_index = 0; window_index < max_windows_index; window_index++) {
-//     typename std::vector<double>::iterator samp_it = samples.begin() + sample_index;
-//     std::vector<double> sliced_samples(samp_it, samp_it + window_samples);
-
-//     double bpm = BPMDetection(sliced_samples, sample_rate);
-//     bpms[window_index] = bpm;
-
-//     sample_index += window_samples;
-//   }
-
-//   return std::round(Median(bpms));
-// }
+namespace {
+
+/**
+ * @brief Buffers of a single decomposition level.
+ */
+struct BPMLevelBuffers {
+  std::vector<double> approx;
+  std::vector<double> detail;
+};
+
+/**
+ * @brief Buffers reused by every window analysed by BPMOverWindow.
+ */
+struct BPMWorkspace {
+  std::vector<BPMLevelBuffers> levels;
+  std::vector<double> envelope_sum;
+  Correlator correlator;
+  std::vector<double> correlation;
+};
+
+/**
+ * @brief Map an index outside of [0, size) back into it with half-sample symmetric extension.
+ */
+inline size_t SymmetricIndex(long index, long size) {
+  const long period = 2 * size;
+  index %= period;
+  if (index < 0) index += period;
+  return static_cast<size_t>(index < size ? index : period - 1 - index);
+}
+
+/**
+ * @brief Tempo given by the strongest autocorrelation peak of an envelope within a BPM range.
+ *
+ * @param envelope Envelope, already mean removed.
+ * @param correlator Correlator used for the autocorrelation.
+ * @param correlation Output, autocorrelation of the envelope.
+ * @param envelope_rate Sampling rate of the envelope \[Hz\].
+ * @param min_bpm Lowest tempo that can be detected.
+ * @param max_bpm Highest tempo that can be detected.
+ * @param prior_bpm Center of a log normal weighting (one octave deviation) applied to the autocorrelation, which
+ * favours the tempo closest to it between multiples of the beat. Set to 0 to weight every lag the same.
+ * @return double BPM, 0 if there is no peak within the range.
+ */
+double TempoFromAutocorrelation(const std::vector<double> &envelope,
+                                Correlator &correlator,
+                                std::vector<double> &correlation,
+                                double envelope_rate,
+                                double min_bpm,
+                                double max_bpm,
+                                double prior_bpm = 0.) {
+  const size_t min_index = static_cast<size_t>(std::floor(60. / max_bpm * envelope_rate));
+  size_t max_index = static_cast<size_t>(std::floor(60. / min_bpm * envelope_rate));
+
+  correlator.autocorrelate(envelope, correlation);
+  max_index = std::min(max_index, correlation.size());
+  if (max_index < min_index + 3) return 0.;
+
+  std::vector<double> correlation_range(max_index - min_index);
+  std::transform(correlation.begin() + min_index, correlation.begin() + max_index, correlation_range.begin(),
+                 [](const double x) { return std::abs(x); });
+  if (prior_bpm > 0.) {
+    for (size_t i = 0; i < correlation_range.size(); i++) {
+      const double octaves = std::log2(60. * envelope_rate / static_cast<double>(i + min_index) / prior_bpm);
+      correlation_range[i] *= std::exp(-.5 * octaves * octaves);
+    }
+  }
+  std::vector<std::tuple<double, double>> peaks = PeakDetect(correlation_range, -1000.0, true, "height");
+
+  // The ends of the range are only the tempo limits, not actual peaks of the autocorrelation.
+  const double last_position = static_cast<double>(correlation_range.size() - 1);
+  for (const std::tuple<double, double> &peak : peaks) {
+    const double position = std::get<0>(peak);
+    if (position <= 0. || position >= last_position) continue;
+    return 60. / (position + min_index) * envelope_rate;
+  }
+  return 0.;
+}
+
+/**
+ * @brief Add the mean removed envelope of every step-th coefficient to the envelope sum.
+ */
+void AccumulateEnvelope(std::vector<double> &coefficients, size_t step, std::vector<double> &envelope_sum) {
+  OnePoleFilter(coefficients, coefficients);
+
+  const size_t count = (coefficients.size() + step - 1) / step;
+  if (count == 0) return;
+  double sum = 0.;
+  for (size_t k = 0; k < count; k++) sum += std::abs(coefficients[k * step]);
+  const double mean = sum / static_cast<double>(count);
+
+  const size_t size = std::min(count, envelope_sum.size());
+  for (size_t k = 0; k < size; k++) envelope_sum[k] += std::abs(coefficients[k * step]) - mean;
+}
+
+double BPMDetection(Span<const double> samples,
+                    double sample_rate,
+                    const Wavelet &wavelet,
+                    unsigned int levels,
+                    double min_bpm,
+                    double max_bpm,
+                    BPMWorkspace &workspace) {
+  if (levels == 0) throw std::runtime_error("BPMDetection: levels must be greater than 0.");
+  if (min_bpm <= 0. || max_bpm <= min_bpm) throw std::runtime_error("BPMDetection: invalid BPM range.");
+  if (samples.empty()) return 0.;
+
+  const size_t max_decimation = static_cast<size_t>(1) << (levels - 1);
+  const double decimated_sample_rate = sample_rate / static_cast<double>(max_decimation);
+
+  workspace.levels.resize(levels);
+  Span<const double> level_input = samples;
+  for (unsigned int level = 0; level < levels; level++) {
+    BPMLevelBuffers &buffers = workspace.levels[level];
+    DWT(level_input, wavelet, buffers.approx, buffers.detail);
+
+    if (level == 0) workspace.envelope_sum.assign(buffers.detail.size() / max_decimation + 1, 0.);
+
+    // Bring every band down to the rate of the deepest level before summing.
+    const size_t step = static_cast<size_t>(1) << (levels - level - 1);
+    AccumulateEnvelope(buffers.detail, step, workspace.envelope_sum);
+    level_input = buffers.approx;
+  }
+
+  std::vector<double> &approx = workspace.levels.back().approx;
+  bool silent = std::all_of(approx.begin(), approx.end(), [](const double x) { return x == 0.; });
+  if (silent) return 0.;
+  AccumulateEnvelope(approx, 1, workspace.envelope_sum);
+
+  return TempoFromAutocorrelation(workspace.envelope_sum, workspace.correlator, workspace.correlation,
+                                  decimated_sample_rate, min_bpm, max_bpm);
+}
+
+}  // namespace
+
+Wavelet SelectWavelet(const std::string wavelet_name) {
+  Wavelet wavelet;
+  if (wavelet_name == "haar") {
+    wavelet.dec_lo = { 0.7071067811865476, 0.7071067811865476 };
+    wavelet.dec_hi = { -0.7071067811865476, 0.7071067811865476 };
+  } else if (wavelet_name == "db4") {
+    wavelet.dec_lo = { -0.010597401784997278, 0.032883011666982945, 0.030841381835986965, -0.18703481171888114,
+                       -0.02798376941698385,  0.6308807679295904,   0.7148465705525415,   0.23037781330885523 };
+    wavelet.dec_hi = { -0.23037781330885523, 0.7148465705525415,   -0.6308807679295904,   -0.02798376941698385,
+                       0.18703481171888114,  0.030841381835986965, -0.032883011666982945, -0.010597401784997278 };
+  } else {
+    throw std::runtime_error("Unsupported wavelet '" + wavelet_name + "', expected haar or db4.");
+  }
+  return wavelet;
+}
+
+void DWT(Span<const double> input,
+         const Wavelet &wavelet,
+         std::vector<double> &approx,
+         std::vector<double> &detail) {
+  const long input_size = static_cast<long>(input.size());
+  const long filter_size = static_cast<long>(wavelet.dec_lo.size());
+  const size_t output_size = input.empty() ? 0 : static_cast<size_t>((input_size + filter_size - 1) / 2);
+  approx.resize(output_size);
+  detail.resize(output_size);
+
+  const double *lo = wavelet.dec_lo.data();
+  const double *hi = wavelet.dec_hi.data();
+  for (size_t o = 0; o < output_size; o++) {
+    // Output o is the filter centered on odd input index 2 * o + 1, as in PyWavelets.
+    const long i = 2 * static_cast<long>(o) + 1;
+    double approx_sum = 0.;
+    double detail_sum = 0.;
+    if (i - filter_size + 1 >= 0 && i < input_size) {
+      const double *x = input.data() + i;
+      for (long j = 0; j < filter_size; j++) {
+        approx_sum += lo[j] * x[-j];
+        detail_sum += hi[j] * x[-j];
+      }
+    } else {
+      for (long j = 0; j < filter_size; j++) {
+        const double x = input[SymmetricIndex(i - j, input_size)];
+        approx_sum += lo[j] * x;
+        detail_sum += hi[j] * x;
+      }
+    }
+    approx[o] = approx_sum;
+    detail[o] = detail_sum;
+  }
+}
+
+std::tuple<std::vector<double>, std::vector<double>> DWT(Span<const double> input,
+                                                         const std::string wavelet_name) {
+  std::vector<double> approx;
+  std::vector<double> detail;
+  DWT(input, SelectWavelet(wavelet_name), approx, detail);
+  return std::make_tuple(approx, detail);
+}
+
+double BPMDetection(Span<const double> samples,
+                    double sample_rate,
+                    const std::string wavelet_name,
+                    unsigned int levels,
+                    double min_bpm,
+                    double max_bpm) {
+  BPMWorkspace workspace;
+  return BPMDetection(samples, sample_rate, SelectWavelet(wavelet_name), levels, min_bpm, max_bpm, workspace);
+}
+
+double BPMOverWindow(Span<const double> samples,
+                     double sample_rate,
+                     unsigned int window_seconds,
+                     const std::string wavelet_name,
+                     unsigned int levels,
+                     double min_bpm,
+                     double max_bpm) {
+  const Wavelet wavelet = SelectWavelet(wavelet_name);
+  const size_t window_samples = static_cast<size_t>(window_seconds * sample_rate);
+  if (window_samples == 0) throw std::runtime_error("BPMOverWindow: window_seconds must be greater than 0.");
+  const size_t num_windows = samples.size() / window_samples;
+
+  BPMWorkspace workspace;
+  std::vector<double> bpms;
+  bpms.reserve(num_windows);
+  for (size_t window_index = 0; window_index < num_windows; window_index++) {
+    // Windows are views of the samples, only the decomposition levels need buffers.
+    Span<const double> window = samples.subspan(window_index * window_samples, window_samples);
+    double bpm = BPMDetection(window, sample_rate, wavelet, levels, min_bpm, max_bpm, workspace);
+    if (bpm > 0.) bpms.push_back(bpm);
+  }
+  if (bpms.empty()) return 0.;
+
+  return std::round(Median(bpms));
+}
+
+double BPMFromOnsetStrength(const std::vector<double> &onset_envelope,
+                            double frame_rate,
+                            double min_bpm,
+                            double max_bpm,
+                            double prior_bpm) {
+  if (min_bpm <= 0. || max_bpm <= min_bpm) throw std::runtime_error("BPMFromOnsetStrength: invalid BPM range.");
+  if (onset_envelope.empty()) return 0.;
+
+  const double mean =
+      std::accumulate(onset_envelope.begin(), onset_envelope.end(), 0.) / static_cast<double>(onset_envelope.size());
+  std::vector<double> envelope(onset_envelope.size());
+  std::transform(onset_envelope.begin(), onset_envelope.end(), envelope.begin(),
+                 [mean](const double x) { return x - mean; });
+  Correlator correlator;
+  std::vector<double> correlation;
+  return TempoFromAutocorrelation(envelope, correlator, correlation, frame_rate, min_bpm, max_bpm, prior_bpm);
+}
 
 }  // namespace core
 }  // namespace musher
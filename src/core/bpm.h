@@ -1,29 +1,129 @@
 #pragma once
 
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "src/core/span.h"
+
 namespace musher {
 namespace core {
 
-// /**
-//  * @brief Calculate the BPM (Beats per minute) of audio samples.
-//  *
-//  * @param samples Input audio signal.
-//  * @param sample_rate Sampling rate of the audio signal \[Hz\].
-//  * @return double BPM
-//  */
-// double BPMDetection(std::vector<double>& samples, uint32_t sample_rate);
-
-// /**
-//  * @brief Calculate the average BPM (Beats per minute) of samples.
-//  * This function will slice the samples into windows and calculate the BPM over each
-//  * window and then average them to achieve a final BPM over all samples.
-//  *
-//  * @param samples Input audio samples.
-//  * @param sample_rate Sampling rate of the audio signal \[Hz\].
-//  * @param window_seconds Size of the the window [Seconds] that will be scanned to determine the bpm,
-//  * typically less than 10 seconds.
-//  * @return double Average BPM over windows.
-//  */
-// double BPMOverWindow(std::vector<double>& samples, uint32_t sample_rate, unsigned int window_seconds = 3);
+/**
+ * @brief Decomposition filters of a discrete wavelet.
+ *
+ */
+struct Wavelet {
+  std::vector<double> dec_lo;  //!< Decomposition lowpass filter (approximation coefficients).
+  std::vector<double> dec_hi;  //!< Decomposition highpass filter (detail coefficients).
+};
+
+/**
+ * @brief Select the decomposition filters of a wavelet given its name.
+ *
+ * Supported wavelets:
+ * - **haar** - Haar wavelet (same as db1).
+ * - **db4** - Daubechies wavelet with 4 vanishing moments (8 taps).
+ *
+ * @param wavelet_name Name of the wavelet.
+ * @return Wavelet Decomposition filters.
+ */
+Wavelet SelectWavelet(const std::string wavelet_name);
+
+/**
+ * @brief Single level discrete wavelet transform into existing buffers.
+ *
+ * The signal is extended symmetrically at both ends (half-sample symmetric, same as the "symmetric" mode of PyWavelets)
+ * and each output holds floor((input.size() + filter size - 1) / 2) coefficients. The outputs are resized, so buffers
+ * that are reused across calls of the same size never reallocate.
+ *
+ * @param input Input signal.
+ * @param wavelet Wavelet decomposition filters.
+ * @param approx Output, approximation coefficients.
+ * @param detail Output, detail coefficients.
+ */
+void DWT(Span<const double> input,
+         const Wavelet &wavelet,
+         std::vector<double> &approx,
+         std::vector<double> &detail);
+
+/**
+ * @brief Single level discrete wavelet transform.
+ *
+ * @param input Input signal.
+ * @param wavelet_name Name of the wavelet, see SelectWavelet.
+ * @return std::tuple<std::vector<double>, std::vector<double>> Tuple of (approximation, detail) coefficients.
+ */
+std::tuple<std::vector<double>, std::vector<double>> DWT(Span<const double> input,
+                                                         const std::string wavelet_name = "db4");
+
+/**
+ * @brief Calculate the BPM (Beats per minute) of audio samples.
+ *
+ * The signal is decomposed with a discrete wavelet transform. The envelope of every detail band (and of the final
+ * approximation) is taken with a one pole filter, decimated to a common rate and summed. The tempo is the strongest
+ * peak of the autocorrelation of that sum within the allowed BPM range.
+ *
+ * @param samples Input audio signal (mono).
+ * @param sample_rate Sampling rate of the audio signal \[Hz\].
+ * @param wavelet_name Name of the wavelet used for the decomposition, see SelectWavelet.
+ * @param levels Number of decomposition levels.
+ * @param min_bpm Lowest tempo that can be detected.
+ * @param max_bpm Highest tempo that can be detected.
+ * @return double BPM, 0 if no tempo could be found (silence or no peak in range).
+ */
+double BPMDetection(Span<const double> samples,
+                    double sample_rate,
+                    const std::string wavelet_name = "db4",
+                    unsigned int levels = 4,
+                    double min_bpm = 40.,
+                    double max_bpm = 220.);
+
+/**
+ * @brief Calculate the average BPM (Beats per minute) of samples.
+ * This function will slice the samples into windows and calculate the BPM over each
+ * window and then average them to achieve a final BPM over all samples.
+ *
+ * All windows share the same wavelet level buffers, so they are only allocated for the first window.
+ *
+ * @param samples Input audio samples (mono).
+ * @param sample_rate Sampling rate of the audio signal \[Hz\].
+ * @param window_seconds Size of the the window [Seconds] that will be scanned to determine the bpm,
+ * typically less than 10 seconds.
+ * @param wavelet_name Name of the wavelet used for the decomposition, see SelectWavelet.
+ * @param levels Number of decomposition levels.
+ * @param min_bpm Lowest tempo that can be detected.
+ * @param max_bpm Highest tempo that can be detected.
+ * @return double Median BPM over the windows that had a tempo, rounded to the nearest integer (0 if none did).
+ */
+double BPMOverWindow(Span<const double> samples,
+                     double sample_rate,
+                     unsigned int window_seconds = 3,
+                     const std::string wavelet_name = "db4",
+                     unsigned int levels = 4,
+                     double min_bpm = 40.,
+                     double max_bpm = 220.);
+
+/**
+ * @brief Calculate the BPM (Beats per minute) from an onset strength envelope.
+ *
+ * The tempo is the strongest peak of the autocorrelation of the mean removed envelope within the allowed BPM range,
+ * weighted towards prior_bpm so that half or double the beat is not picked over the beat itself. Use it with
+ * OnsetStrength to get the tempo from spectra an analysis already computed.
+ *
+ * @param onset_envelope Onset strength, one value per frame.
+ * @param frame_rate Number of envelope values per second (sample rate / hop size) \[Hz\].
+ * @param min_bpm Lowest tempo that can be detected.
+ * @param max_bpm Highest tempo that can be detected.
+ * @param prior_bpm Most likely tempo, the autocorrelation is weighted by a log normal curve (one octave deviation)
+ * centered on it. Set to 0 to disable the weighting.
+ * @return double BPM, 0 if no tempo could be found.
+ */
+double BPMFromOnsetStrength(const std::vector<double> &onset_envelope,
+                            double frame_rate,
+                            double min_bpm = 40.,
+                            double max_bpm = 220.,
+                            double prior_bpm = 120.);
 
 }  // namespace core
 }  // namespace musher
@@ -3,8 +3,9 @@
 #include <pocketfft/pocketfft.h>
 
 #include <algorithm>
-#include <complex>
+#include <memory>
 #include <stdexcept>
+#include <string>
 #include <vector>
 
 #include "src/core/spectrum.h"
@@ -21,101 +22,249 @@ std::vector<double> CenterVector(const std::vector<double> &vec, size_t new_shap
 }
 
 std::vector<double> FFTConvolve(const std::vector<double> &vec1, const std::vector<double> &vec2) {
-  std::vector<double> v1(vec1);
-  std::vector<double> v2(vec2);
-  std::vector<double> ret;
-
-  if (v1.empty() || v2.empty()) return ret;
-
-  size_t s1 = v1.size();
-  size_t s2 = v2.size();
-  size_t shape = s1 + s2 - 1;
-
-  // Pad inputs to an efficient length
-  size_t good_size = NextFastLen(shape);
-  if (good_size < v1.size() || good_size < v2.size())
-    std::runtime_error("Something went wrong calculating efficient FFT size.");
-  v1.resize(good_size, 0.0);
-  v2.resize(good_size, 0.0);
-
-  // FFT common variables
-  bool forward = true;
-  int inorm = 0;
-  int nthreads = 1;
-  pocketfft::shape_t axes{ 1 };  // 1 axis on 1D array
-
-  // vec1 FFT
-  pocketfft::shape_t v1_dims_in{ 1, v1.size() };  // {width, height}
-  pocketfft::shape_t v1_dims_out(v1_dims_in);
-  v1_dims_out[axes.back()] = (v1_dims_out[axes.back()] >> 1) + 1;  // Get length of output vector
-  size_t v1OutSize = v1_dims_out[axes.back()];
-  std::vector<std::complex<double>> v1_out(v1OutSize);
-  long int s1_in_shape = v1.size() * sizeof(double);
-  pocketfft::stride_t s1_in{ s1_in_shape, sizeof(double) };  // {height * sizeof(type), sizeof(type)}
-  // NOTE: Putting the size of the wrong type will produce wrong results
-  long int s1_out_shape = v1.size() * sizeof(std::complex<double>);
-  pocketfft::stride_t s1_out{ s1_out_shape, sizeof(std::complex<double>) };
-  auto d1_in = reinterpret_cast<const double *>(v1.data());
-  auto d1_out = reinterpret_cast<std::complex<double> *>(v1_out.data());
-  double v1_fct = NormFct(inorm, v1_dims_in, axes);
-  pocketfft::r2c(v1_dims_in, s1_in, s1_out, axes, forward, d1_in, d1_out, v1_fct, nthreads);
-
-  // vec2 FFT
-  pocketfft::shape_t v2_dims_in{ 1, v2.size() };  // {width, height}
-  pocketfft::shape_t v2_dims_out(v2_dims_in);
-  v2_dims_out[axes.back()] = (v2_dims_out[axes.back()] >> 1) + 1;  // Get length of output vector
-  size_t v2OutSize = v2_dims_out[axes.back()];
-  std::vector<std::complex<double>> v2_out(v2OutSize);
-  long int s2_in_shape = v2.size() * sizeof(double);
-  pocketfft::stride_t s2_in{ s2_in_shape, sizeof(double) };  // {height * sizeof(type), sizeof(type)}
-  // NOTE: Putting the size of the wrong type will produce wrong results
-  long int s2_out_shape = v2.size() * sizeof(std::complex<double>);
-  pocketfft::stride_t s2_out{ s2_out_shape, sizeof(std::complex<double>) };
-  auto d2_in = reinterpret_cast<const double *>(v2.data());
-  auto d2_out = reinterpret_cast<std::complex<double> *>(v2_out.data());
-  double v2_fct = NormFct(inorm, v2_dims_in, axes);
-  pocketfft::r2c(v2_dims_in, s2_in, s2_out, axes, forward, d2_in, d2_out, v2_fct, nthreads);
-
-  // Element-wise multiplication of 2 complex vectors
-  std::vector<std::complex<double>> products(v1_out.size());
-  std::transform(v1_out.begin(), v1_out.end(), v2_out.begin(), products.begin(),
-                 std::multiplies<std::complex<double>>());
-
-  // Save size of products before padding
-  size_t product_size_pre_pad = products.size();
-
-  // Pad products to efficient size
-  products.resize(good_size, 0.0);
-
-  // Inverse FFT of complex to real
-  forward = false;
-  inorm = 2;
-  size_t axis = axes.back();
-  size_t lastsize = products.size();
-  pocketfft::shape_t conv_dims_in{ 1, product_size_pre_pad };  // {width, height}
-  pocketfft::shape_t conv_dims_out(conv_dims_in);
-  // if (lastsize==0) lastsize = 2 * conv_dims_in[axis] - 1;
-  if ((lastsize / 2) + 1 != conv_dims_in[axis]) throw std::runtime_error("bad lastsize");
-  conv_dims_out[axis] = lastsize;
-  size_t conv_out_size = conv_dims_out[axis];
-  std::vector<double> conv_out(conv_out_size);
-  long int conv_in_shape = products.size() * sizeof(std::complex<double>);
-  pocketfft::stride_t s_conv_in{ conv_in_shape,
-                                 sizeof(std::complex<double>) };  // {height * sizeof(type), sizeof(type)}
-  // NOTE: Putting the size of the wrong type will produce wrong results
-  long int conv_out_shape = conv_out_size * sizeof(double);
-  pocketfft::stride_t s_conv_out{ conv_out_shape, sizeof(double) };
-  auto d_conv_in = reinterpret_cast<const std::complex<double> *>(products.data());
-  auto d_conv_out = reinterpret_cast<double *>(conv_out.data());
-  double conv_fct = NormFct(inorm, conv_dims_out, axes);
-  pocketfft::c2r(conv_dims_out, s_conv_in, s_conv_out, axes, forward, d_conv_in, d_conv_out, conv_fct, nthreads);
-
-  std::vector<double> sliced_conv_out(conv_out.begin(), conv_out.begin() + shape);
-
-  // Perform 'same' part of the convolve
-  std::vector<double> centered_conv_out = CenterVector(sliced_conv_out, s1);
-  return centered_conv_out;
+  Convolver convolver("same");
+  return convolver.compute(vec1, vec2);
+}
+
+size_t OverlapAddFFTSize(size_t kernel_size) {
+  // About 8 times the kernel keeps the wasted tail of every block small without making the blocks cache hostile.
+  return NextFastLen(std::max<size_t>(64, 8 * kernel_size));
+}
+
+bool PreferOverlapAdd(size_t size1, size_t size2) {
+  const size_t kernel_size = std::min(size1, size2);
+  return 4 * OverlapAddFFTSize(kernel_size) <= NextFastLen(size1 + size2 - 1);
+}
+
+/**
+ * @brief Cached pocketfft plan of a real FFT.
+ */
+struct RealFFTPlan {
+  std::shared_ptr<pocketfft::detail::pocketfft_r<double>> plan;
+};
+
+FFTFilter::FFTFilter(const std::string mode) : mode_(mode) {
+  if (mode_ != "full" && mode_ != "same" && mode_ != "valid") {
+    throw std::runtime_error("Unsupported mode '" + mode_ + "', expected full, same or valid.");
+  }
+}
+
+void FFTFilter::prepare(size_t min_size) {
+  const size_t fft_size = NextFastLen(min_size);
+  if (fft_size != fft_size_ || !plan_) {
+    std::shared_ptr<RealFFTPlan> plan = std::make_shared<RealFFTPlan>();
+    // pocketfft keeps a cache of recent plans, so a new size that was used elsewhere is not planned again.
+    plan->plan = pocketfft::detail::get_plan<pocketfft::detail::pocketfft_r<double>>(fft_size);
+    plan_ = plan;
+    fft_size_ = fft_size;
+  }
+  buffer1_.resize(fft_size_);
+  buffer2_.resize(fft_size_);
+}
+
+void FFTFilter::forward(const double *signal, size_t size, std::vector<double> &buffer) const {
+  std::copy(signal, signal + size, buffer.begin());
+  std::fill(buffer.begin() + size, buffer.end(), 0.);
+  plan_->plan->forward(buffer.data(), 1.);
+}
+
+void FFTFilter::forward(const std::vector<double> &signal, std::vector<double> &buffer) const {
+  forward(signal.data(), signal.size(), buffer);
+}
+
+void FFTFilter::backward() { plan_->plan->backward(buffer1_.data(), 1. / static_cast<double>(fft_size_)); }
+
+void FFTFilter::multiply_spectra(const std::vector<double> &spectrum, bool conjugate) {
+  // Packed layout: r0, r1, i1, r2, i2, ..., with a lone real Nyquist term last when the size is even.
+  double *a = buffer1_.data();
+  const double *b = spectrum.data();
+  a[0] *= b[0];
+  size_t i = 1;
+  for (; i + 1 < fft_size_; i += 2) {
+    const double ar = a[i];
+    const double ai = a[i + 1];
+    const double br = b[i];
+    const double bi = conjugate ? -b[i + 1] : b[i + 1];
+    a[i] = ar * br - ai * bi;
+    a[i + 1] = ar * bi + ai * br;
+  }
+  if (i < fft_size_) a[i] *= b[i];
+}
+
+void FFTFilter::slice_output(const std::vector<double> &full,
+                             size_t size1,
+                             size_t size2,
+                             size_t full_start,
+                             std::vector<double> &output) const {
+  const size_t full_size = size1 + size2 - 1;
+  size_t output_size = full_size;
+  if (mode_ == "same") {
+    output_size = size1;
+  } else if (mode_ == "valid") {
+    output_size = std::max(size1, size2) - std::min(size1, size2) + 1;
+  }
+  const size_t offset = (full_size - output_size) / 2;
+
+  output.resize(output_size);
+  for (size_t i = 0; i < output_size; i++) output[i] = full[(full_start + offset + i) % full.size()];
+}
+
+Convolver::Convolver(const std::string mode, const std::string method) : FFTFilter(mode), method_(method) {
+  if (method_ != "auto" && method_ != "fft" && method_ != "overlap-add") {
+    throw std::runtime_error("Unsupported method '" + method_ + "', expected auto, fft or overlap-add.");
+  }
+}
+
+void Convolver::compute(const std::vector<double> &vec1, const std::vector<double> &vec2, std::vector<double> &output) {
+  if (vec1.empty() || vec2.empty()) {
+    output.clear();
+    return;
+  }
+  const bool overlap_add =
+      method_ == "overlap-add" || (method_ == "auto" && PreferOverlapAdd(vec1.size(), vec2.size()));
+  if (overlap_add) {
+    overlap_add_full(vec1, vec2);
+    slice_output(full_, vec1.size(), vec2.size(), 0, output);
+    return;
+  }
+
+  prepare(vec1.size() + vec2.size() - 1);
+  forward(vec1, buffer1_);
+  forward(vec2, buffer2_);
+  multiply_spectra(buffer2_, false);
+  backward();
+  slice_output(buffer1_, vec1.size(), vec2.size(), 0, output);
+}
+
+void Convolver::overlap_add_full(const std::vector<double> &vec1, const std::vector<double> &vec2) {
+  // Convolution commutes, the longer input is cut into blocks and the shorter one is the kernel.
+  const std::vector<double> &signal = vec1.size() >= vec2.size() ? vec1 : vec2;
+  const std::vector<double> &kernel = vec1.size() >= vec2.size() ? vec2 : vec1;
+
+  prepare(OverlapAddFFTSize(kernel.size()));
+  const size_t step = fft_size_ - kernel.size() + 1;
+  forward(kernel, buffer2_);
+
+  full_.assign(signal.size() + kernel.size() - 1, 0.);
+  for (size_t start = 0; start < signal.size(); start += step) {
+    const size_t block_size = std::min(step, signal.size() - start);
+    forward(signal.data() + start, block_size, buffer1_);
+    multiply_spectra(buffer2_, false);
+    backward();
+    // Every block adds its tail of kernel.size() - 1 samples onto the start of the next one.
+    const size_t output_size = block_size + kernel.size() - 1;
+    for (size_t i = 0; i < output_size; i++) full_[start + i] += buffer1_[i];
+  }
+}
+
+std::vector<double> Convolver::compute(const std::vector<double> &vec1, const std::vector<double> &vec2) {
+  std::vector<double> output;
+  compute(vec1, vec2, output);
+  return output;
+}
+
+void Correlator::compute(const std::vector<double> &vec1,
+                         const std::vector<double> &vec2,
+                         std::vector<double> &output) {
+  if (vec1.empty() || vec2.empty()) {
+    output.clear();
+    return;
+  }
+  prepare(vec1.size() + vec2.size() - 1);
+  forward(vec1, buffer1_);
+  forward(vec2, buffer2_);
+  multiply_spectra(buffer2_, true);
+  backward();
+  // The circular correlation holds the negative lags at the end of the buffer, the full output starts at the most
+  // negative one.
+  slice_output(buffer1_, vec1.size(), vec2.size(), fft_size_ - (vec2.size() - 1), output);
+}
+
+std::vector<double> Correlator::compute(const std::vector<double> &vec1, const std::vector<double> &vec2) {
+  std::vector<double> output;
+  compute(vec1, vec2, output);
+  return output;
+}
+
+void Correlator::autocorrelate(const std::vector<double> &signal, std::vector<double> &output) {
+  output.resize(signal.size());
+  if (signal.empty()) return;
+  prepare(2 * signal.size() - 1);
+  forward(signal, buffer1_);
+
+  double *a = buffer1_.data();
+  a[0] *= a[0];
+  size_t i = 1;
+  for (; i + 1 < fft_size_; i += 2) {
+    a[i] = a[i] * a[i] + a[i + 1] * a[i + 1];
+    a[i + 1] = 0.;
+  }
+  if (i < fft_size_) a[i] *= a[i];
+
+  backward();
+  std::copy(buffer1_.begin(), buffer1_.begin() + signal.size(), output.begin());
+}
+
+std::vector<double> Correlator::autocorrelate(const std::vector<double> &signal) {
+  std::vector<double> output;
+  autocorrelate(signal, output);
+  return output;
+}
+
+StreamingConvolver::StreamingConvolver(const std::vector<double> &kernel, size_t block_size)
+    : FFTFilter("full"), kernel_size_(kernel.size()) {
+  if (kernel.empty()) throw std::runtime_error("StreamingConvolver: kernel must not be empty.");
+  prepare(block_size == 0 ? OverlapAddFFTSize(kernel_size_) : block_size + kernel_size_ - 1);
+  step_ = fft_size_ - kernel_size_ + 1;
+  kernel_spectrum_.resize(fft_size_);
+  forward(kernel, kernel_spectrum_);
+  frame_.assign(fft_size_, 0.);
+}
+
+void StreamingConvolver::process_frame(size_t output_size, std::vector<double> &output) {
+  buffer1_ = frame_;
+  plan_->plan->forward(buffer1_.data(), 1.);
+  multiply_spectra(kernel_spectrum_, false);
+  backward();
+  // The first kernel_size - 1 outputs wrapped around the circular convolution, the rest are linear outputs.
+  auto linear_begin = buffer1_.begin() + static_cast<long>(kernel_size_ - 1);
+  output.insert(output.end(), linear_begin, linear_begin + static_cast<long>(output_size));
+
+  // The last kernel_size - 1 inputs are the history of the next frame.
+  std::copy(frame_.end() - (kernel_size_ - 1), frame_.end(), frame_.begin());
+  filled_ = 0;
+}
+
+void StreamingConvolver::process(const std::vector<double> &input, std::vector<double> &output) {
+  output.clear();
+  size_t consumed = 0;
+  while (consumed < input.size()) {
+    const size_t count = std::min(step_ - filled_, input.size() - consumed);
+    std::copy(input.begin() + consumed, input.begin() + consumed + count,
+              frame_.begin() + (kernel_size_ - 1) + filled_);
+    filled_ += count;
+    consumed += count;
+    if (filled_ == step_) process_frame(step_, output);
+  }
+}
+
+void StreamingConvolver::flush(std::vector<double> &output) {
+  output.clear();
+  // The pending inputs plus the tail of the kernel are still owed.
+  size_t remaining = filled_ + kernel_size_ - 1;
+  while (remaining > 0) {
+    std::fill(frame_.begin() + (kernel_size_ - 1) + filled_, frame_.end(), 0.);
+    const size_t output_size = std::min(step_, remaining);
+    process_frame(output_size, output);
+    remaining -= output_size;
+  }
+  reset();
+}
+
+void StreamingConvolver::reset() {
+  std::fill(frame_.begin(), frame_.end(), 0.);
+  filled_ = 0;
 }
 
 }  // namespace core
-}  // namespace musher
\ No newline at end of file
+}  // namespace musher
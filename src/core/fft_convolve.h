@@ -1,5 +1,8 @@
 #pragma once
 
+#include <cstddef>
+#include <memory>
+#include <string>
 #include <vector>
 
 namespace musher {
@@ -32,5 +35,277 @@ std::vector<double> CenterVector(const std::vector<double> &vec, size_t new_shap
  */
 std::vector<double> FFTConvolve(const std::vector<double> &vec1, const std::vector<double> &vec2);
 
+/**
+ * @brief FFT size of the blocks used to convolve a long signal with a kernel by overlap-add or overlap-save.
+ *
+ * @param kernel_size Size of the shorter input.
+ * @return size_t Number of points of the block FFT.
+ */
+size_t OverlapAddFFTSize(size_t kernel_size);
+
+/**
+ * @brief Whether a convolution of these sizes is cheaper by overlap-add than with a single FFT.
+ *
+ * Overlap-add is picked once the single FFT would be at least four times the size of the block FFT, which is when
+ * one input is roughly 30 or more times longer than the other.
+ *
+ * @param size1 Size of the first input.
+ * @param size2 Size of the second input.
+ * @return true Use overlap-add.
+ * @return false Use a single FFT.
+ */
+bool PreferOverlapAdd(size_t size1, size_t size2);
+
+struct RealFFTPlan;
+
+/**
+ * @brief Linear convolution or correlation of two signals through a single real FFT size.
+ *
+ * Holds the FFT plan and the work buffers of the last size it was used with, so repeated calls with inputs of the
+ * same sizes neither plan nor allocate. Products are taken directly on the packed (halfcomplex) spectra, so there are
+ * no complex intermediate vectors. Not thread safe, use one object per thread.
+ *
+ * Modes, matching scipy.signal:
+ * - **full** - The full discrete linear convolution, size vec1.size() + vec2.size() - 1.
+ * - **same** - The output is the same size as vec1, centered with respect to the full output.
+ * - **valid** - Only the elements that do not rely on zero padding, size max(N, M) - min(N, M) + 1.
+ */
+class FFTFilter {
+ protected:
+  const std::string mode_;
+  size_t fft_size_ = 0;
+  std::shared_ptr<const RealFFTPlan> plan_;
+  std::vector<double> buffer1_;
+  std::vector<double> buffer2_;
+
+  /**
+   * @brief Get a plan and buffers for an FFT of at least min_size points.
+   */
+  void prepare(size_t min_size);
+
+  /**
+   * @brief Forward transform a signal zero padded to the FFT size, in place in buffer.
+   */
+  void forward(const double *signal, size_t size, std::vector<double> &buffer) const;
+
+  /**
+   * @brief Overloaded forward that transforms a whole vector.
+   */
+  void forward(const std::vector<double> &signal, std::vector<double> &buffer) const;
+
+  /**
+   * @brief Inverse transform buffer1_ (normalized) in place.
+   */
+  void backward();
+
+  /**
+   * @brief Multiply the packed spectra in buffer1_ by the ones in spectrum, optionally conjugated.
+   */
+  void multiply_spectra(const std::vector<double> &spectrum, bool conjugate);
+
+  /**
+   * @brief Copy the mode's slice of the full output held in full (circularly, starting at full_start) to output.
+   */
+  void slice_output(const std::vector<double> &full,
+                    size_t size1,
+                    size_t size2,
+                    size_t full_start,
+                    std::vector<double> &output) const;
+
+ public:
+  /**
+   * @brief Construct a new FFTFilter object
+   *
+   * @param mode Output mode, full, same or valid.
+   */
+  explicit FFTFilter(const std::string mode);
+
+  /**
+   * @brief FFT size used by the last call.
+   *
+   * @return size_t Number of points of the FFT.
+   */
+  size_t fft_size() const { return fft_size_; }
+};
+
+/**
+ * @brief Reusable FFT convolution.
+ *
+ * When one input is much longer than the other, the longer one is cut into blocks that are convolved separately and
+ * added back together (overlap-add). Block FFTs are sized from the short input, so a long signal never needs one
+ * FFT of its whole length.
+ *
+ * @code{.cpp}
+ *   Convolver convolver("same");
+ *   for (const std::vector<double> &frame : frames) {
+ *     convolver.compute(frame, kernel, output);
+ *   }
+ * @endcode
+ */
+class Convolver : public FFTFilter {
+ private:
+  const std::string method_;
+  std::vector<double> full_;
+
+  /**
+   * @brief Full convolution of vec1 and vec2 into full_ by overlap-add.
+   */
+  void overlap_add_full(const std::vector<double> &vec1, const std::vector<double> &vec2);
+
+ public:
+  /**
+   * @brief Construct a new Convolver object
+   *
+   * @param mode Output mode, full, same or valid (see FFTFilter).
+   * @param method How the convolution is computed:
+   * - **auto** - Overlap-add if PreferOverlapAdd, otherwise a single FFT.
+   * - **fft** - A single FFT of the full output size.
+   * - **overlap-add** - Blocks of the longer input, see OverlapAddFFTSize.
+   */
+  explicit Convolver(const std::string mode = "same", const std::string method = "auto");
+
+  /**
+   * @brief Convolve vec1 with vec2 into an existing output vector.
+   *
+   * @param vec1 Vector 1
+   * @param vec2 Vector 2
+   * @param output Output, resized to the size of the mode.
+   */
+  void compute(const std::vector<double> &vec1, const std::vector<double> &vec2, std::vector<double> &output);
+
+  /**
+   * @brief Overloaded compute that returns the convolution.
+   *
+   * @param vec1 Vector 1
+   * @param vec2 Vector 2
+   * @return std::vector<double> Convolution of vec1 with vec2.
+   */
+  std::vector<double> compute(const std::vector<double> &vec1, const std::vector<double> &vec2);
+};
+
+/**
+ * @brief Reusable FFT cross-correlation and autocorrelation.
+ *
+ * The correlation is taken with the conjugate spectrum of vec2, so vec2 never has to be reversed and padded by hand.
+ * The full output holds lags -(vec2.size() - 1) to vec1.size() - 1, like scipy.signal.correlate.
+ */
+class Correlator : public FFTFilter {
+ public:
+  /**
+   * @brief Construct a new Correlator object
+   *
+   * @param mode Output mode of compute, full, same or valid (see FFTFilter).
+   */
+  explicit Correlator(const std::string mode = "full") : FFTFilter(mode) {}
+
+  /**
+   * @brief Cross-correlate vec1 with vec2 into an existing output vector.
+   *
+   * @param vec1 Vector 1
+   * @param vec2 Vector 2
+   * @param output Output, resized to the size of the mode.
+   */
+  void compute(const std::vector<double> &vec1, const std::vector<double> &vec2, std::vector<double> &output);
+
+  /**
+   * @brief Overloaded compute that returns the cross-correlation.
+   *
+   * @param vec1 Vector 1
+   * @param vec2 Vector 2
+   * @return std::vector<double> Cross-correlation of vec1 with vec2.
+   */
+  std::vector<double> compute(const std::vector<double> &vec1, const std::vector<double> &vec2);
+
+  /**
+   * @brief Autocorrelation of a signal for lags 0 to signal.size() - 1, ignoring the mode.
+   *
+   * Takes one forward FFT, the power spectrum and one inverse FFT, against two forward FFTs for a cross-correlation.
+   *
+   * @param signal Input signal.
+   * @param output Output, resized to signal.size(). output[k] is the sum of signal[n] * signal[n + k].
+   */
+  void autocorrelate(const std::vector<double> &signal, std::vector<double> &output);
+
+  /**
+   * @brief Overloaded autocorrelate that returns the autocorrelation.
+   *
+   * @param signal Input signal.
+   * @return std::vector<double> Autocorrelation for lags 0 to signal.size() - 1.
+   */
+  std::vector<double> autocorrelate(const std::vector<double> &signal);
+};
+
+/**
+ * @brief Convolution of a signal that arrives in pieces with a fixed kernel, by overlap-save.
+ *
+ * Every frame of the block FFT holds the last kernel.size() - 1 inputs followed by the new ones, so only the inputs
+ * are kept between calls and each output sample is computed once. The kernel spectrum is computed once. Outputs are
+ * released a block at a time, in order, and together with flush they make up the full convolution of everything
+ * pushed so far.
+ *
+ * @code{.cpp}
+ *   StreamingConvolver convolver(kernel);
+ *   std::vector<double> output;
+ *   for (const std::vector<double> &chunk : chunks) {
+ *     convolver.process(chunk, output);
+ *     write(output);
+ *   }
+ *   convolver.flush(output);
+ *   write(output);
+ * @endcode
+ */
+class StreamingConvolver : public FFTFilter {
+ private:
+  const size_t kernel_size_;
+  size_t step_ = 0;
+  size_t filled_ = 0;
+  std::vector<double> kernel_spectrum_;
+  std::vector<double> frame_;
+
+  /**
+   * @brief Convolve the current frame, append its first output_size linear outputs and keep the history.
+   */
+  void process_frame(size_t output_size, std::vector<double> &output);
+
+ public:
+  /**
+   * @brief Construct a new StreamingConvolver object
+   *
+   * @param kernel Kernel the stream is convolved with.
+   * @param block_size Minimum number of new input samples per block FFT (the latency in samples). The FFT size is
+   * rounded up to a fast length and the extra room is used for more samples. Set to 0 to pick it from the kernel size
+   * with OverlapAddFFTSize.
+   */
+  explicit StreamingConvolver(const std::vector<double> &kernel, size_t block_size = 0);
+
+  /**
+   * @brief Push input samples.
+   *
+   * @param input Next input samples, of any size.
+   * @param output Output, replaced by every convolution output that became complete (a multiple of block_size(),
+   * possibly none).
+   */
+  void process(const std::vector<double> &input, std::vector<double> &output);
+
+  /**
+   * @brief Finish the stream, as if it was followed by zeros, and reset it.
+   *
+   * @param output Output, replaced by the outputs still owed (pending inputs plus kernel.size() - 1 samples).
+   */
+  void flush(std::vector<double> &output);
+
+  /**
+   * @brief Drop every pending input and start a new stream with the same kernel.
+   */
+  void reset();
+
+  /**
+   * @brief Number of new input samples consumed by every block FFT.
+   *
+   * @return size_t Block size in samples.
+   */
+  size_t block_size() const { return step_; }
+};
+
 }  // namespace core
-}  // namespace musher
\ No newline at end of file
+}  // namespace musher
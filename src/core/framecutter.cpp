@@ -6,10 +6,12 @@
 #include <stdexcept>
 #include <vector>
 
+#include "src/core/instrumentation.h"
+
 namespace musher {
 namespace core {
 
-std::vector<double> Framecutter::compute() {
+bool Framecutter::next_frame_start(int &position, bool &last_frame, int &frame_start) const {
   if (valid_frame_threshold_ratio_ > 0.5 && start_from_center_) {
     throw std::runtime_error(
         "FrameCutter: valid_frame_threshold_ratio cannot be "
@@ -24,59 +26,93 @@ std::vector<double> Framecutter::compute() {
   size_t buffer_size = buffer_.size();
 
   if (start_from_center_)
-    start_index = -(frame_size_ + 1) / 2 + start_index_;
+    start_index = -(frame_size_ + 1) / 2 + position;
   else
-    start_index = start_index_;
-
-  if (last_frame_ || buffer_.empty()) return std::vector<double>();
-  if (start_index >= static_cast<int>(buffer_size)) return std::vector<double>();
+    start_index = position;
 
-  std::vector<double> frame(static_cast<size_t>(frame_size_));
-  int idx_in_frame = 0;
-
-  // If we're before the beginning of the buffer, fill the frame with 0
-  if (start_index < 0) {
-    int how_much = std::min(-start_index, frame_size_);
-    for (; idx_in_frame < how_much; idx_in_frame++) {
-      frame[idx_in_frame] = static_cast<double>(0.0);
-    }
-  }
+  if (last_frame || buffer_.empty()) return false;
+  if (start_index >= static_cast<int>(buffer_size)) return false;
 
-  // Now, just copy from the buffer to the frame
-  int how_much = std::min(frame_size_, static_cast<int>(buffer_size - start_index)) - idx_in_frame;
-  std::memcpy(&frame[0] + idx_in_frame, &buffer_[0] + start_index + idx_in_frame, how_much * sizeof(double));
-  idx_in_frame += how_much;
+  // Number of samples of the frame up to the end of the buffer (the zeros before its beginning included).
+  const int idx_in_frame = std::min(frame_size_, static_cast<int>(buffer_size) - start_index);
 
   // Check if the idx_in_frame is below the threshold (this would only happen
   // for the last frame in the stream)
-  if (idx_in_frame < valid_frame_threshold) return std::vector<double>();
+  if (idx_in_frame < valid_frame_threshold) return false;
 
   if (start_index + idx_in_frame >= static_cast<int>(buffer_size) && !start_from_center_ && !last_frame_to_end_of_file_)
-    last_frame_ = true;
+    last_frame = true;
 
   if (idx_in_frame < frame_size_) {
     if (!start_from_center_) {
       if (last_frame_to_end_of_file_) {
-        if (start_index >= static_cast<int>(buffer_size)) last_frame_ = true;
+        if (start_index >= static_cast<int>(buffer_size)) last_frame = true;
       }
       // if we're zero-padding with start_from_center=false, it means we're filling
       // in the last frame, so we'll have to stop after this one
       else
-        last_frame_ = true;
+        last_frame = true;
     } else {
       // if we're zero-padding and the center of the frame is past the end of the
       // stream, then this is the last frame and we need to stop after this one
-      if (start_index + frame_size_ / 2 >= static_cast<int>(buffer_.size())) {
-        last_frame_ = true;
+      if (start_index + frame_size_ / 2 >= static_cast<int>(buffer_size)) {
+        last_frame = true;
       }
     }
-    // Fill in the frame with 0 until the end of the buffer
-    for (; idx_in_frame < frame_size_; idx_in_frame++) {
-      frame[idx_in_frame] = static_cast<double>(0.0);
-    }
   }
-  start_index_ += hop_size_;
-  return frame;
+  position += hop_size_;
+  frame_start = start_index;
+  return true;
+}
+
+std::vector<int> Framecutter::compute_frame_starts() const {
+  // Frames would never advance, listing them would not end.
+  if (frame_size_ <= 0) throw std::runtime_error("Framecutter: frame_size must be positive.");
+  if (hop_size_ <= 0) throw std::runtime_error("Framecutter: hop_size must be positive.");
+  int position = 0;
+  bool last_frame = false;
+  int frame_start;
+  std::vector<int> starts;
+  while (next_frame_start(position, last_frame, frame_start)) starts.push_back(frame_start);
+  return starts;
+}
+
+void Framecutter::copy_frame(int frame_start, double *output) const {
+  // Copy the part of the frame that lies within the buffer, the rest is zero-padding.
+  const int copy_begin = std::max(frame_start, 0);
+  const int copy_end = std::min(frame_start + frame_size_, static_cast<int>(buffer_.size()));
+  if (copy_end <= copy_begin) {
+    std::fill(output, output + frame_size_, 0.);
+    return;
+  }
+  std::fill(output, output + (copy_begin - frame_start), 0.);
+  std::memcpy(output + (copy_begin - frame_start), buffer_.data() + copy_begin,
+              static_cast<size_t>(copy_end - copy_begin) * sizeof(double));
+  std::fill(output + (copy_end - frame_start), output + frame_size_, 0.);
+}
+
+std::vector<double> Framecutter::frame(size_t index) const {
+  if (index >= frame_starts_.size()) throw std::runtime_error("Framecutter: frame index out of range.");
+  MUSHER_STAGE_BEGIN(framecutter_timer, Stage::kFramecutter);
+  std::vector<double> output(static_cast<size_t>(frame_size_));
+  copy_frame(frame_starts_[index], output.data());
+  MUSHER_STAGE_END(framecutter_timer, 1, output.size() * sizeof(double));
+  return output;
+}
+
+void Framecutter::frame_into(size_t index, Span<double> output) const {
+  if (index >= frame_starts_.size()) throw std::runtime_error("Framecutter: frame index out of range.");
+  if (output.size() != static_cast<size_t>(frame_size_)) {
+    throw std::runtime_error("Framecutter: output must hold frame_size samples.");
+  }
+  MUSHER_STAGE_BEGIN(framecutter_timer, Stage::kFramecutter);
+  copy_frame(frame_starts_[index], output.data());
+  MUSHER_STAGE_END(framecutter_timer, 1, 0);
+}
+
+std::vector<double> Framecutter::compute() {
+  if (next_frame_ >= frame_starts_.size()) return std::vector<double>();
+  return frame(next_frame_++);
 }
 
 }  // namespace core
@@ -1,5 +1,11 @@
+#pragma once
+
+#include <memory>
+#include <utility>
 #include <vector>
 
+#include "src/core/span.h"
+
 namespace musher {
 namespace core {
 
@@ -13,26 +19,64 @@ namespace core {
  *       perform_work_on_frame(frame);
  *   }
  * @endcode
+ *
+ * A Framecutter built from a vector keeps its own copy of the samples (shared between copies of the Framecutter), one
+ * built from a Span reads the samples in place, so they must outlive it.
+ *
+ * Frames can also be cut in any order, from any number of threads, with num_frames and frame or frame_into:
+ *
+ * @code
+ *   ParallelFor(framecutter.num_frames(), 0, [&](size_t begin, size_t end) {
+ *     std::vector<double> frame(framecutter.frame_size());
+ *     for (size_t i = begin; i < end; i++) {
+ *       framecutter.frame_into(i, frame);
+ *       perform_work_on_frame(frame);
+ *     }
+ *   });
+ * @endcode
  */
 class Framecutter {
  private:
-  const std::vector<double> buffer_;
+  std::shared_ptr<const std::vector<double>> owned_buffer_;
+  const Span<const double> buffer_;
   const int frame_size_;
   const int hop_size_;
   const bool start_from_center_;
   const bool last_frame_to_end_of_file_;
   const double valid_frame_threshold_ratio_;
-  int start_index_;
-  bool last_frame_;
+  const std::vector<int> frame_starts_;
+  size_t next_frame_;
   std::vector<double> frame_;
 
+  /**
+   * @brief Find where the next frame starts without reading any samples.
+   *
+   * @param position Iteration state, position of the next frame before centering. Advanced by hop_size if there is a
+   * frame.
+   * @param last_frame Iteration state, true once the last frame was found.
+   * @param frame_start Output, index of the first sample of the frame in the buffer (negative if the frame begins
+   * before the buffer).
+   * @return bool False if there are no more frames.
+   */
+  bool next_frame_start(int &position, bool &last_frame, int &frame_start) const;
+
+  /**
+   * @brief Start of every frame, found once at construction. Throws if frame_size or hop_size is not positive.
+   */
+  std::vector<int> compute_frame_starts() const;
+
+  /**
+   * @brief Copy the frame starting at frame_start into output, zero-padding what lies outside of the buffer.
+   */
+  void copy_frame(int frame_start, double *output) const;
+
  public:
   /**
    * @brief Construct a new Framecutter object
    *
    * @param buffer Buffer from which to read data.
-   * @param frame_size Output frame size.
-   * @param hop_size Hop size between frames.
+   * @param frame_size Output frame size, throws if it is not positive.
+   * @param hop_size Hop size between frames, throws if it is not positive.
    * @param start_from_center If true start from the center of the buffer (zero-centered at -frameSize/2) or
    * if false the first frame at time 0 (centered at frameSize/2).
    * @param last_frame_to_end_of_file Whether the beginning of the last frame should reach the end of file. Only
@@ -41,7 +85,30 @@ class Framecutter {
    * zero-padded to a full frame. (i.e. a value of 0 will never discard frames and a value of 1 will only keep frames
    * that are of length 'frameSize')
    */
-  Framecutter(const std::vector<double> buffer,
+  Framecutter(std::vector<double> buffer,
+              int frame_size = 1024,
+              int hop_size = 512,
+              bool start_from_center = true,
+              bool last_frame_to_end_of_file = false,
+              double valid_frame_threshold_ratio = 0.)
+      : owned_buffer_(std::make_shared<const std::vector<double>>(std::move(buffer))),
+        buffer_(*owned_buffer_),
+        frame_size_(frame_size),
+        hop_size_(hop_size),
+        start_from_center_(start_from_center),
+        last_frame_to_end_of_file_(last_frame_to_end_of_file),
+        valid_frame_threshold_ratio_(valid_frame_threshold_ratio),
+        frame_starts_(compute_frame_starts()),
+        next_frame_(0),
+        frame_(compute()) {}
+
+  /**
+   * @brief Construct a new Framecutter object that reads the buffer without copying it. All other parameters are the
+   * same as above.
+   *
+   * @param buffer View of the samples to read, they must outlive the Framecutter.
+   */
+  Framecutter(Span<const double> buffer,
               int frame_size = 1024,
               int hop_size = 512,
               bool start_from_center = true,
@@ -53,8 +120,8 @@ class Framecutter {
         start_from_center_(start_from_center),
         last_frame_to_end_of_file_(last_frame_to_end_of_file),
         valid_frame_threshold_ratio_(valid_frame_threshold_ratio),
-        start_index_(0),
-        last_frame_(false),
+        frame_starts_(compute_frame_starts()),
+        next_frame_(0),
         frame_(compute()) {}
 
   ~Framecutter() {}
@@ -75,6 +142,43 @@ class Framecutter {
    */
   std::vector<double> operator*() const { return frame_; }
 
+  Span<const double> buffer() const { return buffer_; }
+  int frame_size() const { return frame_size_; }
+  int hop_size() const { return hop_size_; }
+
+  /**
+   * @brief Index of the first sample of every frame in the buffer, from the first frame regardless of the iteration.
+   *
+   * Frames begin every hop_size samples. A start below 0, or one within frame_size of the end of the buffer, marks a
+   * frame that is zero-padded.
+   *
+   * @return const std::vector<int>& Start of every frame, in order.
+   */
+  const std::vector<int> &frame_starts() const { return frame_starts_; }
+
+  /**
+   * @brief Number of frames, the same as the number of iterations.
+   */
+  size_t num_frames() const { return frame_starts_.size(); }
+
+  /**
+   * @brief Cut a single frame, regardless of the iteration.
+   *
+   * @param index Index of the frame, below num_frames.
+   * @return std::vector<double> The same frame as the index-th iteration.
+   */
+  std::vector<double> frame(size_t index) const;
+
+  /**
+   * @brief Cut a single frame into an existing buffer, without allocating.
+   *
+   * Only reads the Framecutter, so several threads can cut frames of the same Framecutter at once.
+   *
+   * @param index Index of the frame, below num_frames.
+   * @param output Output, frame_size samples the frame is written to.
+   */
+  void frame_into(size_t index, Span<double> output) const;
+
   /**
    * @brief Computes the actual slicing of the frames, this function is run on each iteration to calculate the next
    * frame.
@@ -85,7 +85,7 @@ void AddContribution(double freq,
                      double reference_frequency,
                      double window_size,
                      WeightType weight_type,
-                     std::vector<HarmonicPeak> harmonic_peaks,
+                     const std::vector<HarmonicPeak> &harmonic_peaks,
                      std::vector<double> &hpcp) {
   // TODO Change function from editing vector reference.
   std::vector<HarmonicPeak>::const_iterator it;
@@ -136,8 +136,8 @@ std::vector<HarmonicPeak> InitHarmonicContributionTable(int harmonics) {
   return harmonic_peaks;
 }
 
-std::vector<double> HPCP(const std::vector<double> &frequencies,
-                         const std::vector<double> &magnitudes,
+std::vector<double> HPCP(Span<const double> frequencies,
+                         Span<const double> magnitudes,
                          unsigned int size,
                          double reference_frequency,
                          unsigned int harmonics,
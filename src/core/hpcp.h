@@ -5,6 +5,8 @@
 #include <string>
 #include <vector>
 
+#include "src/core/span.h"
+
 namespace musher {
 namespace core {
 
@@ -129,7 +131,7 @@ void AddContribution(double freq,
                      double reference_frequency,
                      double window_size,
                      WeightType weight_type,
-                     std::vector<HarmonicPeak> harmonic_peaks,
+                     const std::vector<HarmonicPeak> &harmonic_peaks,
                      std::vector<double> &hpcp);
 
 /**
@@ -169,8 +171,8 @@ std::vector<HarmonicPeak> InitHarmonicContributionTable(int harmonics);
  * @param _normalized Whether to normalize the HPCP vector.
  * @return std::vector<double> Resulting harmonic pitch class profile.
  */
-std::vector<double> HPCP(const std::vector<double> &frequencies,
-                         const std::vector<double> &magnitudes,
+std::vector<double> HPCP(Span<const double> frequencies,
+                         Span<const double> magnitudes,
                          unsigned int size = 12,
                          double reference_frequency = 440.0,
                          unsigned int harmonics = 0,
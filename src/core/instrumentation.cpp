@@ -0,0 +1,98 @@
+#include "src/core/instrumentation.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include "src/core/trace.h"
+
+namespace musher {
+namespace core {
+
+namespace {
+
+std::atomic<InstrumentationSink*> instrumentation_sink(nullptr);
+
+}  // namespace
+
+const char* StageName(Stage stage) {
+  switch (stage) {
+    case Stage::kDecode:
+      return "decode";
+    case Stage::kMonoMix:
+      return "mono_mix";
+    case Stage::kResample:
+      return "resample";
+    case Stage::kFramecutter:
+      return "framecutter";
+    case Stage::kWindowing:
+      return "windowing";
+    case Stage::kSpectrum:
+      return "spectrum";
+    case Stage::kSpectralPeaks:
+      return "spectral_peaks";
+    case Stage::kHPCP:
+      return "hpcp";
+    case Stage::kKeyEstimate:
+      return "key_estimate";
+    case Stage::kDetectKey:
+      return "detect_key";
+  }
+  return "unknown";
+}
+
+void InstrumentationSink::record(Stage stage, uint64_t nanoseconds, uint64_t frames, uint64_t output_bytes) {
+  Counters& counters = counters_[static_cast<size_t>(stage)];
+  counters.calls.fetch_add(1, std::memory_order_relaxed);
+  counters.nanoseconds.fetch_add(nanoseconds, std::memory_order_relaxed);
+  counters.frames.fetch_add(frames, std::memory_order_relaxed);
+  counters.output_bytes.fetch_add(output_bytes, std::memory_order_relaxed);
+}
+
+std::vector<StageStats> InstrumentationSink::stats() const {
+  std::vector<StageStats> all_stats(kNumStages);
+  for (size_t i = 0; i < kNumStages; i++) {
+    const Counters& counters = counters_[i];
+    StageStats& stats = all_stats[i];
+    stats.stage = StageName(static_cast<Stage>(i));
+    stats.calls = counters.calls.load(std::memory_order_relaxed);
+    stats.seconds = static_cast<double>(counters.nanoseconds.load(std::memory_order_relaxed)) * 1e-9;
+    stats.frames = counters.frames.load(std::memory_order_relaxed);
+    stats.output_bytes = counters.output_bytes.load(std::memory_order_relaxed);
+  }
+  return all_stats;
+}
+
+void InstrumentationSink::reset() {
+  for (Counters& counters : counters_) {
+    counters.calls = 0;
+    counters.nanoseconds = 0;
+    counters.frames = 0;
+    counters.output_bytes = 0;
+  }
+}
+
+void SetInstrumentationSink(InstrumentationSink* sink) { instrumentation_sink = sink; }
+
+InstrumentationSink* GetInstrumentationSink() { return instrumentation_sink.load(std::memory_order_acquire); }
+
+void StageTimer::record(uint64_t frames, uint64_t output_bytes) {
+  const auto end = std::chrono::steady_clock::now();
+  if (sink_) {
+    const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start_).count();
+    sink_->record(stage_, static_cast<uint64_t>(elapsed), frames, output_bytes);
+  }
+  if (tracer_) tracer_->record(stage_, start_, end);
+}
+
+bool InstrumentationCompiled() {
+#ifdef MUSHER_INSTRUMENTATION
+  return true;
+#else
+  return false;
+#endif
+}
+
+}  // namespace core
+}  // namespace musher
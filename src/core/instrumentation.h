@@ -0,0 +1,160 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace musher {
+namespace core {
+
+/**
+ * @brief Stages of the key pipeline that are timed.
+ */
+enum class Stage {
+  kDecode,         //!< DecodeWav and DecodeMp3.
+  kMonoMix,        //!< MonoMixer.
+  kResample,       //!< Decimation before the analysis in DetectKey.
+  kFramecutter,    //!< Cutting a frame out of the signal.
+  kWindowing,      //!< Windowing of a frame.
+  kSpectrum,       //!< Magnitude spectrum of a frame.
+  kSpectralPeaks,  //!< Peak picking on a spectrum.
+  kHPCP,           //!< HPCP of the peaks of a frame.
+  kKeyEstimate,    //!< EstimateKey on the averaged HPCP (intermediate estimates included).
+  kDetectKey,      //!< Whole DetectKey call, every stage above included.
+};
+
+const size_t kNumStages = static_cast<size_t>(Stage::kDetectKey) + 1;
+
+/**
+ * @brief Name of a stage, such as "windowing".
+ */
+const char* StageName(Stage stage);
+
+/**
+ * @brief Cumulative statistics of a stage.
+ *
+ */
+struct StageStats {
+  std::string stage;             //!< Name of the stage.
+  uint64_t calls = 0;            //!< Number of times the stage ran.
+  double seconds = 0.;           //!< Total wall time spent in the stage \[s\].
+  uint64_t frames = 0;           //!< Frames processed (samples per channel for decoding and mixing).
+  uint64_t output_bytes = 0;     //!< Size of the buffers the stage returned \[bytes\], not its heap allocations.
+};
+
+/**
+ * @brief Destination of the measurements of the instrumented stages.
+ *
+ * Counters are atomic, so one sink can be shared by every thread (such as the workers of DetectKeyBatch).
+ *
+ * @code
+ *   InstrumentationSink sink;
+ *   SetInstrumentationSink(&sink);
+ *   DetectKey(samples, sample_rate);
+ *   SetInstrumentationSink(nullptr);
+ *   for (const StageStats &stats : sink.stats()) std::cout << stats.stage << " " << stats.seconds << std::endl;
+ * @endcode
+ */
+class InstrumentationSink {
+ private:
+  struct Counters {
+    std::atomic<uint64_t> calls{ 0 };
+    std::atomic<uint64_t> nanoseconds{ 0 };
+    std::atomic<uint64_t> frames{ 0 };
+    std::atomic<uint64_t> output_bytes{ 0 };
+  };
+  std::array<Counters, kNumStages> counters_;
+
+ public:
+  /**
+   * @brief Add a single run of a stage.
+   *
+   * @param stage Stage that ran.
+   * @param nanoseconds Time it took \[ns\].
+   * @param frames Frames it processed.
+   * @param output_bytes Size of the buffers it returned \[bytes\].
+   */
+  void record(Stage stage, uint64_t nanoseconds, uint64_t frames, uint64_t output_bytes);
+
+  /**
+   * @brief Statistics of every stage, in the order of Stage.
+   */
+  std::vector<StageStats> stats() const;
+
+  /**
+   * @brief Set every counter back to 0.
+   */
+  void reset();
+};
+
+/**
+ * @brief Set the sink instrumented stages record into.
+ *
+ * Only has an effect when the library is built with MUSHER_INSTRUMENTATION defined (the ENABLE_INSTRUMENTATION CMake
+ * option), otherwise the stages are not timed at all. The sink must outlive every call that may record into it.
+ *
+ * @param sink Sink to record into (set to nullptr to stop recording).
+ */
+void SetInstrumentationSink(InstrumentationSink* sink);
+
+/**
+ * @brief Sink instrumented stages currently record into, nullptr if none.
+ */
+InstrumentationSink* GetInstrumentationSink();
+
+/**
+ * @brief Whether the library was built with the instrumentation compiled in.
+ */
+bool InstrumentationCompiled();
+
+class Tracer;
+std::shared_ptr<Tracer> GetTracer();
+
+/**
+ * @brief Times a stage from its construction until stop() is called, if a sink or a tracer (see trace.h) is set.
+ *
+ * Use it through the MUSHER_STAGE_BEGIN and MUSHER_STAGE_END macros, which compile to nothing without
+ * MUSHER_INSTRUMENTATION. A stage that throws is not recorded.
+ */
+class StageTimer {
+ private:
+  InstrumentationSink* sink_;
+  std::shared_ptr<Tracer> tracer_;
+  const Stage stage_;
+  std::chrono::steady_clock::time_point start_;
+
+ public:
+  explicit StageTimer(Stage stage) : sink_(GetInstrumentationSink()), tracer_(GetTracer()), stage_(stage) {
+    if (sink_ || tracer_) start_ = std::chrono::steady_clock::now();
+  }
+
+  /**
+   * @brief Record the stage into the sink and the tracer that were set when the timer started, the timer keeps that
+   * tracer alive.
+   *
+   * @param frames Frames the stage processed.
+   * @param output_bytes Size of the buffers it returned \[bytes\].
+   */
+  void stop(uint64_t frames, uint64_t output_bytes) {
+    if (sink_ || tracer_) record(frames, output_bytes);
+  }
+
+ private:
+  void record(uint64_t frames, uint64_t output_bytes);
+};
+
+}  // namespace core
+}  // namespace musher
+
+#ifdef MUSHER_INSTRUMENTATION
+#define MUSHER_STAGE_BEGIN(timer, stage) ::musher::core::StageTimer timer(stage)
+#define MUSHER_STAGE_END(timer, frames, output_bytes) \
+  timer.stop(static_cast<uint64_t>(frames), static_cast<uint64_t>(output_bytes))
+#else
+#define MUSHER_STAGE_BEGIN(timer, stage) static_cast<void>(0)
+#define MUSHER_STAGE_END(timer, frames, output_bytes) static_cast<void>(0)
+#endif
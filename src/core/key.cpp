@@ -1,5 +1,6 @@
 #include "src/core/key.h"
 
+#include <algorithm>
 #include <cmath>
 #include <fplus/fplus.hpp>
 #include <sstream>
@@ -8,7 +9,9 @@
 
 #include "src/core/framecutter.h"
 #include "src/core/hpcp.h"
+#include "src/core/instrumentation.h"
 #include "src/core/mono_mixer.h"
+#include "src/core/resample.h"
 #include "src/core/spectral_peaks.h"
 #include "src/core/spectrum.h"
 #include "src/core/windowing.h"
@@ -563,7 +566,7 @@ KeyOutput EstimateKey(const std::vector<double>& pcp,
   return key_output;
 }
 
-KeyOutput DetectKey(const std::vector<std::vector<double>>& normalized_samples,
+KeyOutput DetectKey(Span<const double> mono_samples,
                     double sample_rate,
                     const std::string profile_type,
                     const bool use_polphony,
@@ -572,35 +575,160 @@ KeyOutput DetectKey(const std::vector<std::vector<double>>& normalized_samples,
                     const double slope,
                     const bool use_maj_min,
                     const unsigned int pcp_size,
-                    const int frame_size,
-                    const int hop_size,
+                    int frame_size,
+                    int hop_size,
                     const std::function<std::vector<double>(const std::vector<double>&)>& window_type_func,
                     unsigned int max_num_peaks,
-                    double window_size) {
-  std::vector<double> mixed_audio = MonoMixer(normalized_samples);
+                    double window_size,
+                    unsigned int early_stop_interval,
+                    unsigned int early_stop_stable_checks,
+                    double early_stop_tolerance,
+                    double analysis_sample_rate,
+                    const std::function<void(const std::vector<double>&)>& spectrum_callback) {
+  // Only peaks within this range contribute to the HPCP.
+  const double min_frequency = 40.0;
+  const double max_frequency = 5000.0;
+
+  if (analysis_sample_rate > 0. && analysis_sample_rate < 2. * max_frequency) {
+    std::stringstream ss;
+    ss << "DetectKey: analysis_sample_rate (" << analysis_sample_rate << " Hz) must be 0 or at least "
+       << 2. * max_frequency << " Hz to keep the HPCP range.";
+    throw std::runtime_error(ss.str());
+  }
+
+  MUSHER_STAGE_BEGIN(detect_key_timer, Stage::kDetectKey);
+  Span<const double> audio = mono_samples;
+
+  // Nothing above the HPCP range is used, so the audio can be decimated before framing. Frames are scaled to keep
+  // their duration, which keeps the bin spacing (and therefore the HPCP) the same at a fraction of the FFT size.
+  std::vector<double> resampled_audio;
+  if (analysis_sample_rate > 0. && analysis_sample_rate < sample_rate) {
+    const double ratio = analysis_sample_rate / sample_rate;
+    MUSHER_STAGE_BEGIN(resample_timer, Stage::kResample);
+    resampled_audio = ResampleToRate(mono_samples, sample_rate, analysis_sample_rate);
+    MUSHER_STAGE_END(resample_timer, mono_samples.size(), resampled_audio.size() * sizeof(double));
+    audio = resampled_audio;
+    frame_size = std::max(1, static_cast<int>(std::lround(frame_size * ratio)));
+    hop_size = std::max(1, static_cast<int>(std::lround(hop_size * ratio)));
+    sample_rate = analysis_sample_rate;
+  }
 
-  Framecutter framecutter(mixed_audio, frame_size, hop_size);
+  Framecutter framecutter(audio, frame_size, hop_size);
+
+  // When the number of peaks is capped, peaks outside of the HPCP range still count towards the cap, so the whole
+  // spectrum has to be searched to get the same result. Otherwise only the bins of the HPCP range are touched.
+  const bool band_limited = max_num_peaks == 0;
+  int min_bin;
+  int max_bin;
+  std::tie(min_bin, max_bin) =
+      SpectralPeaksBinRange(FrequencySpectrumSize(frame_size), sample_rate, min_frequency, max_frequency);
 
   int count = 0;
   std::vector<double> sums(static_cast<size_t>(pcp_size), 0.);
+  auto average_hpcp = [&sums, &count]() {
+    std::vector<double> avgs(sums.size());
+    std::transform(sums.begin(), sums.end(), avgs.begin(), [&count](auto const& sum) { return sum / count; });
+    return avgs;
+  };
+
+  // Early stopping state
+  unsigned int stable_checks = 0;
+  KeyOutput previous_estimate;
 
   for (const std::vector<double>& frame : framecutter) {
     // NOTE: Windowing and ConvertToFrequencySpectrum are slowest functions here.
+    MUSHER_STAGE_BEGIN(windowing_timer, Stage::kWindowing);
     std::vector<double> windowed_frame = Windowing(frame, window_type_func);
-    std::vector<double> spectrum = ConvertToFrequencySpectrum(windowed_frame);
-    std::vector<std::tuple<double, double>> spectral_peaks =
-        SpectralPeaks(spectrum, -1000.0, "height", max_num_peaks, sample_rate, 0, sample_rate / 2);
-    std::vector<double> hpcp = HPCP(spectral_peaks, pcp_size, 440.0, num_harmonics - 1, true, 500.0, 40.0, 5000.0,
-                                    "squared cosine", window_size);
+    MUSHER_STAGE_END(windowing_timer, 1, windowed_frame.size() * sizeof(double));
+
+    MUSHER_STAGE_BEGIN(spectrum_timer, Stage::kSpectrum);
+    std::vector<double> spectrum = band_limited ? ConvertToFrequencySpectrum(windowed_frame, min_bin, max_bin)
+                                                : ConvertToFrequencySpectrum(windowed_frame);
+    MUSHER_STAGE_END(spectrum_timer, 1, spectrum.size() * sizeof(double));
+
+    MUSHER_STAGE_BEGIN(spectral_peaks_timer, Stage::kSpectralPeaks);
+    std::vector<std::tuple<double, double>> spectral_peaks;
+    if (band_limited) {
+      spectral_peaks =
+          SpectralPeaksInRange(spectrum, -1000.0, "height", max_num_peaks, sample_rate, min_frequency, max_frequency);
+    } else {
+      spectral_peaks = SpectralPeaks(spectrum, -1000.0, "height", max_num_peaks, sample_rate, 0, sample_rate / 2);
+    }
+    MUSHER_STAGE_END(spectral_peaks_timer, 1, spectral_peaks.size() * sizeof(std::tuple<double, double>));
+
+    if (spectrum_callback) spectrum_callback(spectrum);
+    MUSHER_STAGE_BEGIN(hpcp_timer, Stage::kHPCP);
+    std::vector<double> hpcp = HPCP(spectral_peaks, pcp_size, 440.0, num_harmonics - 1, true, 500.0, min_frequency,
+                                    max_frequency, "squared cosine", window_size);
+    MUSHER_STAGE_END(hpcp_timer, 1, hpcp.size() * sizeof(double));
 
     for (int i = 0; i < static_cast<int>(hpcp.size()); i++) {
       sums[i] += hpcp[i];
     }
     count += 1;
+
+    if (early_stop_interval == 0 || count % early_stop_interval != 0) continue;
+
+    // Stop once the winning key and its relative strength have settled on the running average.
+    MUSHER_STAGE_BEGIN(estimate_timer, Stage::kKeyEstimate);
+    KeyOutput estimate =
+        EstimateKey(average_hpcp(), use_polphony, use_three_chords, num_harmonics, slope, profile_type, use_maj_min);
+    MUSHER_STAGE_END(estimate_timer, 0, 0);
+    if (previous_estimate.frames_processed > 0 && estimate.key == previous_estimate.key &&
+        estimate.scale == previous_estimate.scale &&
+        std::abs(estimate.first_to_second_relative_strength - previous_estimate.first_to_second_relative_strength) <=
+            early_stop_tolerance) {
+      stable_checks += 1;
+    } else {
+      stable_checks = 0;
+    }
+    estimate.frames_processed = count;
+    previous_estimate = estimate;
+
+    if (stable_checks >= early_stop_stable_checks) {
+      MUSHER_STAGE_END(detect_key_timer, count, 0);
+      return estimate;
+    }
+  }
+  MUSHER_STAGE_BEGIN(estimate_timer, Stage::kKeyEstimate);
+  KeyOutput key_output =
+      EstimateKey(average_hpcp(), use_polphony, use_three_chords, num_harmonics, slope, profile_type, use_maj_min);
+  MUSHER_STAGE_END(estimate_timer, 0, 0);
+  key_output.frames_processed = count;
+  MUSHER_STAGE_END(detect_key_timer, count, 0);
+  return key_output;
+}
+
+KeyOutput DetectKey(const AudioBuffer& normalized_samples,
+                    double sample_rate,
+                    const std::string profile_type,
+                    const bool use_polphony,
+                    const bool use_three_chords,
+                    const unsigned int num_harmonics,
+                    const double slope,
+                    const bool use_maj_min,
+                    const unsigned int pcp_size,
+                    int frame_size,
+                    int hop_size,
+                    const std::function<std::vector<double>(const std::vector<double>&)>& window_type_func,
+                    unsigned int max_num_peaks,
+                    double window_size,
+                    unsigned int early_stop_interval,
+                    unsigned int early_stop_stable_checks,
+                    double early_stop_tolerance,
+                    double analysis_sample_rate,
+                    const std::function<void(const std::vector<double>&)>& spectrum_callback) {
+  // Mono samples are analysed in place, only stereo samples need a mixed copy.
+  std::vector<double> mixed_audio;
+  Span<const double> mono_samples = normalized_samples.channel(0);
+  if (normalized_samples.channels() != 1) {
+    mixed_audio = MonoMixer(normalized_samples);
+    mono_samples = mixed_audio;
   }
-  std::vector<double> avgs(sums.size());
-  std::transform(sums.begin(), sums.end(), avgs.begin(), [&count](auto const& sum) { return sum / count; });
-  return EstimateKey(avgs, use_polphony, use_three_chords, num_harmonics, slope, profile_type, use_maj_min);
+  return DetectKey(mono_samples, sample_rate, profile_type, use_polphony, use_three_chords, num_harmonics, slope,
+                   use_maj_min, pcp_size, frame_size, hop_size, window_type_func, max_num_peaks, window_size,
+                   early_stop_interval, early_stop_stable_checks, early_stop_tolerance, analysis_sample_rate,
+                   spectrum_callback);
 }
 
 }  // namespace core
@@ -1,10 +1,13 @@
 #pragma once
 
+#include <functional>
 #include <iostream>
 #include <string>
 #include <vector>
 
+#include "src/core/audio_buffer.h"
 #include "src/core/hpcp.h"
+#include "src/core/span.h"
 #include "src/core/utils.h"
 #include "src/core/windowing.h"
 
@@ -24,6 +27,7 @@ struct KeyOutput {
   std::string scale;
   double strength;
   double first_to_second_relative_strength;
+  int frames_processed = 0;  //!< Number of frames that contributed to the estimate (0 if not frame based).
 };
 
 /**
@@ -204,7 +208,8 @@ KeyOutput EstimateKey(const std::vector<double>& pcp,
 /**
  * @brief Computes key estimate given normalized samples.
  *
- * @param normalized_samples Normalized samples, either stereo or mono.
+ * @param normalized_samples Normalized samples, either stereo or mono. Stereo samples are mixed down with MonoMixer,
+ * mono samples are analysed in place.
  * @param sample_rate Sampling rate of the audio signal \[Hz\].
  * @param profile_type The type of polyphic profile to use for correlation calculation.
  * @param use_polphony Enables the use of polyphonic profiles to define key profiles (this includes the contributions
@@ -219,17 +224,32 @@ KeyOutput EstimateKey(const std::vector<double>& pcp,
  * @param frame_size Output frame size.
  * @param hop_size Hop size between frames.
  * @param window_type_func The window type function. Examples: BlackmanHarris92dB, BlackmanHarris62dB...
- * @param max_num_peaks Maximum number of returned peaks (set to 0 to return all peaks).
+ * @param max_num_peaks Maximum number of returned peaks (set to 0 to return all peaks). With 0, only the part of the
+ * spectrum within the HPCP frequency range is computed and searched for peaks.
  * @param window_size Size, in semitones, of the window used for the weighting.
+ * @param early_stop_interval Number of frames between intermediate key estimates on the running HPCP average (set to 0
+ * to disable early stopping and process every frame).
+ * @param early_stop_stable_checks Number of consecutive intermediate estimates that must agree with the previous one
+ * before processing stops.
+ * @param early_stop_tolerance Maximum change of first_to_second_relative_strength between two intermediate estimates
+ * for them to be considered in agreement.
+ * @param analysis_sample_rate Sampling rate to analyse the audio at \[Hz\] (set to 0 to analyse at sample_rate). When
+ * lower than sample_rate the audio is resampled first and frame_size and hop_size are scaled by the same ratio, so
+ * frames keep their duration and frequency resolution. It must be at least 10000 Hz so the whole HPCP range (up to
+ * 5000 Hz) is kept, otherwise a std::runtime_error is thrown.
+ * @param spectrum_callback Called with the magnitude spectrum of every analysed frame, so other features (such as
+ * OnsetStrength) can share the STFT instead of computing their own. When max_num_peaks is 0 only the bins of the HPCP
+ * range are filled in, the rest are 0.
  * @return KeyOutput A struct containing the following:
  *      key: Estimated key, from A to G.
  *      scale: Scale of the key (major or minor).
  *      strength: Strength of the estimated key.
  *      first_to_second_relative_strength: The relative strength difference between the best estimate and second best
  *       estimate of the key.
+ *      frames_processed: Number of frames analysed before the estimate was returned.
  */
 KeyOutput DetectKey(
-    const std::vector<std::vector<double>>& normalized_samples,
+    const AudioBuffer& normalized_samples,
     double sample_rate = 44100.,
     const std::string profile_type = "Bgate",
     const bool use_polphony = true,
@@ -242,7 +262,42 @@ KeyOutput DetectKey(
     const int hop_size = 512,
     const std::function<std::vector<double>(const std::vector<double>&)>& window_type_func = BlackmanHarris62dB,
     unsigned int max_num_peaks = 100,
-    double window_size = .5);
+    double window_size = .5,
+    unsigned int early_stop_interval = 0,
+    unsigned int early_stop_stable_checks = 3,
+    double early_stop_tolerance = 0.01,
+    double analysis_sample_rate = 0.,
+    const std::function<void(const std::vector<double>&)>& spectrum_callback = nullptr);
+
+/**
+ * @brief Overloaded DetectKey that accepts a single channel of normalized samples.
+ *
+ * Pair it with the mono_downmix option of the decoders to skip the per channel buffers and the MonoMixer pass. All
+ * other parameters are the same as above.
+ *
+ * @param mono_samples Normalized mono samples.
+ * @return KeyOutput Key estimate, see above.
+ */
+KeyOutput DetectKey(
+    Span<const double> mono_samples,
+    double sample_rate = 44100.,
+    const std::string profile_type = "Bgate",
+    const bool use_polphony = true,
+    const bool use_three_chords = true,
+    const unsigned int num_harmonics = 4,
+    const double slope = 0.6,
+    const bool use_maj_min = false,
+    const unsigned int pcp_size = 36,
+    const int frame_size = 4096,
+    const int hop_size = 512,
+    const std::function<std::vector<double>(const std::vector<double>&)>& window_type_func = BlackmanHarris62dB,
+    unsigned int max_num_peaks = 100,
+    double window_size = .5,
+    unsigned int early_stop_interval = 0,
+    unsigned int early_stop_stable_checks = 3,
+    double early_stop_tolerance = 0.01,
+    double analysis_sample_rate = 0.,
+    const std::function<void(const std::vector<double>&)>& spectrum_callback = nullptr);
 
 }  // namespace core
 }  // namespace musher
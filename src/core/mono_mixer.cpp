@@ -1,29 +1,41 @@
+#include "src/core/mono_mixer.h"
+
 #include <stdexcept>
 #include <vector>
 
+#include "src/core/instrumentation.h"
+
 namespace musher {
 namespace core {
 
 std::vector<double> MonoMixer(const std::vector<std::vector<double>> &input) {
+  return MonoMixer(std::vector<Span<const double>>(input.begin(), input.end()));
+}
+
+std::vector<double> MonoMixer(const AudioBuffer &input) { return MonoMixer(input.channel_spans()); }
+
+std::vector<double> MonoMixer(const std::vector<Span<const double>> &input) {
   int num_channels = input.size();
   if (num_channels > 2 || input.empty()) {
-    std::runtime_error("Audio samples must be either mono or stereo.");
+    throw std::runtime_error("Audio samples must be either mono or stereo.");
   }
 
   if (num_channels == 1) {
-    return input[0];
+    return std::vector<double>(input[0].begin(), input[0].end());
   }
 
-  const std::vector<double> channel_one = input[0];
-  const std::vector<double> channel_two = input[1];
+  const Span<const double> &channel_one = input[0];
+  const Span<const double> &channel_two = input[1];
 
-  if (channel_one.size() != channel_two.size()) std::runtime_error("Audio channels must be the same length.");
+  if (channel_one.size() != channel_two.size()) throw std::runtime_error("Audio channels must be the same length.");
   int size = channel_one.size();
+  MUSHER_STAGE_BEGIN(mono_mix_timer, Stage::kMonoMix);
   std::vector<double> result(size);
 
   for (int i = 0; i < size; ++i) {
     result[i] = 0.5 * (channel_one[i] + channel_two[i]);
   }
+  MUSHER_STAGE_END(mono_mix_timer, size, result.size() * sizeof(double));
   return result;
 }
 
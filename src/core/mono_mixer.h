@@ -2,6 +2,9 @@
 
 #include <vector>
 
+#include "src/core/audio_buffer.h"
+#include "src/core/span.h"
+
 namespace musher {
 namespace core {
 
@@ -15,5 +18,22 @@ namespace core {
  */
 std::vector<double> MonoMixer(const std::vector<std::vector<double>> &input);
 
+/**
+ * @brief Overloaded MonoMixer that reads every channel through a view, so channels held in memory owned elsewhere
+ * (such as the rows of a numpy array) are not copied before mixing.
+ *
+ * @param input Views of the channels of a stereo or mono audio signal.
+ * @return std::vector<double> Downmixed audio signal
+ */
+std::vector<double> MonoMixer(const std::vector<Span<const double>> &input);
+
+/**
+ * @brief Overloaded MonoMixer that downmixes every channel of an AudioBuffer.
+ *
+ * @param input Stereo or mono audio signal.
+ * @return std::vector<double> Downmixed audio signal
+ */
+std::vector<double> MonoMixer(const AudioBuffer &input);
+
 }  // namespace core
 }  // namespace musher
@@ -0,0 +1,70 @@
+#include "src/core/onset.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+namespace musher {
+namespace core {
+
+namespace {
+
+inline double CompressMagnitude(double magnitude, double log_compression) {
+  return log_compression > 0. ? std::log1p(log_compression * magnitude) : magnitude;
+}
+
+}  // namespace
+
+double SpectralFlux(const std::vector<double> &spectrum,
+                    const std::vector<double> &previous_spectrum,
+                    double log_compression) {
+  if (spectrum.size() != previous_spectrum.size()) {
+    throw std::runtime_error("SpectralFlux: spectra must be the same size.");
+  }
+
+  double flux = 0.;
+  for (size_t i = 0; i < spectrum.size(); i++) {
+    double difference =
+        CompressMagnitude(spectrum[i], log_compression) - CompressMagnitude(previous_spectrum[i], log_compression);
+    if (difference > 0.) flux += difference;
+  }
+  return flux;
+}
+
+void OnsetStrength::process(const std::vector<double> &spectrum) {
+  // Keep the previous frame compressed so every magnitude is only compressed once.
+  compressed_spectrum_.resize(spectrum.size());
+  std::transform(spectrum.begin(), spectrum.end(), compressed_spectrum_.begin(),
+                 [this](const double magnitude) { return CompressMagnitude(magnitude, log_compression_); });
+
+  double flux = 0.;
+  if (!previous_spectrum_.empty()) {
+    if (previous_spectrum_.size() != compressed_spectrum_.size()) {
+      throw std::runtime_error("OnsetStrength: spectra must be the same size.");
+    }
+    for (size_t i = 0; i < compressed_spectrum_.size(); i++) {
+      double difference = compressed_spectrum_[i] - previous_spectrum_[i];
+      if (difference > 0.) flux += difference;
+    }
+  }
+  envelope_.push_back(flux);
+  previous_spectrum_.swap(compressed_spectrum_);
+}
+
+void OnsetStrength::reset() {
+  previous_spectrum_.clear();
+  compressed_spectrum_.clear();
+  envelope_.clear();
+}
+
+std::vector<double> OnsetStrengthEnvelope(const std::vector<std::vector<double>> &spectra, double log_compression) {
+  OnsetStrength onset_strength(log_compression);
+  for (const std::vector<double> &spectrum : spectra) {
+    onset_strength.process(spectrum);
+  }
+  return onset_strength.envelope();
+}
+
+}  // namespace core
+}  // namespace musher
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <vector>
+
+namespace musher {
+namespace core {
+
+/**
+ * @brief Compute the spectral flux between two magnitude spectra.
+ *
+ * The flux is the sum, over all bins, of the half wave rectified increase in (optionally log compressed) magnitude.
+ * Only energy that appears is counted, so note onsets score high while decays do not.
+ *
+ * @param spectrum Magnitude spectrum of the current frame.
+ * @param previous_spectrum Magnitude spectrum of the previous frame (same size as spectrum).
+ * @param log_compression Magnitudes are compressed with log(1 + log_compression * magnitude). Set to 0 to compare
+ * raw magnitudes.
+ * @return double Spectral flux.
+ */
+double SpectralFlux(const std::vector<double> &spectrum,
+                    const std::vector<double> &previous_spectrum,
+                    double log_compression = 1000.);
+
+/**
+ * @brief Onset strength envelope built one frame at a time from magnitude spectra.
+ *
+ * Meant to be fed the spectra an analysis already computes (for example through the spectrum_callback of
+ * DetectKey), so rhythm features come from the same STFT as the key instead of a second one.
+ *
+ * @code
+ *   OnsetStrength onset_strength;
+ *   for (const std::vector<double> &frame : framecutter) {
+ *       onset_strength.process(ConvertToFrequencySpectrum(Windowing(frame, BlackmanHarris62dB)));
+ *   }
+ *   std::vector<double> envelope = onset_strength.envelope();
+ * @endcode
+ */
+class OnsetStrength {
+ private:
+  const double log_compression_;
+  std::vector<double> previous_spectrum_;
+  std::vector<double> compressed_spectrum_;
+  std::vector<double> envelope_;
+
+ public:
+  /**
+   * @brief Construct a new OnsetStrength object
+   *
+   * @param log_compression Magnitudes are compressed with log(1 + log_compression * magnitude). Set to 0 to compare
+   * raw magnitudes.
+   */
+  explicit OnsetStrength(double log_compression = 1000.) : log_compression_(log_compression) {}
+
+  /**
+   * @brief Append the onset strength of the next frame.
+   *
+   * The first frame has no predecessor and scores 0. All spectra must have the same size.
+   *
+   * @param spectrum Magnitude spectrum of the frame.
+   */
+  void process(const std::vector<double> &spectrum);
+
+  /**
+   * @brief Onset strength of every frame processed so far, one value per frame.
+   *
+   * @return const std::vector<double>& Onset strength envelope.
+   */
+  const std::vector<double> &envelope() const { return envelope_; }
+
+  /**
+   * @brief Forget every processed frame.
+   */
+  void reset();
+};
+
+/**
+ * @brief Onset strength envelope of a sequence of magnitude spectra.
+ *
+ * @param spectra Magnitude spectra, one per frame.
+ * @param log_compression Magnitudes are compressed with log(1 + log_compression * magnitude). Set to 0 to compare
+ * raw magnitudes.
+ * @return std::vector<double> Onset strength of each frame (the first one is 0).
+ */
+std::vector<double> OnsetStrengthEnvelope(const std::vector<std::vector<double>> &spectra,
+                                          double log_compression = 1000.);
+
+}  // namespace core
+}  // namespace musher
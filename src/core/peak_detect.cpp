@@ -1,8 +1,13 @@
 #include "src/core/peak_detect.h"
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 #include <algorithm>
 #include <cctype>
 #include <cmath>
+#include <cstdint>
 #include <stdexcept>
 #include <string>
 #include <tuple>
@@ -11,6 +16,123 @@
 namespace musher {
 namespace core {
 
+namespace {
+
+int CountTrailingZeros(uint64_t word) {
+#ifdef __GNUC__
+  return __builtin_ctzll(word);
+#else
+  int bit = 0;
+  while (!(word & 1)) {
+    word >>= 1;
+    bit++;
+  }
+  return bit;
+#endif
+}
+
+int PopCount(uint64_t word) {
+#ifdef __GNUC__
+  return __builtin_popcountll(word);
+#else
+  int count = 0;
+  for (; word; word &= word - 1) count++;
+  return count;
+#endif
+}
+
+/**
+ * @brief Candidate bits of the 64 elements starting at word_begin (a multiple of 64), see CandidatePeaks. Only
+ * elements in [first, last) can be candidates, where first >= 1 and x[last] exists.
+ */
+uint64_t CandidateWord(const double *x, int word_begin, int first, int last, double threshold) {
+  const int i_begin = std::max(word_begin, first);
+  const int i_end = std::min(word_begin + 64, last);
+  if (i_begin >= i_end) return 0;
+
+  // An element is a candidate if it rises from its left neighbour and its right neighbour does not rise from it, so a
+  // single comparison per element (plus the threshold) gives every candidate. Bit k of the word covers element
+  // word_begin + k, the right neighbour of its last element is compared on its own.
+  uint64_t rising = 0;
+  uint64_t above_threshold = 0;
+  int i = i_begin;
+#ifdef __SSE2__
+  const __m128d threshold_pd = _mm_set1_pd(threshold);
+  // Four elements a step, so each step adds one nibble to both masks.
+  for (; i + 4 <= i_end; i += 4) {
+    const __m128d current_low = _mm_loadu_pd(x + i);
+    const __m128d current_high = _mm_loadu_pd(x + i + 2);
+    const int rising_nibble = _mm_movemask_pd(_mm_cmpgt_pd(current_low, _mm_loadu_pd(x + i - 1))) |
+                              _mm_movemask_pd(_mm_cmpgt_pd(current_high, _mm_loadu_pd(x + i + 1))) << 2;
+    const int above_threshold_nibble = _mm_movemask_pd(_mm_cmpgt_pd(current_low, threshold_pd)) |
+                                       _mm_movemask_pd(_mm_cmpgt_pd(current_high, threshold_pd)) << 2;
+    rising |= static_cast<uint64_t>(rising_nibble) << (i - word_begin);
+    above_threshold |= static_cast<uint64_t>(above_threshold_nibble) << (i - word_begin);
+  }
+#endif
+  for (; i < i_end; i++) {
+    rising |= static_cast<uint64_t>(x[i] > x[i - 1]) << (i - word_begin);
+    above_threshold |= static_cast<uint64_t>(x[i] > threshold) << (i - word_begin);
+  }
+  // Right neighbours: bit k of rising_after is whether element word_begin + k + 1 rises from element word_begin + k.
+  const uint64_t last_rising_after = static_cast<uint64_t>(x[i_end] > x[i_end - 1]);
+  const uint64_t rising_after = (rising >> 1) | (last_rising_after << (i_end - 1 - word_begin));
+  return rising & ~rising_after & above_threshold;
+}
+
+/**
+ * @brief Number of candidate words ScanPeaks keeps on the stack (1 KB), enough for 8192 elements, so the spectrum of
+ * any frame of up to 16384 samples. Longer ranges fall back to the heap.
+ */
+const int kStackCandidateWords = 128;
+
+/**
+ * @brief Index of the first word of the candidate mask of a range, the words before it are not stored.
+ */
+int FirstCandidateWord(int begin) { return (begin + 1) >> 6; }
+
+/**
+ * @brief Number of words the candidate mask of a range takes, covering elements up to end.
+ */
+int NumCandidateWords(int begin, int end) { return std::max(0, ((end + 63) >> 6) - FirstCandidateWord(begin)); }
+
+/**
+ * @brief Write the candidate mask of a range into words, word k covering elements from 64 * (first word + k) on.
+ *
+ * @return size_t Number of candidates.
+ */
+size_t FillCandidateWords(Span<const double> inp, int begin, int end, double threshold, uint64_t *words) {
+  // Candidates lie in [first, last), where both neighbours exist.
+  const int first = begin + 1;
+  const int last = end - 1;
+  const int first_word = FirstCandidateWord(begin);
+  const int num_words = NumCandidateWords(begin, end);
+  size_t num_candidates = 0;
+  for (int word = 0; word < num_words; word++) {
+    words[word] = CandidateWord(inp.data(), (first_word + word) << 6, first, last, threshold);
+    num_candidates += static_cast<size_t>(PopCount(words[word]));
+  }
+  return num_candidates;
+}
+
+/**
+ * @brief Index of the first candidate at or after from, end if there is none.
+ *
+ * @param words Candidate mask, word k covering elements from 64 * (first_word + k) on.
+ */
+int NextCandidate(const uint64_t *words, int first_word, int num_words, int from, int end) {
+  if (from >= end) return end;
+  int word_index = (from >> 6) - first_word;
+  uint64_t word = words[word_index] & (~uint64_t(0) << (from & 63));
+  while (word == 0) {
+    if (++word_index >= num_words) return end;
+    word = words[word_index];
+  }
+  return std::min(((first_word + word_index) << 6) + CountTrailingZeros(word), end);
+}
+
+}  // namespace
+
 std::tuple<double, double> QuadraticInterpolation(double a, double b, double y, int middle_point_index) {
   double p = 0.5 * ((a - y) / (a - 2 * b + y));
   double peak_location = static_cast<double>(middle_point_index) + p;
@@ -18,41 +140,44 @@ std::tuple<double, double> QuadraticInterpolation(double a, double b, double y,
   return std::make_tuple(peak_location, peak_height_estimate);
 }
 
-std::vector<std::tuple<double, double>> PeakDetect(const std::vector<double> &inp,
-                                                   double threshold,
-                                                   bool interpolate,
-                                                   std::string sort_by,
-                                                   int max_num_peaks,
-                                                   double range,
-                                                   int min_pos,
-                                                   int max_pos) {
-  int _max_pos = max_pos;
-  const int inp_size = inp.size();
-  if (inp_size < 2) {
-    std::string err_msg = "Peak detection input vector must be greater than 2.";
-    throw std::runtime_error(err_msg);
-  }
-
-  if (min_pos != 0 && _max_pos != 0 && min_pos >= _max_pos) {
-    std::string err_msg = "Peak detection max position must be greater than min position.";
-    throw std::runtime_error(err_msg);
+std::vector<uint64_t> CandidatePeaks(Span<const double> inp, int begin, int end, double threshold) {
+  std::vector<uint64_t> candidates((static_cast<size_t>(std::max(end, 0)) + 63) / 64, 0);
+  if (NumCandidateWords(begin, end) > 0) {
+    FillCandidateWords(inp, begin, end, threshold, candidates.data() + FirstCandidateWord(begin));
   }
+  return candidates;
+}
 
+std::vector<std::tuple<double, double>> ScanPeaks(Span<const double> inp,
+                                                  int begin,
+                                                  int end,
+                                                  double threshold,
+                                                  bool interpolate,
+                                                  double scale,
+                                                  double max_pos,
+                                                  bool skip_to_candidates) {
   std::vector<std::tuple<double, double>> estimated_peaks;
+  int i = begin;
 
-  double scale = 1;
-  if (range > 0) {
-    scale = range / static_cast<double>(inp_size - 1);
-  }
-  // Start at minimum position
-  int i = 0;
-  if (min_pos > 0) {
-    // We are dividing by scale because the scale should have been accounted for when the user input the value
-    i = static_cast<int>(std::ceil(min_pos / scale));
-  }
-
-  if (_max_pos == 0) {
-    _max_pos = (inp_size - 1) * scale;
+  // Every peak the loop below can register in the range ends a rise, so it is a candidate. Between candidates the loop
+  // would only walk down and up without registering anything, so it jumps to just before the next one instead, where
+  // the up loop takes it onto the candidate exactly as walking would have. Without any candidate left it goes straight
+  // to the end of the range, which only checks the last element.
+  //
+  // The mask of a range of up to 64 * kStackCandidateWords elements stays on the stack, and its number of candidates
+  // sizes the output, so the scan allocates once.
+  uint64_t stack_candidates[kStackCandidateWords];
+  std::vector<uint64_t> heap_candidates;
+  uint64_t *candidates = stack_candidates;
+  const int first_candidate_word = FirstCandidateWord(begin);
+  const int num_candidate_words = NumCandidateWords(begin, end);
+  if (skip_to_candidates) {
+    if (num_candidate_words > kStackCandidateWords) {
+      heap_candidates.resize(static_cast<size_t>(num_candidate_words));
+      candidates = heap_candidates.data();
+    }
+    // Every peak inside the range is a candidate, only the two ends of the range can add one more each.
+    estimated_peaks.reserve(FillCandidateWords(inp, begin, end, threshold, candidates) + 2);
   }
 
   // Check if lower bound is a peak
@@ -62,11 +187,16 @@ std::vector<std::tuple<double, double>> PeakDetect(const std::vector<double> &in
   }
 
   while (true) {
+    if (skip_to_candidates && i < end - 2) {
+      const int candidate = NextCandidate(candidates, first_candidate_word, num_candidate_words, i + 1, end - 1);
+      i = candidate < end - 1 ? candidate - 1 : end - 2;
+    }
+
     //  Down:
     //    [0, 3, 4, 3, 2, 1, 1, 0]
     //           ^  ^  ^  ^  ^
     //
-    while (i + 1 < inp_size - 1 && inp[i] >= inp[i + 1]) {
+    while (i + 1 < end - 1 && inp[i] >= inp[i + 1]) {
       i++;
     }
 
@@ -74,7 +204,7 @@ std::vector<std::tuple<double, double>> PeakDetect(const std::vector<double> &in
     //    [0, 0, 1, 2, 3, 4, 3, 2]
     //           ^  ^  ^  ^
 
-    while (i + 1 < inp_size - 1 && inp[i] < inp[i + 1]) {
+    while (i + 1 < end - 1 && inp[i] < inp[i + 1]) {
       i++;
     }
     // Do not register a peak here because we need to check for a flat peak
@@ -83,13 +213,13 @@ std::vector<std::tuple<double, double>> PeakDetect(const std::vector<double> &in
     //    [0, 0, 1, 1, 1, 1, 0, 0]
     //           ^  ^  ^  ^
     int j = i;
-    while (j + 1 < inp_size - 1 && (inp[j] == inp[j + 1])) {
+    while (j + 1 < end - 1 && (inp[j] == inp[j + 1])) {
       j++;
     }
 
     // Check element right before the last element
-    if (i + 1 >= inp_size - 1) {
-      if (i == inp_size - 2 && inp[i - 1] < inp[i] && inp[i + 1] < inp[i] && inp[i] > threshold) {
+    if (i + 1 >= end - 1) {
+      if (i == end - 2 && inp[i - 1] < inp[i] && inp[i + 1] < inp[i] && inp[i] > threshold) {
         double pos;
         double val;
 
@@ -104,18 +234,18 @@ std::vector<std::tuple<double, double>> PeakDetect(const std::vector<double> &in
       }
 
       // We are dividing by scale because the scale should have been accounted for when the user input the value
-      double scale_removed_max_pos = _max_pos / scale;
+      double scale_removed_max_pos = max_pos / scale;
       // Check if element before last is a peak right before breaking the loop
-      if (scale_removed_max_pos > inp_size - 2 && scale_removed_max_pos <= inp_size - 1 &&
-          inp[inp_size - 1] > inp[inp_size - 2] && inp[inp_size - 1] > threshold) {
-        std::tuple<double, double> peak((inp_size - 1) * scale, inp[inp_size - 1]);
+      if (scale_removed_max_pos > end - 2 && scale_removed_max_pos <= end - 1 && inp[end - 1] > inp[end - 2] &&
+          inp[end - 1] > threshold) {
+        std::tuple<double, double> peak((end - 1) * scale, inp[end - 1]);
         estimated_peaks.push_back(peak);
       }
       break;
     }
 
     // Flat peak ends, check if we are going down
-    if ((j + 1 <= inp_size - 1) && inp[j] > inp[j + 1] && inp[j] > threshold) {
+    if ((j + 1 <= end - 1) && inp[j] > inp[j + 1] && inp[j] > threshold) {
       double pos;
       double val;
 
@@ -137,7 +267,7 @@ std::vector<std::tuple<double, double>> PeakDetect(const std::vector<double> &in
         }
       }
 
-      if (pos * scale > _max_pos) break;
+      if (pos * scale > max_pos) break;
 
       std::tuple<double, double> peak(pos * scale, val);
       estimated_peaks.push_back(peak);
@@ -147,16 +277,22 @@ std::vector<std::tuple<double, double>> PeakDetect(const std::vector<double> &in
     i = j;
   }
 
-  // Sorting
+  return estimated_peaks;
+}
+
+std::vector<std::tuple<double, double>> SortAndLimitPeaks(const std::vector<std::tuple<double, double>> &peaks,
+                                                          std::string sort_by,
+                                                          int max_num_peaks) {
   std::transform(sort_by.begin(), sort_by.end(), sort_by.begin(), [](unsigned char c) { return std::tolower(c); });
 
-  std::vector<std::tuple<double, double>> sorted_estimated_peaks = estimated_peaks;
+  std::vector<std::tuple<double, double>> sorted_estimated_peaks = peaks;
   if (sort_by == "position") {
     // Already sorted by position (Frequency)
   } else if (sort_by == "height") {
     // height (Magnitude)
-    std::sort(sorted_estimated_peaks.begin(), sorted_estimated_peaks.end(),
-              [](auto const &t1, auto const &t2) { return std::get<1>(t1) > std::get<1>(t2); });
+    // Stable so that peaks of equal height keep their order of position.
+    std::stable_sort(sorted_estimated_peaks.begin(), sorted_estimated_peaks.end(),
+                     [](auto const &t1, auto const &t2) { return std::get<1>(t1) > std::get<1>(t2); });
   } else {
     std::string err_msg = "Sorting by '" + sort_by + "' is not supported.";
     throw std::runtime_error(err_msg);
@@ -165,15 +301,53 @@ std::vector<std::tuple<double, double>> PeakDetect(const std::vector<double> &in
   // Shrink to max number of peaks
   size_t num_peaks = max_num_peaks;
   if (num_peaks != 0 && num_peaks < sorted_estimated_peaks.size()) {
-    std::vector<std::tuple<double, double>> limited_num_of_sorted_estimated_peaks = sorted_estimated_peaks;
-    limited_num_of_sorted_estimated_peaks.resize(num_peaks);
-    limited_num_of_sorted_estimated_peaks.shrink_to_fit();
-
-    return limited_num_of_sorted_estimated_peaks;
+    sorted_estimated_peaks.resize(num_peaks);
+    sorted_estimated_peaks.shrink_to_fit();
   }
 
   return sorted_estimated_peaks;
 }
 
+std::vector<std::tuple<double, double>> PeakDetect(Span<const double> inp,
+                                                   double threshold,
+                                                   bool interpolate,
+                                                   std::string sort_by,
+                                                   int max_num_peaks,
+                                                   double range,
+                                                   int min_pos,
+                                                   int max_pos) {
+  int _max_pos = max_pos;
+  const int inp_size = inp.size();
+  if (inp_size < 2) {
+    std::string err_msg = "Peak detection input vector must be greater than 2.";
+    throw std::runtime_error(err_msg);
+  }
+
+  if (min_pos != 0 && _max_pos != 0 && min_pos >= _max_pos) {
+    std::string err_msg = "Peak detection max position must be greater than min position.";
+    throw std::runtime_error(err_msg);
+  }
+
+  double scale = 1;
+  if (range > 0) {
+    scale = range / static_cast<double>(inp_size - 1);
+  }
+  // Start at minimum position
+  int i = 0;
+  if (min_pos > 0) {
+    // We are dividing by scale because the scale should have been accounted for when the user input the value
+    i = static_cast<int>(std::ceil(min_pos / scale));
+  }
+
+  if (_max_pos == 0) {
+    _max_pos = (inp_size - 1) * scale;
+  }
+
+  std::vector<std::tuple<double, double>> estimated_peaks =
+      ScanPeaks(inp, i, inp_size, threshold, interpolate, scale, _max_pos);
+
+  return SortAndLimitPeaks(estimated_peaks, sort_by, max_num_peaks);
+}
+
 }  // namespace core
 }  // namespace musher
\ No newline at end of file
@@ -1,9 +1,12 @@
 #pragma once
 
+#include <cstdint>
 #include <tuple>
 #include <vector>
 #include <string>
 
+#include "src/core/span.h"
+
 namespace musher {
 namespace core {
 
@@ -38,6 +41,60 @@ namespace core {
  */
 std::tuple<double, double> QuadraticInterpolation(double a, double b, double y, int middle_point_index);
 
+/**
+ * @brief Elements of a sub range of a vector that may be peaks, as a bitmask computed with SIMD where available.
+ *
+ * Bit i % 64 of word i / 64 is set for every element between `begin` + 1 and `end` - 2 that is above its left
+ * neighbour, not below its right neighbour and above the threshold. Every peak ScanPeaks finds inside the range starts
+ * on such an element.
+ *
+ * @param inp Input vector.
+ * @param begin Index of the first element of the range.
+ * @param end Index one past the last element of the range.
+ * @param threshold Elements below this threshold are not candidates.
+ * @return std::vector<uint64_t> Candidate bitmask, covering indices 0 to `end`.
+ */
+std::vector<uint64_t> CandidatePeaks(Span<const double> inp, int begin, int end, double threshold);
+
+/**
+ * @brief Scans a sub range of a vector for local maxima (peaks), in ascending order of position.
+ *
+ * This is the search loop used by PeakDetect. Peaks found between `begin` and `end` are identical to the ones a scan
+ * of the whole vector would find there, as long as the element at `begin` is not part of a peak. Positions are
+ * absolute (element index times `scale`).
+ *
+ * @param inp Input vector.
+ * @param begin Index of the first element to scan.
+ * @param end Index one past the last element to scan (must be at least `begin` + 2).
+ * @param threshold Peaks below this given threshold are not outputted.
+ * @param interpolate Enables interpolation.
+ * @param scale Scale applied to element indices to get positions.
+ * @param max_pos Maximum position of the range to evaluate (in scaled units).
+ * @param skip_to_candidates Skip the stretches without any CandidatePeaks instead of walking every element. Both give
+ * the same peaks.
+ * @return std::vector<std::tuple<double, double>> Vector of peaks, each peak being a tuple (positions, heights).
+ */
+std::vector<std::tuple<double, double>> ScanPeaks(Span<const double> inp,
+                                                  int begin,
+                                                  int end,
+                                                  double threshold,
+                                                  bool interpolate,
+                                                  double scale,
+                                                  double max_pos,
+                                                  bool skip_to_candidates = true);
+
+/**
+ * @brief Sort peaks and shrink them to a maximum number of peaks.
+ *
+ * @param peaks Peaks in ascending order of position.
+ * @param sort_by Ordering type of the outputted peaks (ascending by position or descending by height).
+ * @param max_num_peaks Maximum number of returned peaks (set to 0 to return all peaks).
+ * @return std::vector<std::tuple<double, double>> Sorted and limited peaks.
+ */
+std::vector<std::tuple<double, double>> SortAndLimitPeaks(const std::vector<std::tuple<double, double>> &peaks,
+                                                          std::string sort_by,
+                                                          int max_num_peaks);
+
 /**
  * @brief Detects local maxima (peaks) in a vector.
  * 
@@ -56,7 +113,7 @@ std::tuple<double, double> QuadraticInterpolation(double a, double b, double y,
  * @return std::vector<std::tuple<double, double>> Vector of peaks,
  * each peak being a tuple (positions, heights).
  */
-std::vector<std::tuple<double, double>> PeakDetect(const std::vector<double> &inp,
+std::vector<std::tuple<double, double>> PeakDetect(Span<const double> inp,
                                                    double threshold = -1000.0,
                                                    bool interpolate = true,
                                                    std::string sort_by = "position",
@@ -0,0 +1,123 @@
+#include "src/core/resample.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace musher {
+namespace core {
+
+namespace {
+
+/**
+ * @brief Zeroth order modified Bessel function of the first kind, evaluated with its power series.
+ */
+double BesselI0(double x) {
+  double sum = 1.0;
+  double term = 1.0;
+  const double half_x = x / 2.0;
+  for (int k = 1; k < 64; k++) {
+    term *= (half_x / k) * (half_x / k);
+    sum += term;
+    if (term < sum * 1e-17) break;
+  }
+  return sum;
+}
+
+uint64_t GreatestCommonDivisor(uint64_t a, uint64_t b) {
+  while (b != 0) {
+    uint64_t t = a % b;
+    a = b;
+    b = t;
+  }
+  return a;
+}
+
+}  // namespace
+
+std::vector<double> KaiserLowpassFilter(unsigned int num_taps, double cutoff, double gain, double kaiser_beta) {
+  if (num_taps == 0) throw std::runtime_error("KaiserLowpassFilter: num_taps must be greater than 0.");
+  if (cutoff <= 0. || cutoff > 1.) throw std::runtime_error("KaiserLowpassFilter: cutoff must be in (0, 1].");
+
+  std::vector<double> taps(num_taps);
+  const double center = (num_taps - 1) / 2.0;
+  const double i0_beta = BesselI0(kaiser_beta);
+  for (unsigned int n = 0; n < num_taps; n++) {
+    const double t = n - center;
+    const double sinc = t == 0. ? 1.0 : std::sin(M_PI * cutoff * t) / (M_PI * cutoff * t);
+    const double r = center == 0. ? 0. : t / center;
+    const double window = BesselI0(kaiser_beta * std::sqrt(std::max(0., 1. - r * r))) / i0_beta;
+    taps[n] = gain * cutoff * sinc * window;
+  }
+  return taps;
+}
+
+std::vector<double> Resample(Span<const double> input,
+                             unsigned int up,
+                             unsigned int down,
+                             unsigned int half_taps_per_phase,
+                             double kaiser_beta) {
+  if (up == 0 || down == 0) throw std::runtime_error("Resample: up and down factors must be greater than 0.");
+  if (half_taps_per_phase == 0) throw std::runtime_error("Resample: half_taps_per_phase must be greater than 0.");
+
+  const uint64_t divisor = GreatestCommonDivisor(up, down);
+  up /= divisor;
+  down /= divisor;
+  if (up == 1 && down == 1) return std::vector<double>(input.begin(), input.end());
+  if (input.empty()) return std::vector<double>();
+
+  const unsigned int max_factor = std::max(up, down);
+  const unsigned int num_taps = 2 * half_taps_per_phase * max_factor + 1;
+  const std::vector<double> filter =
+      KaiserLowpassFilter(num_taps, 1.0 / max_factor, static_cast<double>(up), kaiser_beta);
+
+  // Split the filter into its polyphase branches so every output sample walks a contiguous set of taps.
+  // Branch p holds filter[p], filter[p + up], filter[p + 2 * up], ...
+  std::vector<std::vector<double>> phases(up);
+  for (unsigned int i = 0; i < num_taps; i++) {
+    phases[i % up].push_back(filter[i]);
+  }
+
+  const int64_t input_size = static_cast<int64_t>(input.size());
+  const int64_t delay = (num_taps - 1) / 2;
+  const size_t output_size = static_cast<size_t>((input_size * up + down - 1) / down);
+  std::vector<double> output(output_size);
+
+  for (size_t m = 0; m < output_size; m++) {
+    // Position of this output sample on the upsampled time axis, shifted by the filter delay.
+    const int64_t t = static_cast<int64_t>(m) * down + delay;
+    const std::vector<double> &phase = phases[t % up];
+    const int64_t newest = t / up;  // Input sample aligned with phase[0].
+
+    // phase[k] multiplies input[newest - k]; clip k to the taps that land inside the signal.
+    int64_t k_begin = newest >= input_size ? newest - input_size + 1 : 0;
+    int64_t k_end = std::min(static_cast<int64_t>(phase.size()), newest + 1);
+
+    double acc = 0.;
+    for (int64_t k = k_begin; k < k_end; k++) {
+      acc += phase[k] * input[newest - k];
+    }
+    output[m] = acc;
+  }
+  return output;
+}
+
+std::vector<double> ResampleToRate(Span<const double> input,
+                                   double input_sample_rate,
+                                   double output_sample_rate,
+                                   unsigned int half_taps_per_phase,
+                                   double kaiser_beta) {
+  const int64_t input_rate = std::llround(input_sample_rate);
+  const int64_t output_rate = std::llround(output_sample_rate);
+  if (input_rate <= 0 || output_rate <= 0) throw std::runtime_error("ResampleToRate: sample rates must be positive.");
+
+  const int64_t divisor = static_cast<int64_t>(GreatestCommonDivisor(input_rate, output_rate));
+  const unsigned int up = static_cast<unsigned int>(output_rate / divisor);
+  const unsigned int down = static_cast<unsigned int>(input_rate / divisor);
+  return Resample(input, up, down, half_taps_per_phase, kaiser_beta);
+}
+
+}  // namespace core
+}  // namespace musher
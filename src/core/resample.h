@@ -0,0 +1,65 @@
+#pragma once
+
+#include <vector>
+
+#include "src/core/span.h"
+
+namespace musher {
+namespace core {
+
+/**
+ * @brief Design a Kaiser windowed sinc lowpass filter.
+ *
+ * @param num_taps Number of filter taps (should be odd so the filter has an integer delay).
+ * @param cutoff Cutoff frequency, normalized so that 1.0 is the Nyquist frequency.
+ * @param gain Passband gain of the filter.
+ * @param kaiser_beta Shape parameter of the Kaiser window, larger values trade a wider transition band for more
+ * stopband attenuation.
+ * @return std::vector<double> Filter taps.
+ */
+std::vector<double> KaiserLowpassFilter(unsigned int num_taps,
+                                        double cutoff,
+                                        double gain = 1.,
+                                        double kaiser_beta = 8.);
+
+/**
+ * @brief Resample a signal by the rational factor up / down using a polyphase anti-aliasing filter.
+ *
+ * The signal is conceptually upsampled by `up`, lowpass filtered below the lower of the two Nyquist frequencies and
+ * downsampled by `down`. Only the filter taps that hit non-zero input samples are evaluated, so the cost per output
+ * sample is independent of the ratio. The filter delay is compensated, so output sample m lines up with input time
+ * m * down / up.
+ *
+ * @param input Input signal.
+ * @param up Upsampling factor.
+ * @param down Downsampling factor.
+ * @param half_taps_per_phase Number of filter taps on each side of the center, per polyphase branch.
+ * @param kaiser_beta Shape parameter of the Kaiser window used to design the filter.
+ * @return std::vector<double> Resampled signal of length ceil(input.size() * up / down).
+ */
+std::vector<double> Resample(Span<const double> input,
+                             unsigned int up,
+                             unsigned int down,
+                             unsigned int half_taps_per_phase = 32,
+                             double kaiser_beta = 8.);
+
+/**
+ * @brief Resample a signal from one sample rate to another.
+ *
+ * Both rates are rounded to whole Hz and the ratio is reduced before calling Resample.
+ *
+ * @param input Input signal.
+ * @param input_sample_rate Sampling rate of the input signal \[Hz\].
+ * @param output_sample_rate Desired sampling rate of the output signal \[Hz\].
+ * @param half_taps_per_phase Number of filter taps on each side of the center, per polyphase branch.
+ * @param kaiser_beta Shape parameter of the Kaiser window used to design the filter.
+ * @return std::vector<double> Resampled signal.
+ */
+std::vector<double> ResampleToRate(Span<const double> input,
+                                   double input_sample_rate,
+                                   double output_sample_rate,
+                                   unsigned int half_taps_per_phase = 32,
+                                   double kaiser_beta = 8.);
+
+}  // namespace core
+}  // namespace musher
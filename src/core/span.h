@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+namespace musher {
+namespace core {
+
+/**
+ * @brief Non-owning view of a contiguous sequence of elements.
+ *
+ * A Span<const T> is implicitly built from a std::vector<T>, so functions taking one accept vectors exactly as before,
+ * while memory owned elsewhere (such as a numpy array) can be passed without copying it into a vector first.
+ *
+ * The viewed memory must outlive the span, so spans should only be stored by objects that document it.
+ *
+ * @tparam T Element type, const qualified for a read-only view.
+ */
+template <typename T>
+class Span {
+ private:
+  T *data_;
+  size_t size_;
+
+ public:
+  using value_type = typename std::remove_cv<T>::type;
+  using iterator = T *;
+
+  Span() : data_(nullptr), size_(0) {}
+
+  /**
+   * @brief Construct a new Span object
+   *
+   * @param data Pointer to the first element.
+   * @param size Number of elements.
+   */
+  Span(T *data, size_t size) : data_(data), size_(size) {}
+
+  Span(std::vector<value_type> &vec) : data_(vec.data()), size_(vec.size()) {}
+
+  template <typename U = T, typename = typename std::enable_if<std::is_const<U>::value>::type>
+  Span(const std::vector<value_type> &vec) : data_(vec.data()), size_(vec.size()) {}
+
+  template <typename U, typename = typename std::enable_if<std::is_same<const U, T>::value>::type>
+  Span(const Span<U> &other) : data_(other.data()), size_(other.size()) {}
+
+  T *data() const { return data_; }
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  iterator begin() const { return data_; }
+  iterator end() const { return data_ + size_; }
+
+  T &operator[](size_t index) const { return data_[index]; }
+  T &front() const { return data_[0]; }
+  T &back() const { return data_[size_ - 1]; }
+
+  /**
+   * @brief View of count elements starting at offset.
+   */
+  Span subspan(size_t offset, size_t count) const { return Span(data_ + offset, count); }
+};
+
+}  // namespace core
+}  // namespace musher
@@ -1,4 +1,11 @@
+#include "src/core/spectral_peaks.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <stdexcept>
 #include <string>
+#include <tuple>
 #include <vector>
 
 #include "src/core/peak_detect.h"
@@ -6,7 +13,7 @@
 namespace musher {
 namespace core {
 
-std::vector<std::tuple<double, double>> SpectralPeaks(const std::vector<double> &input_spectrum,
+std::vector<std::tuple<double, double>> SpectralPeaks(Span<const double> input_spectrum,
                                                       double threshold,
                                                       std::string sort_by,
                                                       unsigned int max_num_peaks,
@@ -16,5 +23,55 @@ std::vector<std::tuple<double, double>> SpectralPeaks(const std::vector<double>
   return PeakDetect(input_spectrum, threshold, true, sort_by, max_num_peaks, sample_rate / 2.0, min_pos, max_pos);
 }
 
+std::tuple<int, int> SpectralPeaksBinRange(size_t spectrum_size,
+                                           double sample_rate,
+                                           double min_frequency,
+                                           double max_frequency) {
+  int last_bin = static_cast<int>(spectrum_size) - 1;
+  double scale = (sample_rate / 2.0) / static_cast<double>(last_bin);
+
+  // One bin below the range so the scan never starts on a peak, and two above so the last peak can be interpolated.
+  int min_bin = std::max(0, static_cast<int>(std::floor(min_frequency / scale)) - 1);
+  int max_bin = std::min(last_bin, static_cast<int>(std::ceil(max_frequency / scale)) + 2);
+  return std::make_tuple(min_bin, max_bin);
+}
+
+std::vector<std::tuple<double, double>> SpectralPeaksInRange(Span<const double> input_spectrum,
+                                                             double threshold,
+                                                             std::string sort_by,
+                                                             unsigned int max_num_peaks,
+                                                             double sample_rate,
+                                                             double min_frequency,
+                                                             double max_frequency) {
+  const int spectrum_size = input_spectrum.size();
+  if (spectrum_size < 2) {
+    throw std::runtime_error("Peak detection input vector must be greater than 2.");
+  }
+  if (min_frequency >= max_frequency) {
+    throw std::runtime_error("Spectral peaks max frequency must be greater than min frequency.");
+  }
+
+  double scale = (sample_rate / 2.0) / static_cast<double>(spectrum_size - 1);
+  int min_bin;
+  int max_bin;
+  std::tie(min_bin, max_bin) = SpectralPeaksBinRange(spectrum_size, sample_rate, min_frequency, max_frequency);
+
+  // Flat peaks crossing the edges must be scanned in full to get the same position as a full scan.
+  while (min_bin > 0 && input_spectrum[min_bin] == input_spectrum[min_bin + 1]) min_bin--;
+  while (max_bin < spectrum_size - 1 && input_spectrum[max_bin] == input_spectrum[max_bin - 1]) max_bin++;
+  if (max_bin <= min_bin) return std::vector<std::tuple<double, double>>();
+
+  std::vector<std::tuple<double, double>> peaks =
+      ScanPeaks(input_spectrum, min_bin, max_bin + 1, threshold, true, scale, max_frequency);
+
+  std::vector<std::tuple<double, double>> peaks_in_range;
+  std::copy_if(peaks.begin(), peaks.end(), std::back_inserter(peaks_in_range),
+               [&min_frequency, &max_frequency](auto const &peak) {
+                 return std::get<0>(peak) >= min_frequency && std::get<0>(peak) <= max_frequency;
+               });
+
+  return SortAndLimitPeaks(peaks_in_range, sort_by, max_num_peaks);
+}
+
 }  // namespace core
 }  // namespace musher
\ No newline at end of file
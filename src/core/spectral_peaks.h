@@ -1,7 +1,10 @@
 #pragma once
 
-#include <vector>
 #include <string>
+#include <tuple>
+#include <vector>
+
+#include "src/core/span.h"
 
 namespace musher {
 namespace core {
@@ -30,7 +33,7 @@ namespace core {
  * @return std::vector<std::tuple<double, double>> Vector of spectral peaks, each peak being a tuple (frequency,
  * magnitude).
  */
-std::vector<std::tuple<double, double>> SpectralPeaks(const std::vector<double> &input_spectrum,
+std::vector<std::tuple<double, double>> SpectralPeaks(Span<const double> input_spectrum,
                                                       double threshold = -1000.0,
                                                       std::string sort_by = "position",
                                                       unsigned int max_num_peaks = 100,
@@ -38,5 +41,48 @@ std::vector<std::tuple<double, double>> SpectralPeaks(const std::vector<double>
                                                       int min_pos = 0,
                                                       int max_pos = 0);
 
+/**
+ * @brief Range of spectrum bins that SpectralPeaksInRange reads to find the peaks between two frequencies.
+ *
+ * Includes the guard bins on each side that are needed to detect and interpolate peaks right at the edges.
+ *
+ * @param spectrum_size Size of the spectrum.
+ * @param sample_rate Sampling rate of the audio signal \[Hz\].
+ * @param min_frequency Minimum frequency of the peaks \[Hz\].
+ * @param max_frequency Maximum frequency of the peaks \[Hz\].
+ * @return std::tuple<int, int> Tuple of (first bin, last bin).
+ */
+std::tuple<int, int> SpectralPeaksBinRange(size_t spectrum_size,
+                                           double sample_rate,
+                                           double min_frequency,
+                                           double max_frequency);
+
+/**
+ * @brief Extracts the peaks of a spectrum that lie between two frequencies.
+ *
+ * Only the bins returned by SpectralPeaksBinRange are read, so the spectrum can be computed for that range alone.
+ * Before sorting and limiting, the peaks are identical to the peaks of SpectralPeaks over the whole spectrum whose
+ * frequency is within \[min_frequency, max_frequency\]. Note that `max_num_peaks` is applied after the frequency
+ * range, so only peaks within the range count towards it.
+ *
+ * @param input_spectrum Input spectrum.
+ * @param threshold Peaks below this given threshold are not outputted.
+ * @param sort_by Ordering type of the outputted peaks (ascending by frequency (position)
+ * or descending by magnitude (height)).
+ * @param max_num_peaks Maximum number of returned peaks (set to 0 to return all peaks).
+ * @param sample_rate Sampling rate of the audio signal \[Hz\].
+ * @param min_frequency Minimum frequency of the peaks \[Hz\].
+ * @param max_frequency Maximum frequency of the peaks \[Hz\].
+ * @return std::vector<std::tuple<double, double>> Vector of spectral peaks, each peak being a tuple (frequency,
+ * magnitude).
+ */
+std::vector<std::tuple<double, double>> SpectralPeaksInRange(Span<const double> input_spectrum,
+                                                             double threshold,
+                                                             std::string sort_by,
+                                                             unsigned int max_num_peaks,
+                                                             double sample_rate,
+                                                             double min_frequency,
+                                                             double max_frequency);
+
 }  // namespace core
 }  // namespace musher
\ No newline at end of file
@@ -7,6 +7,8 @@
 #include <stdexcept>
 #include <vector>
 
+#include "src/core/threading.h"
+
 namespace musher {
 namespace core {
 
@@ -49,11 +51,19 @@ size_t NextFastLen(size_t n) {
   return best_fac;
 }
 
-std::vector<double> ConvertToFrequencySpectrum(const std::vector<double> &audio_frame) {
-  std::vector<double> v1(audio_frame);
-  std::vector<double> ret;
+size_t FrequencySpectrumSize(size_t frame_size) {
+  if (frame_size == 0) return 0;
+  return (NextFastLen(frame_size - 1) >> 1) + 1;
+}
 
-  if (v1.empty()) return ret;
+/**
+ * @brief Real to complex FFT of a frame, padded to an efficient length.
+ *
+ * @param audio_frame Input audio frame.
+ * @return std::vector<std::complex<double>> Non-negative frequency terms of the FFT.
+ */
+static std::vector<std::complex<double>> RealFFT(Span<const double> audio_frame) {
+  std::vector<double> v1(audio_frame.begin(), audio_frame.end());
 
   size_t s1 = v1.size();
   size_t shape = s1 - 1;
@@ -66,6 +76,8 @@ std::vector<double> ConvertToFrequencySpectrum(const std::vector<double> &audio_
   // FFT common variables
   bool forward = true;
   int inorm = 0;
+  // pocketfft only splits independent transforms between threads, a single frame always runs on one.
+  // ConvertToFrequencySpectra is the parallel entry point.
   int nthreads = 1;
   pocketfft::shape_t axes{ 1 };  // 1 axis on 1D array
 
@@ -85,6 +97,25 @@ std::vector<double> ConvertToFrequencySpectrum(const std::vector<double> &audio_
   double v1_fct = NormFct(inorm, v1_dims_in, axes);
   pocketfft::r2c(v1_dims_in, s1_in, s1_out, axes, forward, d1_in, d1_out, v1_fct, nthreads);
 
+  return v1_out;
+}
+
+/**
+ * @brief Magnitude of a bin of a real FFT held in pocketfft's packed layout (r0, r1, i1, r2, i2, ...).
+ */
+static double PackedMagnitude(const std::vector<double> &buffer, size_t bin) {
+  if (bin == 0) return Magnitude(std::complex<double>(buffer[0], 0.));
+  const double imag = 2 * bin < buffer.size() ? buffer[2 * bin] : 0.;
+  return Magnitude(std::complex<double>(buffer[2 * bin - 1], imag));
+}
+
+std::vector<double> ConvertToFrequencySpectrum(Span<const double> audio_frame) {
+  std::vector<double> ret;
+
+  if (audio_frame.empty()) return ret;
+
+  std::vector<std::complex<double>> v1_out = RealFFT(audio_frame);
+
   // Get element-wise absolute value of a complex vector
   ret.resize(v1_out.size());
   auto calculate_magnitude = [](const std::complex<double> x) { return Magnitude(x); };
@@ -93,5 +124,98 @@ std::vector<double> ConvertToFrequencySpectrum(const std::vector<double> &audio_
   return ret;
 }
 
+std::vector<double> ConvertToFrequencySpectrum(Span<const double> audio_frame,
+                                               size_t min_bin,
+                                               size_t max_bin) {
+  std::vector<double> ret;
+
+  if (audio_frame.empty()) return ret;
+
+  // Same padding (or truncation) as RealFFT, but transformed in place in pocketfft's packed layout so there is no
+  // complex output to allocate, and only the requested bins are turned into magnitudes.
+  const size_t good_size = NextFastLen(audio_frame.size() - 1);
+  const size_t copy_size = std::min(audio_frame.size(), good_size);
+  std::vector<double> buffer(good_size, 0.);
+  std::copy(audio_frame.begin(), audio_frame.begin() + copy_size, buffer.begin());
+  auto plan = pocketfft::detail::get_plan<pocketfft::detail::pocketfft_r<double>>(good_size);
+  plan->forward(buffer.data(), 1.);
+
+  // The rest of the bins stay at 0.
+  ret.resize((good_size >> 1) + 1, 0.0);
+  if (min_bin >= ret.size()) return ret;
+  const size_t last_bin = std::min(max_bin, ret.size() - 1);
+  for (size_t bin = min_bin; bin <= last_bin; bin++) ret[bin] = PackedMagnitude(buffer, bin);
+
+  return ret;
+}
+
+std::vector<std::vector<double>> ConvertToFrequencySpectra(const std::vector<std::vector<double>> &audio_frames,
+                                                           unsigned int num_threads) {
+  return ConvertToFrequencySpectra(std::vector<Span<const double>>(audio_frames.begin(), audio_frames.end()),
+                                   num_threads);
+}
+
+/**
+ * @brief Magnitude spectrum of every frame, written to the buffer spectrum_of(frame) points to.
+ *
+ * @tparam SpectrumOf Callable taking a frame index and returning a double* with room for spectrum_size values. It is
+ * called from the worker threads, once per frame.
+ * @param audio_frames Views of the input audio frames, all of the same size.
+ * @param num_threads Number of threads (set to 0 to use GetNumThreads).
+ * @param spectrum_of Output buffer of a frame.
+ */
+template <typename SpectrumOf>
+static void FillFrequencySpectra(const std::vector<Span<const double>> &audio_frames,
+                                 unsigned int num_threads,
+                                 const SpectrumOf &spectrum_of) {
+  if (audio_frames.empty() || audio_frames[0].empty()) return;
+
+  const size_t frame_size = audio_frames[0].size();
+  for (const Span<const double> &audio_frame : audio_frames) {
+    if (audio_frame.size() != frame_size) {
+      throw std::runtime_error("ConvertToFrequencySpectra: all frames must have the same size.");
+    }
+  }
+  // Same padding (or truncation) as RealFFT.
+  const size_t good_size = NextFastLen(frame_size - 1);
+  const size_t copy_size = std::min(frame_size, good_size);
+  const size_t spectrum_size = (good_size >> 1) + 1;
+
+  ParallelFor(audio_frames.size(), num_threads, [&](size_t begin, size_t end) {
+    // Every thread reuses one plan and one buffer, transforming in place in pocketfft's packed layout
+    // (r0, r1, i1, r2, i2, ...).
+    auto plan = pocketfft::detail::get_plan<pocketfft::detail::pocketfft_r<double>>(good_size);
+    std::vector<double> buffer(good_size);
+    for (size_t frame = begin; frame < end; frame++) {
+      const Span<const double> &audio_frame = audio_frames[frame];
+      std::copy(audio_frame.begin(), audio_frame.begin() + copy_size, buffer.begin());
+      std::fill(buffer.begin() + copy_size, buffer.end(), 0.);
+      plan->forward(buffer.data(), 1.);
+
+      double *spectrum = spectrum_of(frame);
+      for (size_t bin = 0; bin < spectrum_size; bin++) spectrum[bin] = PackedMagnitude(buffer, bin);
+    }
+  });
+}
+
+std::vector<std::vector<double>> ConvertToFrequencySpectra(const std::vector<Span<const double>> &audio_frames,
+                                                           unsigned int num_threads) {
+  std::vector<std::vector<double>> spectra(audio_frames.size());
+  const size_t spectrum_size = audio_frames.empty() ? 0 : FrequencySpectrumSize(audio_frames[0].size());
+  FillFrequencySpectra(audio_frames, num_threads, [&](size_t frame) {
+    spectra[frame].resize(spectrum_size);
+    return spectra[frame].data();
+  });
+  return spectra;
+}
+
+std::vector<double> ConvertToFrequencySpectraPlanar(const std::vector<Span<const double>> &audio_frames,
+                                                    unsigned int num_threads) {
+  const size_t spectrum_size = audio_frames.empty() ? 0 : FrequencySpectrumSize(audio_frames[0].size());
+  std::vector<double> spectra(audio_frames.size() * spectrum_size);
+  FillFrequencySpectra(audio_frames, num_threads, [&](size_t frame) { return spectra.data() + frame * spectrum_size; });
+  return spectra;
+}
+
 }  // namespace core
 }  // namespace musher
\ No newline at end of file
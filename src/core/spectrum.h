@@ -3,6 +3,8 @@
 #include <vector>
 #include <pocketfft/pocketfft.h>
 
+#include "src/core/span.h"
+
 namespace musher {
 namespace core {
 
@@ -33,6 +35,14 @@ double NormFct(int inorm,
  */
 size_t NextFastLen(size_t n);
 
+/**
+ * @brief Size of the frequency spectrum ConvertToFrequencySpectrum returns for a frame.
+ *
+ * @param frame_size Size of the input audio frame.
+ * @return size_t Number of frequency bins.
+ */
+size_t FrequencySpectrumSize(size_t frame_size);
+
 /**
  * @brief Computes the frequency spectrum of an array of Reals.
  * 
@@ -42,7 +52,57 @@ size_t NextFastLen(size_t n);
  * @param frame Input audio frame.
  * @return std::vector<double> Frequency spectrum of the input audio signal.
  */
-std::vector<double> ConvertToFrequencySpectrum(const std::vector<double> &audio_frame);
+std::vector<double> ConvertToFrequencySpectrum(Span<const double> audio_frame);
+
+/**
+ * @brief Computes the frequency spectrum of an array of Reals, limited to a range of bins.
+ *
+ * The output has the same size as the full spectrum, but magnitudes are only computed for the bins between `min_bin`
+ * and `max_bin` (inclusive). All other bins are 0.
+ *
+ * @param audio_frame Input audio frame.
+ * @param min_bin First bin to compute.
+ * @param max_bin Last bin to compute.
+ * @return std::vector<double> Band limited frequency spectrum of the input audio signal.
+ */
+std::vector<double> ConvertToFrequencySpectrum(Span<const double> audio_frame,
+                                               size_t min_bin,
+                                               size_t max_bin);
+
+/**
+ * @brief Computes the frequency spectra of many frames of the same size.
+ *
+ * The frames are split into one contiguous range per thread. Each thread plans once and transforms its frames in
+ * place in a single reused buffer, so there are no per frame plan lookups or intermediate copies. Each spectrum is
+ * the same as ConvertToFrequencySpectrum of its frame.
+ *
+ * @param audio_frames Input audio frames, all of the same size.
+ * @param num_threads Number of threads (set to 0 to use the library default, see SetNumThreads).
+ * @return std::vector<std::vector<double>> Frequency spectrum of every frame.
+ */
+std::vector<std::vector<double>> ConvertToFrequencySpectra(const std::vector<std::vector<double>> &audio_frames,
+                                                           unsigned int num_threads = 0);
+
+/**
+ * @brief Overloaded ConvertToFrequencySpectra that reads the frames through views, so frames held in memory owned
+ * elsewhere (such as a numpy array) are not copied. All other parameters are the same as above.
+ *
+ * @param audio_frames Views of the input audio frames, all of the same size.
+ * @return std::vector<std::vector<double>> Frequency spectrum of every frame.
+ */
+std::vector<std::vector<double>> ConvertToFrequencySpectra(const std::vector<Span<const double>> &audio_frames,
+                                                           unsigned int num_threads = 0);
+
+/**
+ * @brief Overloaded ConvertToFrequencySpectra that writes every spectrum into one contiguous buffer, frame after
+ * frame, so the result can be handed over as a single (frames x bins) array. All other parameters are the same as
+ * above.
+ *
+ * @param audio_frames Views of the input audio frames, all of the same size.
+ * @return std::vector<double> audio_frames.size() * FrequencySpectrumSize(frame size) magnitudes, row after row.
+ */
+std::vector<double> ConvertToFrequencySpectraPlanar(const std::vector<Span<const double>> &audio_frames,
+                                                    unsigned int num_threads = 0);
 
 }  // namespace core
 }  // namespace musher
\ No newline at end of file
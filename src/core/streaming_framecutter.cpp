@@ -0,0 +1,56 @@
+#include "src/core/streaming_framecutter.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+namespace musher {
+namespace core {
+
+StreamingFramecutter::StreamingFramecutter(int frame_size, int hop_size, bool start_from_center)
+    : frame_size_(static_cast<size_t>(std::max(frame_size, 0))),
+      hop_size_(static_cast<size_t>(std::max(hop_size, 0))),
+      start_from_center_(start_from_center) {
+  if (frame_size <= 0) throw std::runtime_error("StreamingFramecutter: frame_size must be positive.");
+  if (hop_size <= 0) throw std::runtime_error("StreamingFramecutter: hop_size must be positive.");
+  ring_.resize(2 * frame_size_);
+  reset();
+}
+
+void StreamingFramecutter::write(const double *samples, size_t num_samples) noexcept {
+  while (num_samples > 0) {
+    const size_t chunk_size = std::min(num_samples, frame_size_ - write_position_);
+    // Write both copies, so the frame_size samples before any position are contiguous after it.
+    std::memcpy(ring_.data() + write_position_, samples, chunk_size * sizeof(double));
+    std::memcpy(ring_.data() + write_position_ + frame_size_, samples, chunk_size * sizeof(double));
+    write_position_ = (write_position_ + chunk_size) % frame_size_;
+    samples += chunk_size;
+    num_samples -= chunk_size;
+  }
+}
+
+void StreamingFramecutter::write_zeros(size_t num_samples) noexcept {
+  // Only the last frame_size samples are ever read.
+  const size_t num_written = std::min(num_samples, frame_size_);
+  write_position_ = (write_position_ + num_samples - num_written) % frame_size_;
+  for (size_t i = 0; i < num_written; i++) {
+    ring_[write_position_] = 0.;
+    ring_[write_position_ + frame_size_] = 0.;
+    write_position_ = (write_position_ + 1) % frame_size_;
+  }
+}
+
+void StreamingFramecutter::reset() noexcept {
+  std::fill(ring_.begin(), ring_.end(), 0.);
+  // A centered first frame begins (frame_size + 1) / 2 samples before the stream, those samples are the zeros above.
+  const size_t padding = start_from_center_ ? (frame_size_ + 1) / 2 : 0;
+  write_position_ = padding % frame_size_;
+  until_next_frame_ = frame_size_ - padding;
+  next_frame_start_ = -static_cast<int64_t>(padding);
+  num_samples_ = 0;
+  last_frame_end_ = -1;
+}
+
+}  // namespace core
+}  // namespace musher
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "src/core/span.h"
+
+namespace musher {
+namespace core {
+
+/**
+ * @brief Cuts frames out of audio that arrives in blocks, such as the callbacks of a live input.
+ *
+ * Samples go into a ring buffer holding a single frame, every frame is handed out as soon as its last sample is pushed.
+ * The ring buffer is mirrored (every sample is stored twice, frame_size apart), so each frame is a contiguous view of
+ * it and nothing but the incoming samples is ever copied.
+ *
+ * Pushing never allocates nor throws, so it can be called from a real-time audio thread. The frames are the same as
+ * those of a Framecutter over all the samples pushed (with a valid_frame_threshold_ratio of 0 and
+ * last_frame_to_end_of_file false), the zero-padded frames at the end included once flush is called.
+ *
+ * @code
+ *   StreamingFramecutter framecutter(4096, 2048);
+ *
+ *   void audio_callback(const double *samples, size_t num_samples) {
+ *     framecutter.push(Span<const double>(samples, num_samples), [](Span<const double> frame) {
+ *       perform_work_on_frame(frame);
+ *     });
+ *   }
+ * @endcode
+ */
+class StreamingFramecutter {
+ private:
+  const size_t frame_size_;
+  const size_t hop_size_;
+  const bool start_from_center_;
+  std::vector<double> ring_;
+  size_t write_position_;
+  size_t until_next_frame_;
+  int64_t next_frame_start_;
+  int64_t num_samples_;
+  int64_t last_frame_end_;
+
+  void write(const double *samples, size_t num_samples) noexcept;
+  void write_zeros(size_t num_samples) noexcept;
+
+  template <typename OnFrame>
+  void emit(OnFrame &on_frame) {
+    on_frame(Span<const double>(ring_.data() + write_position_, frame_size_));
+    last_frame_end_ = next_frame_start_ + static_cast<int64_t>(frame_size_);
+    next_frame_start_ += static_cast<int64_t>(hop_size_);
+    until_next_frame_ = hop_size_;
+  }
+
+ public:
+  /**
+   * @brief Construct a new StreamingFramecutter object, allocating its ring buffer.
+   *
+   * @param frame_size Output frame size.
+   * @param hop_size Hop size between frames.
+   * @param start_from_center If true the first frame is centered on the first sample (zero-padded by
+   * (frame_size + 1) / 2 samples), if false it begins at the first sample, see Framecutter.
+   */
+  StreamingFramecutter(int frame_size = 1024, int hop_size = 512, bool start_from_center = true);
+
+  int frame_size() const { return static_cast<int>(frame_size_); }
+  int hop_size() const { return static_cast<int>(hop_size_); }
+
+  /**
+   * @brief Number of samples pushed since the stream started.
+   */
+  int64_t num_samples() const { return num_samples_; }
+
+  /**
+   * @brief Add samples to the stream, calling on_frame with every frame they complete.
+   *
+   * Neither allocates nor throws (as long as on_frame does not). A frame is only valid during its on_frame call.
+   *
+   * @param samples Next samples of the stream, any number of them.
+   * @param on_frame Callable taking a Span<const double> of frame_size samples.
+   * @return size_t Number of frames completed.
+   */
+  template <typename OnFrame>
+  size_t push(Span<const double> samples, OnFrame &&on_frame) {
+    if (samples.empty()) return 0;
+    size_t num_frames = 0;
+    const double *next_sample = samples.data();
+    size_t remaining = samples.size();
+    for (;;) {
+      // Only a one sample frame centered on the first sample is complete before any sample is pushed.
+      if (until_next_frame_ == 0) {
+        emit(on_frame);
+        num_frames++;
+        continue;
+      }
+      if (remaining == 0) break;
+      const size_t num_written = remaining < until_next_frame_ ? remaining : until_next_frame_;
+      write(next_sample, num_written);
+      num_samples_ += static_cast<int64_t>(num_written);
+      next_sample += num_written;
+      remaining -= num_written;
+      until_next_frame_ -= num_written;
+    }
+    return num_frames;
+  }
+
+  /**
+   * @brief End the stream, calling on_frame with the zero-padded frames that overlap its end, then reset.
+   *
+   * @param on_frame Callable taking a Span<const double> of frame_size samples.
+   * @return size_t Number of frames completed.
+   */
+  template <typename OnFrame>
+  size_t flush(OnFrame &&on_frame) {
+    size_t num_frames = 0;
+    while (num_samples_ > 0 && next_frame_start_ < num_samples_) {
+      // Without centering, the frame reaching the end of the stream is the last one, it may have been complete.
+      if (!start_from_center_ && last_frame_end_ >= num_samples_) break;
+      const bool last_frame =
+          !start_from_center_ || next_frame_start_ + static_cast<int64_t>(frame_size_ / 2) >= num_samples_;
+      write_zeros(until_next_frame_);
+      emit(on_frame);
+      num_frames++;
+      if (last_frame) break;
+    }
+    reset();
+    return num_frames;
+  }
+
+  /**
+   * @brief Drop every pushed sample and start a new stream.
+   */
+  void reset() noexcept;
+};
+
+}  // namespace core
+}  // namespace musher
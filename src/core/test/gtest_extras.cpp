@@ -0,0 +1,56 @@
+#include "src/core/test/gtest_extras.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+// Plain integer so it needs no dynamic initialisation and is usable from operator new at any time.
+thread_local uint64_t allocation_count = 0;
+
+void* CountedAllocate(std::size_t size) {
+  allocation_count++;
+  return std::malloc(size ? size : 1);
+}
+
+}  // namespace
+
+namespace musher {
+namespace core {
+namespace test {
+
+uint64_t AllocationCount() { return allocation_count; }
+
+}  // namespace test
+}  // namespace core
+}  // namespace musher
+
+// Replacements of the global allocation functions, for the whole test binary.
+void* operator new(std::size_t size) {
+  void* ptr = CountedAllocate(size);
+  if (!ptr) throw std::bad_alloc();
+  return ptr;
+}
+
+void* operator new[](std::size_t size) {
+  void* ptr = CountedAllocate(size);
+  if (!ptr) throw std::bad_alloc();
+  return ptr;
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return CountedAllocate(size); }
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return CountedAllocate(size); }
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+
+void operator delete[](void* ptr, std::size_t) noexcept { std::free(ptr); }
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { std::free(ptr); }
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { std::free(ptr); }
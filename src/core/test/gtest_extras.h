@@ -1,7 +1,75 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+
 #include "gtest/gtest.h"
 
+namespace musher {
+namespace core {
+namespace test {
+
+/**
+ * @brief Number of heap allocations (operator new) the calling thread made since it started.
+ *
+ * The test binary replaces the global operator new to count them, see gtest_extras.cpp.
+ */
+uint64_t AllocationCount();
+
+/**
+ * @brief Counts the heap allocations the calling thread makes while it exists.
+ *
+ */
+class AllocationCounter {
+ private:
+  const uint64_t start_;
+
+ public:
+  AllocationCounter() : start_(AllocationCount()) {}
+
+  uint64_t count() const { return AllocationCount() - start_; }
+};
+
+/**
+ * @brief Heap allocations per frame of a frame loop once it reached its steady state.
+ *
+ * The first warmup_frames frames are not counted, so buffers that are allocated once and then reused do not count.
+ *
+ * @param warmup_frames Frames to process before counting.
+ * @param frames Frames to count the allocations of.
+ * @param process_frame Callable processing a frame, called with the index of the frame.
+ * @return double Average number of allocations of a counted frame.
+ */
+template <typename ProcessFrame>
+double SteadyStateAllocationsPerFrame(size_t warmup_frames, size_t frames, ProcessFrame process_frame) {
+  size_t i = 0;
+  for (; i < warmup_frames; i++) process_frame(i);
+  AllocationCounter counter;
+  for (; i < warmup_frames + frames; i++) process_frame(i);
+  return frames ? static_cast<double>(counter.count()) / static_cast<double>(frames) : 0.;
+}
+
+}  // namespace test
+}  // namespace core
+}  // namespace musher
+
+/**
+ * @brief Expect a statement to make no heap allocation on the calling thread.
+ */
+#define EXPECT_NO_ALLOCATIONS(statement)                                                     \
+  {                                                                                          \
+    ::musher::core::test::AllocationCounter allocation_counter;                              \
+    statement;                                                                               \
+    EXPECT_EQ(allocation_counter.count(), 0u) << "Heap allocations in " #statement;          \
+  }
+
+/**
+ * @brief Expect a frame loop to make no heap allocation per frame once warmed up, see SteadyStateAllocationsPerFrame.
+ */
+#define EXPECT_NO_ALLOCATIONS_PER_FRAME(warmup_frames, frames, process_frame)                              \
+  EXPECT_EQ(::musher::core::test::SteadyStateAllocationsPerFrame(warmup_frames, frames, process_frame), 0.) \
+      << "Heap allocations per frame in " #process_frame
+
 #define EXPECT_VEC_EQ(x, y)                                                             \
   {                                                                                     \
     ASSERT_EQ(x.size(), y.size()) << "Vectors " #x " and " #y " are of unequal length"; \
@@ -0,0 +1,93 @@
+#include <algorithm>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "src/core/framecutter.h"
+#include "src/core/hpcp.h"
+#include "src/core/span.h"
+#include "src/core/test/gtest_extras.h"
+
+using namespace musher::core;
+using namespace musher::core::test;
+
+/**
+ * @brief The counter sees every allocation of the calling thread, and only those.
+ *
+ */
+TEST(Allocations, Counter) {
+  AllocationCounter counter;
+  std::vector<double> vec(16);
+  EXPECT_EQ(counter.count(), 1u);
+
+  vec.reserve(64);
+  EXPECT_EQ(counter.count(), 2u);
+  EXPECT_NO_ALLOCATIONS(for (int i = 0; i < 32; i++) vec.push_back(1.));
+
+  // Counting is per thread, so the allocations of another thread do not show up here.
+  std::thread thread([] { std::vector<double> other_vec(16); });
+  EXPECT_NO_ALLOCATIONS(thread.join());
+}
+
+/**
+ * @brief Allocations of the warmup frames are not counted.
+ *
+ */
+TEST(Allocations, SteadyStateAllocationsPerFrame) {
+  std::vector<double> buffer;
+  auto process_frame = [&buffer](size_t) {
+    if (buffer.empty()) buffer.resize(1024);
+    std::fill(buffer.begin(), buffer.end(), 0.);
+  };
+  EXPECT_EQ(SteadyStateAllocationsPerFrame(0, 4, process_frame), 0.25);
+  buffer.clear();
+  buffer.shrink_to_fit();
+  EXPECT_NO_ALLOCATIONS_PER_FRAME(1, 4, process_frame);
+
+  std::vector<std::vector<double>> frames;
+  frames.reserve(6);
+  auto allocate_frame = [&frames](size_t i) { frames.emplace_back(i + 1); };
+  EXPECT_EQ(SteadyStateAllocationsPerFrame(2, 4, allocate_frame), 1.);
+}
+
+/**
+ * @brief Accumulating the peaks of a frame into a reused HPCP does not allocate.
+ *
+ */
+TEST(Allocations, HPCPContributionsPerFrame) {
+  const std::vector<HarmonicPeak> harmonic_peaks = InitHarmonicContributionTable(4);
+  std::vector<double> hpcp(36, 0.);
+  auto process_frame = [&harmonic_peaks, &hpcp](size_t i) {
+    std::fill(hpcp.begin(), hpcp.end(), 0.);
+    for (int peak = 1; peak <= 8; peak++) {
+      const double freq = 110. * std::pow(2., static_cast<double>(peak + static_cast<int>(i % 12)) / 12.);
+      AddContribution(freq, 1. / peak, 440., 1., SQUARED_COSINE, harmonic_peaks, hpcp);
+    }
+    NormalizeInPlace(hpcp);
+  };
+  EXPECT_NO_ALLOCATIONS_PER_FRAME(1, 32, process_frame);
+}
+
+/**
+ * @brief Framecutter::compute allocates the frame it returns and nothing else.
+ *
+ */
+TEST(Allocations, FramecutterComputePerFrame) {
+  const std::vector<double> buffer(44100, 0.5);
+  Framecutter framecutter(Span<const double>(buffer), 4096, 2048);
+  auto process_frame = [&framecutter](size_t) { framecutter.compute(); };
+  EXPECT_EQ(SteadyStateAllocationsPerFrame(1, 8, process_frame), 1.);
+}
+
+/**
+ * @brief Framecutter::frame_into cuts frames into a reused buffer without allocating.
+ *
+ */
+TEST(Allocations, FramecutterFrameIntoPerFrame) {
+  const std::vector<double> buffer(44100, 0.5);
+  Framecutter framecutter(Span<const double>(buffer), 4096, 2048);
+  std::vector<double> frame(4096);
+  auto process_frame = [&framecutter, &frame](size_t i) { framecutter.frame_into(i, frame); };
+  EXPECT_NO_ALLOCATIONS_PER_FRAME(0, framecutter.num_frames(), process_frame);
+}
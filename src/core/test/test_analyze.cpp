@@ -0,0 +1,52 @@
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "src/core/analyze.h"
+#include "src/core/audio_decoders.h"
+#include "src/core/bpm.h"
+#include "src/core/key.h"
+#include "src/core/onset.h"
+#include "src/core/test/gtest_extras.h"
+
+using namespace musher::core;
+
+/**
+ * @brief The joint analysis gives the same key as DetectKey and the tempo of the track.
+ *
+ */
+TEST(Analyze, AnalyzeTrackMp3) {
+  const std::string file_path = TEST_DATA_DIR + std::string("audio_files/126bpm.mp3");
+  Mp3Decoded mp3_decoded = DecodeMp3(file_path, true);
+  Span<const double> mono_samples = mp3_decoded.normalized_samples.channel(0);
+
+  TrackAnalysis track_analysis = AnalyzeTrack(mono_samples, mp3_decoded.sample_rate);
+  KeyOutput key_output = DetectKey(mono_samples, mp3_decoded.sample_rate);
+  EXPECT_EQ(track_analysis.key, key_output.key);
+  EXPECT_EQ(track_analysis.scale, key_output.scale);
+  EXPECT_DOUBLE_EQ(track_analysis.strength, key_output.strength);
+  EXPECT_EQ(track_analysis.frames_processed, key_output.frames_processed);
+  EXPECT_NEAR(track_analysis.bpm, 126., 2.);
+  ASSERT_GT(track_analysis.beat_times.size(), 2u);
+  const double mean_beat_interval = (track_analysis.beat_times.back() - track_analysis.beat_times.front()) /
+                                    static_cast<double>(track_analysis.beat_times.size() - 1);
+  EXPECT_NEAR(60. / mean_beat_interval, 126., 2.);
+
+  TrackAnalysis file_analysis = AnalyzeTrack(file_path);
+  EXPECT_EQ(file_analysis.key, track_analysis.key);
+  EXPECT_DOUBLE_EQ(file_analysis.bpm, track_analysis.bpm);
+}
+
+/**
+ * @brief An onset envelope with a pulse every half second is 120 BPM, not a multiple of it.
+ *
+ */
+TEST(Analyze, BPMFromOnsetStrength) {
+  const double frame_rate = 100.;
+  std::vector<double> onset_envelope(1000, 0.);
+  for (size_t i = 0; i < onset_envelope.size(); i += 50) onset_envelope[i] = 1.;
+
+  EXPECT_NEAR(BPMFromOnsetStrength(onset_envelope, frame_rate), 120., .5);
+  EXPECT_EQ(BPMFromOnsetStrength(std::vector<double>(1000, 0.), frame_rate), 0.);
+  EXPECT_THROW(BPMFromOnsetStrength(onset_envelope, frame_rate, 100., 50.), std::runtime_error);
+}
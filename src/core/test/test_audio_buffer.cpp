@@ -0,0 +1,74 @@
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "src/core/audio_buffer.h"
+#include "src/core/mono_mixer.h"
+#include "src/core/test/gtest_extras.h"
+
+using namespace musher::core;
+
+/**
+ * @brief Channels are stored one after the other in a single aligned allocation.
+ *
+ */
+TEST(AudioBuffer, PlanarLayout) {
+  AudioBuffer buffer(2, 5);
+
+  EXPECT_EQ(buffer.channels(), 2u);
+  EXPECT_EQ(buffer.frames(), 5u);
+  EXPECT_EQ(buffer.size(), 10u);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(buffer.data()) % AudioBuffer::kAlignment, 0u);
+  EXPECT_EQ(buffer.channel(0).data(), buffer.data());
+  EXPECT_EQ(buffer.channel(1).data(), buffer.data() + 5);
+  for (size_t i = 0; i < buffer.size(); i++) EXPECT_EQ(buffer.data()[i], 0.);
+
+  Span<const double> frames = static_cast<const AudioBuffer&>(buffer).channel(1, 2, 3);
+  EXPECT_EQ(frames.data(), buffer.data() + 7);
+  EXPECT_EQ(frames.size(), 3u);
+  EXPECT_TRUE(AudioBuffer().empty());
+}
+
+/**
+ * @brief Interleaved samples survive a round trip through the planar layout.
+ *
+ */
+TEST(AudioBuffer, Interleaved) {
+  const std::vector<double> interleaved({ 1., -1., 2., -2., 3., -3. });
+  AudioBuffer buffer = AudioBuffer::FromInterleaved(interleaved, 2);
+
+  ASSERT_EQ(buffer.frames(), 3u);
+  const std::vector<double> expected_left({ 1., 2., 3. });
+  const std::vector<double> expected_right({ -1., -2., -3. });
+  Span<const double> left = buffer.channel(0);
+  Span<const double> right = buffer.channel(1);
+  EXPECT_VEC_EQ(left, expected_left);
+  EXPECT_VEC_EQ(right, expected_right);
+
+  std::vector<double> actual_interleaved = buffer.interleaved();
+  EXPECT_VEC_EQ(actual_interleaved, interleaved);
+  EXPECT_THROW(AudioBuffer::FromInterleaved(interleaved, 4), std::runtime_error);
+}
+
+/**
+ * @brief Copies own their samples, moves hand the allocation over.
+ *
+ */
+TEST(AudioBuffer, CopyAndMove) {
+  AudioBuffer buffer = AudioBuffer::FromInterleaved(std::vector<double>({ 1., 2., 3., 4. }), 2);
+  AudioBuffer copy(buffer);
+  copy.channel(0)[0] = 10.;
+  EXPECT_EQ(buffer.channel(0)[0], 1.);
+  EXPECT_NE(copy.data(), buffer.data());
+
+  const double* data = buffer.data();
+  AudioBuffer moved(std::move(buffer));
+  EXPECT_EQ(moved.data(), data);
+  EXPECT_EQ(moved.channels(), 2u);
+
+  std::vector<double> expected_mix({ 1.5, 3.5 });
+  std::vector<double> actual_mix = MonoMixer(moved);
+  EXPECT_VEC_EQ(actual_mix, expected_mix);
+}
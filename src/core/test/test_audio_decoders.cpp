@@ -2,6 +2,8 @@
 
 #include "gtest/gtest.h"
 #include "src/core/audio_decoders.h"
+#include "src/core/mono_mixer.h"
+#include "src/core/test/gtest_extras.h"
 #include "src/core/utils.h"
 
 using namespace musher::core;
@@ -176,3 +178,79 @@ TEST(AudioFileDecoding, DecodeMp3FromFile) {
   int actual_avg_bitrate_kbps = mp3_decoded.avg_bitrate_kbps;
   EXPECT_EQ(expected_avg_bitrate_kbps, actual_avg_bitrate_kbps);
 }
+
+/**
+ * @brief Decode a stereo WAV straight to mono.
+ *
+ */
+TEST(AudioFileDecoding, DecodeWavMonoDownmix) {
+  const std::string file_path = TEST_DATA_DIR + std::string("audio_files/700kb.wav");
+  WavDecoded wav_decoded = DecodeWav(file_path);
+  WavDecoded mono_decoded = DecodeWav(file_path, true);
+
+  ASSERT_EQ(wav_decoded.channels, 2);
+  EXPECT_EQ(mono_decoded.channels, 1);
+  EXPECT_TRUE(mono_decoded.mono);
+  EXPECT_FALSE(mono_decoded.stereo);
+  EXPECT_EQ(mono_decoded.samples_per_channel, wav_decoded.samples_per_channel);
+  EXPECT_DOUBLE_EQ(mono_decoded.length_in_seconds, wav_decoded.length_in_seconds);
+  EXPECT_EQ(mono_decoded.avg_bitrate_kbps, wav_decoded.avg_bitrate_kbps);
+  ASSERT_EQ(mono_decoded.normalized_samples.channels(), 1u);
+
+  std::vector<double> expected_samples = MonoMixer(wav_decoded.normalized_samples);
+  Span<const double> actual_samples = mono_decoded.normalized_samples.channel(0);
+  EXPECT_VEC_EQ(actual_samples, expected_samples);
+}
+
+/**
+ * @brief Downmixing a mono WAV leaves the samples untouched.
+ *
+ */
+TEST(AudioFileDecoding, DecodeWavMonoDownmixOfMono) {
+  const std::string file_path = TEST_DATA_DIR + std::string("audio_files/CantinaBand3sec.wav");
+  WavDecoded wav_decoded = DecodeWav(file_path);
+  WavDecoded mono_decoded = DecodeWav(file_path, true);
+
+  ASSERT_EQ(mono_decoded.normalized_samples.channels(), 1u);
+  Span<const double> expected_samples = wav_decoded.normalized_samples.channel(0);
+  Span<const double> actual_samples = mono_decoded.normalized_samples.channel(0);
+  EXPECT_VEC_EQ(actual_samples, expected_samples);
+}
+
+/**
+ * @brief Decode a stereo MP3 straight to mono.
+ *
+ */
+TEST(AudioFileDecoding, DecodeMp3MonoDownmix) {
+  const std::string file_path = TEST_DATA_DIR + std::string("audio_files/mozart_c_major_30sec.mp3");
+  Mp3Decoded mp3_decoded = DecodeMp3(file_path);
+  Mp3Decoded mono_decoded = DecodeMp3(file_path, true);
+
+  ASSERT_EQ(mp3_decoded.channels, 2);
+  EXPECT_EQ(mono_decoded.channels, 1);
+  EXPECT_TRUE(mono_decoded.mono);
+  EXPECT_EQ(mono_decoded.samples_per_channel, mp3_decoded.samples_per_channel);
+  ASSERT_EQ(mono_decoded.normalized_samples.channels(), 1u);
+
+  std::vector<double> expected_samples = MonoMixer(mp3_decoded.normalized_samples);
+  Span<const double> actual_samples = mono_decoded.normalized_samples.channel(0);
+  EXPECT_VEC_EQ(actual_samples, expected_samples);
+}
+
+/**
+ * @brief Channels are stored one after the other in a single buffer.
+ *
+ */
+TEST(AudioFileDecoding, DecodeMp3PlanarChannels) {
+  const std::string file_path = TEST_DATA_DIR + std::string("audio_files/mozart_c_major_30sec.mp3");
+  Mp3Decoded mp3_decoded = DecodeMp3(file_path);
+  const size_t samples_per_channel = static_cast<size_t>(mp3_decoded.samples_per_channel);
+
+  ASSERT_EQ(mp3_decoded.channels, 2);
+  ASSERT_EQ(mp3_decoded.normalized_samples.size(), 2 * samples_per_channel);
+  std::vector<Span<const double>> channels = mp3_decoded.normalized_samples.channel_spans();
+  ASSERT_EQ(channels.size(), 2u);
+  EXPECT_EQ(channels[0].data(), mp3_decoded.normalized_samples.data());
+  EXPECT_EQ(channels[1].data(), mp3_decoded.normalized_samples.data() + samples_per_channel);
+  EXPECT_EQ(channels[1].size(), samples_per_channel);
+}
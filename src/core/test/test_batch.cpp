@@ -0,0 +1,100 @@
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "src/core/audio_decoders.h"
+#include "src/core/batch.h"
+#include "src/core/key.h"
+#include "src/core/mono_mixer.h"
+#include "src/core/test/gtest_extras.h"
+
+using namespace musher::core;
+
+/**
+ * @brief Decoding from data picks the decoder from the file extension.
+ *
+ */
+TEST(Batch, DecodeMonoFromData) {
+  const std::string file_path = TEST_DATA_DIR + std::string("audio_files/700kb.wav");
+  std::vector<uint8_t> file_data = LoadAudioFile(file_path);
+
+  double sample_rate = 0.;
+  AudioBuffer mono_samples = DecodeMonoFromData(file_path, file_data, sample_rate);
+  WavDecoded wav_decoded = DecodeWav(file_data, true);
+
+  EXPECT_DOUBLE_EQ(sample_rate, 32000.);
+  ASSERT_EQ(mono_samples.channels(), 1u);
+  Span<const double> actual_samples = mono_samples.channel(0);
+  Span<const double> expected_samples = wav_decoded.normalized_samples.channel(0);
+  EXPECT_VEC_EQ(actual_samples, expected_samples);
+
+  EXPECT_THROW(DecodeMonoFromData("file.flac", file_data, sample_rate), std::runtime_error);
+}
+
+/**
+ * @brief Batch results match DetectKey, keep their order and report errors per file.
+ *
+ */
+TEST(Batch, DetectKeyBatch) {
+  const std::string mp3_path = TEST_DATA_DIR + std::string("audio_files/mozart_c_major_30sec.mp3");
+  const std::string wav_path = TEST_DATA_DIR + std::string("audio_files/CantinaBand3sec.wav");
+  const std::string missing_path = TEST_DATA_DIR + std::string("audio_files/does_not_exist.mp3");
+  std::vector<std::string> file_paths = { mp3_path, missing_path, wav_path, mp3_path };
+
+  // Keep one file in flight so the reader has to wait on the workers.
+  std::vector<KeyBatchResult> results = DetectKeyBatch(file_paths, 2, 1);
+
+  Mp3Decoded mp3_decoded = DecodeMp3(mp3_path);
+  KeyOutput expected_mp3 = DetectKey(mp3_decoded.normalized_samples, mp3_decoded.sample_rate);
+  WavDecoded wav_decoded = DecodeWav(wav_path);
+  KeyOutput expected_wav = DetectKey(wav_decoded.normalized_samples, wav_decoded.sample_rate);
+
+  ASSERT_EQ(results.size(), file_paths.size());
+  for (size_t i = 0; i < results.size(); i++) {
+    EXPECT_EQ(results[i].file_path, file_paths[i]);
+  }
+
+  EXPECT_FALSE(results[1].ok);
+  EXPECT_EQ(results[1].error, "Failed to load file '" + missing_path + "'");
+
+  for (size_t i : { 0, 2, 3 }) {
+    const KeyOutput& expected = i == 2 ? expected_wav : expected_mp3;
+    ASSERT_TRUE(results[i].ok) << results[i].error;
+    EXPECT_EQ(results[i].key_output.key, expected.key);
+    EXPECT_EQ(results[i].key_output.scale, expected.scale);
+    EXPECT_DOUBLE_EQ(results[i].key_output.strength, expected.strength);
+    EXPECT_EQ(results[i].key_output.frames_processed, expected.frames_processed);
+  }
+}
+
+/**
+ * @brief A custom key function is used for every file.
+ *
+ */
+TEST(Batch, DetectKeyBatchCustomFunction) {
+  const std::string wav_path = TEST_DATA_DIR + std::string("audio_files/CantinaBand3sec.wav");
+  std::vector<std::string> file_paths(3, wav_path);
+
+  std::vector<KeyBatchResult> results =
+      DetectKeyBatch(file_paths, 0, 0, [](Span<const double> mono_samples, double sample_rate) {
+        KeyOutput key_output;
+        key_output.key = "A";
+        key_output.frames_processed = static_cast<int>(mono_samples.size() / sample_rate);
+        return key_output;
+      });
+
+  for (const KeyBatchResult& result : results) {
+    ASSERT_TRUE(result.ok) << result.error;
+    EXPECT_EQ(result.key_output.key, "A");
+    EXPECT_EQ(result.key_output.frames_processed, 3);
+  }
+}
+
+/**
+ * @brief An empty batch returns no results.
+ *
+ */
+TEST(Batch, DetectKeyBatchEmpty) {
+  std::vector<KeyBatchResult> results = DetectKeyBatch(std::vector<std::string>());
+  EXPECT_TRUE(results.empty());
+}
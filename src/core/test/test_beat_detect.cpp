@@ -1,23 +1,96 @@
-// TEST(AudioFileDecoding, BeatDetection) {
-//   const std::string filePath = TEST_DATA_DIR + std::string("audio_files/CantinaBand3sec.wav");
+#include <cmath>
+#include <string>
+#include <tuple>
+#include <vector>
 
-//   WavDecoded wav_decoded = DecodeWav(filePath);
-//   uint32_t sampleRate = wav_decoded.sample_rate;
-//   std::vector<double> interleaved_normalized_samples = wav_decoded.interleaved_normalized_samples;
+#include "gtest/gtest.h"
+#include "src/core/audio_decoders.h"
+#include "src/core/bpm.h"
+#include "src/core/test/gtest_extras.h"
 
-//   double bpm = BPMOverWindow(interleaved_normalized_samples, sampleRate, 3);
-//   EXPECT_EQ(bpm, 80.);
-// }
+using namespace musher::core;
 
-// TEST(AudioFileDecoding, MP3BPM) {
-//   std::vector<double> NormalizedSamples;
-//   const std::string filePathMp3 = TEST_DATA_DIR + std::string("audio_files/126bpm.mp3");
+/**
+ * @brief Haar DWT matches PyWavelets.
+ *
+ */
+TEST(BeatDetection, DWTHaar) {
+  std::vector<double> input = { 1., 2., 3., 4., 5. };
+  std::vector<double> approx, detail;
+  std::tie(approx, detail) = DWT(input, "haar");
 
-//   Mp3Decoded mp3_decoded = CDecodeMp3(filePathMp3);
-//   uint32_t sampleRate = mp3_decoded.sample_rate;
-//   std::vector<double> interleaved_normalized_samples = mp3_decoded.interleaved_normalized_samples;
+  // pywt.dwt([1, 2, 3, 4, 5], "haar")
+  std::vector<double> expected_approx = { 2.1213203435596424, 4.949747468305833, 7.0710678118654755 };
+  std::vector<double> expected_detail = { -0.7071067811865476, -0.7071067811865476, 0. };
+  EXPECT_VEC_NEAR(approx, expected_approx, 1e-12);
+  EXPECT_VEC_NEAR(detail, expected_detail, 1e-12);
+}
 
-//   double bpm = BPMOverWindow(interleaved_normalized_samples, sampleRate, 3);
-//   // std::cout << bpm << std::endl;
-//   EXPECT_DOUBLE_EQ(bpm, 125.);
-// }
+/**
+ * @brief db4 has 4 vanishing moments, so polynomials up to cubic have no detail away from the edges.
+ *
+ */
+TEST(BeatDetection, DWTDb4VanishingMoments) {
+  std::vector<double> input(64);
+  for (size_t i = 0; i < input.size(); i++) input[i] = 0.5 + 0.1 * i - 0.002 * i * i + 0.00001 * i * i * i;
+
+  std::vector<double> approx, detail;
+  std::tie(approx, detail) = DWT(input, "db4");
+
+  ASSERT_EQ(approx.size(), 35u);
+  ASSERT_EQ(detail.size(), 35u);
+  for (size_t o = 4; o < 31; o++) {
+    EXPECT_NEAR(detail[o], 0., 1e-9) << "Detail differs at index " << o;
+  }
+
+  // A constant signal stays constant under symmetric extension, scaled by sqrt(2).
+  std::vector<double> constant(20, 1.5);
+  std::tie(approx, detail) = DWT(constant, "db4");
+  for (size_t o = 0; o < approx.size(); o++) {
+    EXPECT_NEAR(approx[o], 1.5 * std::sqrt(2.), 1e-9);
+    EXPECT_NEAR(detail[o], 0., 1e-9);
+  }
+
+  EXPECT_THROW(SelectWavelet("db20"), std::runtime_error);
+}
+
+/**
+ * @brief BPM of a short wav clip.
+ *
+ */
+TEST(BeatDetection, BPMOverWindowWav) {
+  const std::string file_path = TEST_DATA_DIR + std::string("audio_files/CantinaBand3sec.wav");
+
+  WavDecoded wav_decoded = DecodeWav(file_path, true);
+  double sample_rate = wav_decoded.sample_rate;
+  Span<const double> mono_samples = wav_decoded.normalized_samples.channel(0);
+
+  double bpm = BPMOverWindow(mono_samples, sample_rate, 3);
+  EXPECT_EQ(bpm, 80.);
+}
+
+/**
+ * @brief BPM of an mp3 with a known tempo.
+ *
+ */
+TEST(BeatDetection, BPMOverWindowMp3) {
+  const std::string file_path = TEST_DATA_DIR + std::string("audio_files/126bpm.mp3");
+
+  Mp3Decoded mp3_decoded = DecodeMp3(file_path, true);
+  double sample_rate = mp3_decoded.sample_rate;
+  Span<const double> mono_samples = mp3_decoded.normalized_samples.channel(0);
+
+  double bpm = BPMOverWindow(mono_samples, sample_rate, 3);
+  EXPECT_DOUBLE_EQ(bpm, 125.);
+  EXPECT_NEAR(BPMDetection(mono_samples, sample_rate), 126., 1.5);
+}
+
+/**
+ * @brief Silence has no tempo.
+ *
+ */
+TEST(BeatDetection, BPMSilence) {
+  std::vector<double> silence(44100 * 6, 0.);
+  EXPECT_EQ(BPMDetection(silence, 44100.), 0.);
+  EXPECT_EQ(BPMOverWindow(silence, 44100., 3), 0.);
+}
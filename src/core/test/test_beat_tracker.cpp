@@ -0,0 +1,77 @@
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "src/core/audio_decoders.h"
+#include "src/core/beat_tracker.h"
+#include "src/core/key.h"
+#include "src/core/onset.h"
+#include "src/core/test/gtest_extras.h"
+
+using namespace musher::core;
+
+/**
+ * @brief Beats land on the pulses of a regular onset envelope, even when the tempo estimate is slightly off.
+ *
+ */
+TEST(BeatTracker, BeatTrackFramesPulses) {
+  const double frame_rate = 100.;
+  std::vector<double> onset_envelope(1000, 0.);
+  std::vector<size_t> expected_beats;
+  for (size_t i = 25; i < onset_envelope.size(); i += 50) {
+    onset_envelope[i] = 1.;
+    expected_beats.push_back(i);
+  }
+
+  EXPECT_EQ(BeatTrackFrames(onset_envelope, frame_rate, 120.), expected_beats);
+  EXPECT_EQ(BeatTrackFrames(onset_envelope, frame_rate, 117.), expected_beats);
+
+  std::vector<double> beat_times = BeatTrack(onset_envelope, frame_rate, 120.);
+  ASSERT_EQ(beat_times.size(), expected_beats.size());
+  EXPECT_DOUBLE_EQ(beat_times[0], .25);
+  EXPECT_DOUBLE_EQ(beat_times[1], .75);
+}
+
+/**
+ * @brief A missing pulse is bridged by the tempo, weak beats at the ends are trimmed.
+ *
+ */
+TEST(BeatTracker, BeatTrackFramesGapAndTrim) {
+  const double frame_rate = 100.;
+  std::vector<double> onset_envelope(1000, 0.);
+  for (size_t i = 100; i < 900; i += 50) {
+    if (i != 400) onset_envelope[i] = 1.;
+  }
+
+  std::vector<size_t> beats = BeatTrackFrames(onset_envelope, frame_rate, 120.);
+  ASSERT_FALSE(beats.empty());
+  EXPECT_EQ(beats.front(), 100u);
+  EXPECT_EQ(beats.back(), 850u);
+  EXPECT_EQ(beats.size(), 16u);
+
+  EXPECT_TRUE(BeatTrackFrames(std::vector<double>(1000, 0.), frame_rate, 120.).empty());
+  EXPECT_THROW(BeatTrackFrames(onset_envelope, frame_rate, 0.), std::runtime_error);
+}
+
+/**
+ * @brief The beats of a file with an impulse every second fall on the impulses.
+ *
+ */
+TEST(BeatTracker, BeatTrackImpulsesWav) {
+  const std::string file_path = TEST_DATA_DIR + std::string("audio_files/impulses_1second_44100.wav");
+  WavDecoded wav_decoded = DecodeWav(file_path, true);
+  const int hop_size = 512;
+
+  OnsetStrength onset_strength;
+  DetectKey(wav_decoded.normalized_samples, wav_decoded.sample_rate, "Bgate", true, true, 4, 0.6, false, 36, 4096,
+            hop_size, BlackmanHarris62dB, 100, .5, 0, 3, 0.01, 0.,
+            [&onset_strength](const std::vector<double>& spectrum) { onset_strength.process(spectrum); });
+
+  std::vector<double> beat_times = BeatTrack(onset_strength.envelope(), wav_decoded.sample_rate / hop_size, 60.);
+  ASSERT_EQ(beat_times.size(), 9u);
+  for (size_t i = 0; i < beat_times.size(); i++) {
+    // Onsets are detected up to two hops before the impulse.
+    EXPECT_NEAR(beat_times[i], static_cast<double>(i + 1), 2. * hop_size / wav_decoded.sample_rate);
+  }
+}
@@ -0,0 +1,162 @@
+#include <cmath>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "src/core/fft_convolve.h"
+#include "src/core/test/gtest_extras.h"
+
+using namespace musher::core;
+
+namespace {
+
+/**
+ * @brief Direct full linear convolution.
+ */
+std::vector<double> DirectConvolve(const std::vector<double> &vec1, const std::vector<double> &vec2) {
+  std::vector<double> full(vec1.size() + vec2.size() - 1, 0.);
+  for (size_t i = 0; i < vec1.size(); i++) {
+    for (size_t j = 0; j < vec2.size(); j++) full[i + j] += vec1[i] * vec2[j];
+  }
+  return full;
+}
+
+std::vector<double> TestSignal(size_t size, double seed) {
+  std::vector<double> signal(size);
+  for (size_t i = 0; i < size; i++) signal[i] = std::sin(seed * static_cast<double>(i + 1)) + .1 * seed;
+  return signal;
+}
+
+}  // namespace
+
+/**
+ * @brief Full, same and valid convolution match a direct convolution, including when the plan is reused.
+ *
+ */
+TEST(FFTConvolve, ConvolverModes) {
+  std::vector<double> vec1 = TestSignal(37, 1.3);
+  std::vector<double> vec2 = TestSignal(8, .7);
+  std::vector<double> full = DirectConvolve(vec1, vec2);
+
+  Convolver full_convolver("full");
+  EXPECT_VEC_NEAR(full_convolver.compute(vec1, vec2), full, 1e-10);
+  EXPECT_VEC_NEAR(full_convolver.compute(vec1, vec2), full, 1e-10);
+
+  Convolver same_convolver("same");
+  std::vector<double> expected_same(full.begin() + 3, full.begin() + 3 + 37);
+  EXPECT_VEC_NEAR(same_convolver.compute(vec1, vec2), expected_same, 1e-10);
+  EXPECT_VEC_NEAR(FFTConvolve(vec1, vec2), expected_same, 1e-10);
+
+  Convolver valid_convolver("valid");
+  std::vector<double> expected_valid(full.begin() + 7, full.begin() + 7 + 30);
+  EXPECT_VEC_NEAR(valid_convolver.compute(vec1, vec2), expected_valid, 1e-10);
+  // Convolution commutes, so the valid part does not depend on the order of the inputs.
+  EXPECT_VEC_NEAR(valid_convolver.compute(vec2, vec1), expected_valid, 1e-10);
+
+  // A different size replans, the output buffer is resized.
+  std::vector<double> output;
+  full_convolver.compute(vec2, vec2, output);
+  EXPECT_VEC_NEAR(output, DirectConvolve(vec2, vec2), 1e-10);
+
+  EXPECT_TRUE(full_convolver.compute(std::vector<double>(), vec2).empty());
+  EXPECT_THROW(Convolver("circular"), std::runtime_error);
+}
+
+/**
+ * @brief Cross-correlation equals convolution with the reversed second input.
+ *
+ */
+TEST(FFTConvolve, CorrelatorModes) {
+  std::vector<double> vec1 = TestSignal(29, .9);
+  std::vector<double> vec2 = TestSignal(11, 2.1);
+  std::vector<double> reversed(vec2.rbegin(), vec2.rend());
+
+  for (const std::string mode : { "full", "same", "valid" }) {
+    Correlator correlator(mode);
+    Convolver convolver(mode);
+    EXPECT_VEC_NEAR(correlator.compute(vec1, vec2), convolver.compute(vec1, reversed), 1e-10);
+  }
+
+  // The full output starts at lag -(vec2.size() - 1).
+  std::vector<double> full = Correlator("full").compute(vec1, vec2);
+  double zero_lag = 0.;
+  for (size_t i = 0; i < vec2.size(); i++) zero_lag += vec1[i] * vec2[i];
+  EXPECT_NEAR(full[vec2.size() - 1], zero_lag, 1e-10);
+}
+
+/**
+ * @brief The power spectrum path gives the one sided autocorrelation.
+ *
+ */
+TEST(FFTConvolve, Autocorrelate) {
+  Correlator correlator;
+  for (const size_t size : { 1, 2, 17, 64, 101 }) {
+    std::vector<double> signal = TestSignal(size, 1.7);
+    std::vector<double> expected(size, 0.);
+    for (size_t lag = 0; lag < size; lag++) {
+      for (size_t n = 0; n + lag < size; n++) expected[lag] += signal[n] * signal[n + lag];
+    }
+    EXPECT_VEC_NEAR(correlator.autocorrelate(signal), expected, 1e-10);
+    EXPECT_GE(correlator.fft_size(), 2 * size - 1);
+  }
+}
+
+/**
+ * @brief Overlap-add gives the same convolution as a single FFT, in every mode and input order.
+ *
+ */
+TEST(FFTConvolve, ConvolverOverlapAdd) {
+  std::vector<double> signal = TestSignal(5003, .31);
+  std::vector<double> kernel = TestSignal(31, 1.9);
+  EXPECT_TRUE(PreferOverlapAdd(signal.size(), kernel.size()));
+  EXPECT_TRUE(PreferOverlapAdd(kernel.size(), signal.size()));
+  EXPECT_FALSE(PreferOverlapAdd(100, 90));
+  EXPECT_GE(OverlapAddFFTSize(kernel.size()), 8 * kernel.size());
+
+  for (const std::string mode : { "full", "same", "valid" }) {
+    Convolver fft_convolver(mode, "fft");
+    Convolver overlap_add_convolver(mode, "overlap-add");
+    Convolver auto_convolver(mode);
+    std::vector<double> expected = fft_convolver.compute(signal, kernel);
+    std::vector<double> overlap_add_output = overlap_add_convolver.compute(signal, kernel);
+    std::vector<double> auto_output = auto_convolver.compute(signal, kernel);
+    EXPECT_VEC_NEAR(overlap_add_output, expected, 1e-9);
+    EXPECT_VEC_NEAR(auto_output, expected, 1e-9);
+    EXPECT_LT(auto_convolver.fft_size(), fft_convolver.fft_size());
+
+    std::vector<double> expected_swapped = fft_convolver.compute(kernel, signal);
+    std::vector<double> swapped_output = overlap_add_convolver.compute(kernel, signal);
+    EXPECT_VEC_NEAR(swapped_output, expected_swapped, 1e-9);
+  }
+  EXPECT_THROW(Convolver("same", "direct"), std::runtime_error);
+}
+
+/**
+ * @brief Pushing a signal in uneven chunks and flushing gives its full convolution.
+ *
+ */
+TEST(FFTConvolve, StreamingConvolver) {
+  std::vector<double> signal = TestSignal(1000, .53);
+  std::vector<double> kernel = TestSignal(17, 1.1);
+  std::vector<double> expected = DirectConvolve(signal, kernel);
+
+  StreamingConvolver convolver(kernel, 100);
+  EXPECT_GE(convolver.block_size(), 100u);
+  for (int pass = 0; pass < 2; pass++) {
+    std::vector<double> streamed;
+    std::vector<double> output;
+    size_t start = 0;
+    for (const size_t chunk_size : { 1, 7, 250, 3, 500, 239 }) {
+      convolver.process(std::vector<double>(signal.begin() + start, signal.begin() + start + chunk_size), output);
+      EXPECT_EQ(output.size() % convolver.block_size(), 0u);
+      streamed.insert(streamed.end(), output.begin(), output.end());
+      start += chunk_size;
+    }
+    convolver.flush(output);
+    streamed.insert(streamed.end(), output.begin(), output.end());
+    // Flushing resets the stream, so the second pass starts over.
+    EXPECT_VEC_NEAR(streamed, expected, 1e-9);
+  }
+  EXPECT_THROW(StreamingConvolver(std::vector<double>()), std::runtime_error);
+}
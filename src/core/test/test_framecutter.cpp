@@ -1,8 +1,11 @@
+#include "src/core/framecutter.h"
+#include "src/core/threading.h"
 #include "src/core/test/gtest_extras.h"
 #include "src/core/test/utils.h"
 #include "gtest/gtest.h"
 #include <vector>
 #include <numeric>
+#include <stdexcept>
 
 using namespace musher::core;
 using namespace musher::core::test;
@@ -1276,3 +1279,135 @@ TEST(Framecutter, TestDontDropLastFrameStartFromCenterOddFrameSize2) {
 
   EXPECT_MATRIX_EQ(actual_frames, expected_frames);
 }
+
+/**
+ * @brief A Framecutter reading a view of the samples cuts the same frames as one that copies them.
+ *
+ */
+TEST(Framecutter, SpanBufferMatchesVectorBuffer) {
+  std::vector<double> buffer(100);
+  std::iota(std::begin(buffer), std::end(buffer), 1.);
+
+  std::vector<std::vector<double>> vector_frames;
+  for (const std::vector<double> &frame : Framecutter(buffer, 16, 7)) vector_frames.push_back(frame);
+
+  std::vector<std::vector<double>> span_frames;
+  Framecutter span_framecutter(Span<const double>(buffer), 16, 7);
+  for (const std::vector<double> &frame : span_framecutter) span_frames.push_back(frame);
+
+  EXPECT_MATRIX_EQ(span_frames, vector_frames);
+}
+
+/**
+ * @brief Frame starts give the same frames as iterating, for every way frames can end.
+ *
+ */
+TEST(Framecutter, FrameStartsMatchIteration) {
+  std::vector<double> buffer(50);
+  std::iota(std::begin(buffer), std::end(buffer), 1.);
+  const int frame_size = 8;
+
+  for (bool start_from_center : { true, false }) {
+    for (bool last_frame_to_end_of_file : { true, false }) {
+      Framecutter framecutter(buffer, frame_size, 5, start_from_center, last_frame_to_end_of_file, 0.25);
+      std::vector<std::vector<double>> expected_frames;
+      for (const std::vector<double> &frame : framecutter) expected_frames.push_back(frame);
+
+      std::vector<std::vector<double>> actual_frames;
+      for (int start : framecutter.frame_starts()) {
+        std::vector<double> frame(frame_size, 0.);
+        for (int j = 0; j < frame_size; j++) {
+          if (start + j >= 0 && start + j < static_cast<int>(buffer.size())) frame[j] = buffer[start + j];
+        }
+        actual_frames.push_back(frame);
+      }
+      EXPECT_MATRIX_EQ(actual_frames, expected_frames);
+    }
+  }
+}
+
+/**
+ * @brief Random access gives the same frames as iterating, for every edge setting.
+ *
+ */
+TEST(Framecutter, RandomAccessMatchesIteration) {
+  for (size_t buffer_size : { 0, 3, 8, 50 }) {
+    std::vector<double> buffer(buffer_size);
+    std::iota(std::begin(buffer), std::end(buffer), 1.);
+    for (bool start_from_center : { true, false }) {
+      for (bool last_frame_to_end_of_file : { true, false }) {
+        for (double valid_frame_threshold_ratio : { 0., 0.25, 0.5 }) {
+          Framecutter framecutter(buffer, 8, 3, start_from_center, last_frame_to_end_of_file,
+                                  valid_frame_threshold_ratio);
+          std::vector<std::vector<double>> expected_frames;
+          for (const std::vector<double> &frame : framecutter) expected_frames.push_back(frame);
+          ASSERT_EQ(framecutter.num_frames(), expected_frames.size());
+
+          std::vector<std::vector<double>> actual_frames;
+          std::vector<std::vector<double>> actual_frames_into;
+          // Back to front, to show the order does not matter.
+          for (size_t i = framecutter.num_frames(); i-- > 0;) {
+            actual_frames.insert(actual_frames.begin(), framecutter.frame(i));
+            std::vector<double> frame(8, -1.);
+            framecutter.frame_into(i, frame);
+            actual_frames_into.insert(actual_frames_into.begin(), frame);
+          }
+          EXPECT_MATRIX_EQ(actual_frames, expected_frames);
+          EXPECT_MATRIX_EQ(actual_frames_into, expected_frames);
+        }
+      }
+    }
+  }
+}
+
+/**
+ * @brief Frames can be cut from several threads at once.
+ *
+ */
+TEST(Framecutter, FrameIntoParallel) {
+  std::vector<double> buffer(10000);
+  std::iota(std::begin(buffer), std::end(buffer), 1.);
+  Framecutter framecutter(Span<const double>(buffer), 256, 64);
+
+  std::vector<double> expected_sums;
+  for (const std::vector<double> &frame : framecutter) {
+    expected_sums.push_back(std::accumulate(frame.begin(), frame.end(), 0.));
+  }
+
+  std::vector<double> actual_sums(framecutter.num_frames());
+  ParallelFor(framecutter.num_frames(), 4, [&](size_t begin, size_t end) {
+    std::vector<double> frame(256);
+    for (size_t i = begin; i < end; i++) {
+      framecutter.frame_into(i, frame);
+      actual_sums[i] = std::accumulate(frame.begin(), frame.end(), 0.);
+    }
+  });
+  EXPECT_VEC_EQ(actual_sums, expected_sums);
+}
+
+/**
+ * @brief Out of range indices and wrongly sized outputs are rejected.
+ *
+ */
+TEST(Framecutter, RandomAccessErrors) {
+  std::vector<double> buffer(20, 1.);
+  Framecutter framecutter(buffer, 8, 4);
+  std::vector<double> frame(8);
+  std::vector<double> small_frame(4);
+
+  EXPECT_THROW(framecutter.frame(framecutter.num_frames()), std::runtime_error);
+  EXPECT_THROW(framecutter.frame_into(framecutter.num_frames(), frame), std::runtime_error);
+  EXPECT_THROW(framecutter.frame_into(0, small_frame), std::runtime_error);
+}
+
+/**
+ * @brief Frames that would never advance are rejected at construction instead of being listed forever.
+ *
+ */
+TEST(Framecutter, NonPositiveSizes) {
+  std::vector<double> buffer(20, 1.);
+  EXPECT_THROW(Framecutter(buffer, 8, 0), std::runtime_error);
+  EXPECT_THROW(Framecutter(buffer, 8, -4), std::runtime_error);
+  EXPECT_THROW(Framecutter(buffer, 0, 4), std::runtime_error);
+  EXPECT_THROW(Framecutter(Span<const double>(buffer), -8, 4), std::runtime_error);
+}
@@ -0,0 +1,81 @@
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "src/core/audio_decoders.h"
+#include "src/core/instrumentation.h"
+#include "src/core/key.h"
+
+using namespace musher::core;
+
+/**
+ * @brief Records add up per stage and reset clears them.
+ *
+ */
+TEST(Instrumentation, SinkRecordsAndResets) {
+  InstrumentationSink sink;
+  sink.record(Stage::kSpectrum, 1000, 1, 16);
+  sink.record(Stage::kSpectrum, 3000, 2, 32);
+
+  std::vector<StageStats> stats = sink.stats();
+  ASSERT_EQ(stats.size(), kNumStages);
+  const StageStats& spectrum_stats = stats[static_cast<size_t>(Stage::kSpectrum)];
+  EXPECT_EQ(spectrum_stats.stage, "spectrum");
+  EXPECT_EQ(spectrum_stats.calls, 2u);
+  EXPECT_DOUBLE_EQ(spectrum_stats.seconds, 4e-6);
+  EXPECT_EQ(spectrum_stats.frames, 3u);
+  EXPECT_EQ(spectrum_stats.output_bytes, 48u);
+  EXPECT_EQ(stats[static_cast<size_t>(Stage::kHPCP)].calls, 0u);
+
+  sink.reset();
+  EXPECT_EQ(sink.stats()[static_cast<size_t>(Stage::kSpectrum)].calls, 0u);
+}
+
+/**
+ * @brief A timer only records into the sink that was set when it started.
+ *
+ */
+TEST(Instrumentation, StageTimer) {
+  InstrumentationSink sink;
+  StageTimer unrecorded_timer(Stage::kWindowing);
+  SetInstrumentationSink(&sink);
+  StageTimer timer(Stage::kWindowing);
+  SetInstrumentationSink(nullptr);
+
+  unrecorded_timer.stop(1, 8);
+  timer.stop(1, 8);
+  EXPECT_EQ(sink.stats()[static_cast<size_t>(Stage::kWindowing)].calls, 1u);
+}
+
+/**
+ * @brief DetectKey records every stage of every frame when instrumentation is compiled in, and nothing otherwise.
+ *
+ */
+TEST(Instrumentation, DetectKeyStages) {
+  const std::string file_path = TEST_DATA_DIR + std::string("audio_files/impulses_1second_44100.wav");
+  InstrumentationSink sink;
+  SetInstrumentationSink(&sink);
+  WavDecoded wav_decoded = DecodeWav(file_path);
+  KeyOutput key_output = DetectKey(wav_decoded.normalized_samples, wav_decoded.sample_rate);
+  SetInstrumentationSink(nullptr);
+
+  std::vector<StageStats> stats = sink.stats();
+  if (!InstrumentationCompiled()) {
+    for (const StageStats& stage_stats : stats) EXPECT_EQ(stage_stats.calls, 0u) << stage_stats.stage;
+    return;
+  }
+
+  const uint64_t frames = static_cast<uint64_t>(key_output.frames_processed);
+  EXPECT_EQ(stats[static_cast<size_t>(Stage::kDecode)].calls, 1u);
+  EXPECT_EQ(stats[static_cast<size_t>(Stage::kDecode)].frames, static_cast<uint64_t>(wav_decoded.samples_per_channel));
+  for (Stage stage : { Stage::kFramecutter, Stage::kWindowing, Stage::kSpectrum, Stage::kSpectralPeaks, Stage::kHPCP }) {
+    const StageStats& stage_stats = stats[static_cast<size_t>(stage)];
+    EXPECT_EQ(stage_stats.calls, frames) << stage_stats.stage;
+    EXPECT_EQ(stage_stats.frames, frames) << stage_stats.stage;
+    EXPECT_GT(stage_stats.output_bytes, 0u) << stage_stats.stage;
+  }
+  EXPECT_EQ(stats[static_cast<size_t>(Stage::kKeyEstimate)].calls, 1u);
+  EXPECT_EQ(stats[static_cast<size_t>(Stage::kDetectKey)].calls, 1u);
+  EXPECT_EQ(stats[static_cast<size_t>(Stage::kDetectKey)].frames, frames);
+  EXPECT_GE(stats[static_cast<size_t>(Stage::kDetectKey)].seconds, stats[static_cast<size_t>(Stage::kSpectrum)].seconds);
+}
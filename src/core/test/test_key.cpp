@@ -1,3 +1,4 @@
+#include <cmath>
 #include <string>
 #include <vector>
 
@@ -26,8 +27,7 @@ TEST(Key, EstimateKeyCMajorClassical) {
   int num_harmonics = 4;
 
   WavDecoded wav_decoded = DecodeWav(file_path);
-  std::vector<std::vector<double>> normalized_samples = wav_decoded.normalized_samples;
-  std::vector<double> mixed_audio = MonoMixer(normalized_samples);
+  std::vector<double> mixed_audio = MonoMixer(wav_decoded.normalized_samples);
 
   Framecutter framecutter(mixed_audio, 4096, 512);
 
@@ -64,7 +64,7 @@ TEST(Key, EstimateKeyCMajorClassical) {
 TEST(Key, DetectKeyCMajorClassicalWav) {
   const std::string file_path = TEST_DATA_DIR + std::string("audio_files/mozart_c_major_30sec.wav");
   WavDecoded wav_decoded = DecodeWav(file_path);
-  std::vector<std::vector<double>> normalized_samples = wav_decoded.normalized_samples;
+  const AudioBuffer& normalized_samples = wav_decoded.normalized_samples;
   double sample_rate = wav_decoded.sample_rate;
 
   KeyOutput key_output = DetectKey(normalized_samples, sample_rate, "Temperley");
@@ -81,7 +81,7 @@ TEST(Key, DetectKeyCMajorClassicalWav) {
 TEST(Key, DetectKeyCMajorClassicalMp3) {
   const std::string file_path = TEST_DATA_DIR + std::string("audio_files/mozart_c_major_30sec.mp3");
   Mp3Decoded wav_decoded = DecodeMp3(file_path);
-  std::vector<std::vector<double>> normalized_samples = wav_decoded.normalized_samples;
+  const AudioBuffer& normalized_samples = wav_decoded.normalized_samples;
   double sample_rate = wav_decoded.sample_rate;
 
   KeyOutput key_output = DetectKey(normalized_samples, sample_rate, "Temperley");
@@ -103,8 +103,7 @@ TEST(Key, EstimateKeyEbMajorEDM) {
 
   WavDecoded wav_decoded = DecodeWav(filePath);
   double sample_rate = wav_decoded.sample_rate;
-  std::vector<std::vector<double>> normalized_samples = wav_decoded.normalized_samples;
-  std::vector<double> mixed_audio = MonoMixer(normalized_samples);
+  std::vector<double> mixed_audio = MonoMixer(wav_decoded.normalized_samples);
 
   Framecutter framecutter(mixed_audio, 4096, 512);
 
@@ -134,3 +133,96 @@ TEST(Key, EstimateKeyEbMajorEDM) {
   EXPECT_NEAR(key_output.strength, 0.613304, 0.000001);
   EXPECT_NEAR(key_output.first_to_second_relative_strength, 0.516593, 0.000001);
 }
+
+/**
+ * @brief Detect Key with early stopping on a stable running estimate.
+ *
+ */
+TEST(Key, DetectKeyEarlyStopMp3) {
+  const std::string file_path = TEST_DATA_DIR + std::string("audio_files/mozart_c_major_30sec.mp3");
+  Mp3Decoded mp3_decoded = DecodeMp3(file_path);
+  const AudioBuffer& normalized_samples = mp3_decoded.normalized_samples;
+  double sample_rate = mp3_decoded.sample_rate;
+
+  KeyOutput full_key_output = DetectKey(normalized_samples, sample_rate, "Temperley");
+  KeyOutput early_key_output = DetectKey(normalized_samples, sample_rate, "Temperley", true, true, 4, 0.6, false, 36,
+                                         4096, 512, BlackmanHarris62dB, 100, .5, 100, 3, 0.05);
+
+  EXPECT_EQ(early_key_output.key, full_key_output.key);
+  EXPECT_EQ(early_key_output.scale, full_key_output.scale);
+  EXPECT_GT(early_key_output.frames_processed, 0);
+  EXPECT_EQ(early_key_output.frames_processed % 100, 0);
+  EXPECT_LT(early_key_output.frames_processed, full_key_output.frames_processed);
+}
+
+/**
+ * @brief Detect Key on audio decimated to 11025 Hz.
+ *
+ */
+TEST(Key, DetectKeyReducedSampleRateMp3) {
+  const std::string file_path = TEST_DATA_DIR + std::string("audio_files/mozart_c_major_30sec.mp3");
+  Mp3Decoded mp3_decoded = DecodeMp3(file_path);
+  const AudioBuffer& normalized_samples = mp3_decoded.normalized_samples;
+  double sample_rate = mp3_decoded.sample_rate;
+
+  KeyOutput full_key_output = DetectKey(normalized_samples, sample_rate, "Temperley");
+  KeyOutput key_output = DetectKey(normalized_samples, sample_rate, "Temperley", true, true, 4, 0.6, false, 36, 4096,
+                                   512, BlackmanHarris62dB, 100, .5, 0, 3, 0.01, 11025.);
+
+  EXPECT_EQ(key_output.key, "C");
+  EXPECT_EQ(key_output.scale, "major");
+  EXPECT_NEAR(key_output.strength, full_key_output.strength, 0.01);
+  EXPECT_NEAR(key_output.frames_processed, full_key_output.frames_processed, 1);
+}
+
+/**
+ * @brief Detect Key Eb Major EDM Mp3 on audio decimated to 11025 Hz.
+ *
+ */
+TEST(Key, DetectKeyReducedSampleRateEbMajorEDMMp3) {
+  const std::string file_path = TEST_DATA_DIR + std::string("audio_files/EDM_Eb_major_2min.mp3");
+  Mp3Decoded mp3_decoded = DecodeMp3(file_path);
+  const AudioBuffer& normalized_samples = mp3_decoded.normalized_samples;
+  double sample_rate = mp3_decoded.sample_rate;
+
+  KeyOutput key_output = DetectKey(normalized_samples, sample_rate, "Edmm", true, true, 4, 0.6, false, 36, 4096, 512,
+                                   BlackmanHarris62dB, 100, .5, 0, 3, 0.01, 11025.);
+
+  EXPECT_EQ(key_output.key, "Eb");
+}
+
+/**
+ * @brief Detect Key on mono samples decoded with mono_downmix matches the stereo path.
+ *
+ */
+TEST(Key, DetectKeyMonoDownmixMp3) {
+  const std::string file_path = TEST_DATA_DIR + std::string("audio_files/mozart_c_major_30sec.mp3");
+  Mp3Decoded mp3_decoded = DecodeMp3(file_path);
+  Mp3Decoded mono_decoded = DecodeMp3(file_path, true);
+
+  KeyOutput expected = DetectKey(mp3_decoded.normalized_samples, mp3_decoded.sample_rate, "Temperley");
+  KeyOutput actual = DetectKey(mono_decoded.normalized_samples, mono_decoded.sample_rate, "Temperley");
+
+  EXPECT_EQ(actual.key, expected.key);
+  EXPECT_EQ(actual.scale, expected.scale);
+  EXPECT_DOUBLE_EQ(actual.strength, expected.strength);
+  EXPECT_DOUBLE_EQ(actual.first_to_second_relative_strength, expected.first_to_second_relative_strength);
+  EXPECT_EQ(actual.frames_processed, expected.frames_processed);
+}
+
+/**
+ * @brief Detect Key rejects an analysis sample rate that would cut off the HPCP range.
+ *
+ */
+TEST(Key, DetectKeyAnalysisSampleRateTooLow) {
+  const double sample_rate = 44100.;
+  std::vector<double> samples(44100);
+  for (size_t i = 0; i < samples.size(); i++) samples[i] = std::sin(2. * M_PI * 261.63 * i / sample_rate);
+  const Span<const double> mono_samples(samples);
+
+  EXPECT_THROW(DetectKey(mono_samples, sample_rate, "Temperley", true, true, 4, 0.6, false, 36, 4096, 512,
+                         BlackmanHarris62dB, 100, .5, 0, 3, 0.01, 8000.),
+               std::runtime_error);
+  EXPECT_NO_THROW(DetectKey(mono_samples, sample_rate, "Temperley", true, true, 4, 0.6, false, 36, 4096, 512,
+                            BlackmanHarris62dB, 100, .5, 0, 3, 0.01, 10000.));
+}
@@ -1,5 +1,7 @@
 #include <string>
 #include <numeric>
+#include <stdexcept>
+#include <vector>
 
 #include "gtest/gtest.h"
 #include "src/core/mono_mixer.h"
@@ -27,3 +29,27 @@ TEST(MonoMixer, MonoMixer44100) {
   EXPECT_EQ(actual_mixed_audio_size, expected_mixed_audio_size);
   EXPECT_DOUBLE_EQ(actual_mixed_audio_sum, expected_mixed_audio_sum);
 }
+
+/**
+ * @brief Mixing views of the channels gives the same signal as mixing vectors.
+ *
+ */
+TEST(MonoMixer, MonoMixerSpans) {
+  const std::vector<double> left({ 1., 2., 3., 4. });
+  const std::vector<double> right({ 3., 2., 1., 0. });
+
+  std::vector<double> actual_mixed_audio = MonoMixer(std::vector<Span<const double>>({ left, right }));
+  std::vector<double> expected_mixed_audio = MonoMixer(std::vector<std::vector<double>>({ left, right }));
+
+  EXPECT_EQ(actual_mixed_audio, expected_mixed_audio);
+  EXPECT_EQ(actual_mixed_audio, std::vector<double>({ 2., 2., 2., 2. }));
+}
+
+/**
+ * @brief More than two channels can not be mixed.
+ *
+ */
+TEST(MonoMixer, MonoMixerTooManyChannels) {
+  const std::vector<double> channel({ 1., 2. });
+  EXPECT_THROW(MonoMixer(std::vector<std::vector<double>>({ channel, channel, channel })), std::runtime_error);
+}
@@ -25,6 +25,12 @@ TEST(TestUtils, GetStringBetweenSingleQuotes) {
   EXPECT_EQ(actual, expected);
 }
 
+TEST(TestUtils, JsonQuote) {
+  std::string actual = JsonQuote("dir\\\"quoted\"\n\x01.wav");
+  std::string expected = "\"dir\\\\\\\"quoted\\\"\\n\\u0001.wav\"";
+  EXPECT_EQ(actual, expected);
+}
+
 TEST(TestUtils, Deinterweave) {
   std::vector<double> interweaved_vec({ 1., 9., 2., 8., 3., 7., 4., 6. });
   std::vector<std::vector<double>> actual_deinterweaved_vectors = Deinterweave(interweaved_vec);
@@ -0,0 +1,84 @@
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "src/core/audio_decoders.h"
+#include "src/core/key.h"
+#include "src/core/onset.h"
+#include "src/core/test/gtest_extras.h"
+
+using namespace musher::core;
+
+/**
+ * @brief Spectral flux only counts bins that got louder.
+ *
+ */
+TEST(Onset, SpectralFlux) {
+  std::vector<double> previous_spectrum = { 2., 1., 3., 0. };
+  std::vector<double> spectrum = { 1., 2., 3., 0.5 };
+
+  EXPECT_DOUBLE_EQ(SpectralFlux(spectrum, previous_spectrum, 0.), 1.5);
+  EXPECT_DOUBLE_EQ(SpectralFlux(previous_spectrum, spectrum, 0.), 1.);
+  EXPECT_DOUBLE_EQ(SpectralFlux(spectrum, previous_spectrum, 10.),
+                   std::log1p(20.) - std::log1p(10.) + std::log1p(5.));
+  EXPECT_THROW(SpectralFlux(spectrum, std::vector<double>(3), 0.), std::runtime_error);
+}
+
+/**
+ * @brief The streaming envelope matches the flux of consecutive frames.
+ *
+ */
+TEST(Onset, OnsetStrengthEnvelope) {
+  std::vector<std::vector<double>> spectra = { { 0., 1., 0. }, { 1., 1., 0. }, { 0., 3., 2. }, { 0., 3., 2. } };
+
+  std::vector<double> envelope = OnsetStrengthEnvelope(spectra);
+  std::vector<double> expected_envelope = { 0., SpectralFlux(spectra[1], spectra[0]),
+                                            SpectralFlux(spectra[2], spectra[1]), 0. };
+  EXPECT_VEC_NEAR(envelope, expected_envelope, 1e-12);
+
+  OnsetStrength onset_strength(0.);
+  onset_strength.process(spectra[0]);
+  onset_strength.process(spectra[2]);
+  EXPECT_DOUBLE_EQ(onset_strength.envelope().back(), 4.);
+  EXPECT_THROW(onset_strength.process(std::vector<double>(2)), std::runtime_error);
+
+  onset_strength.reset();
+  EXPECT_TRUE(onset_strength.envelope().empty());
+}
+
+/**
+ * @brief Onsets computed from the spectra of the key pipeline line up with the impulses of the signal.
+ *
+ */
+TEST(Onset, OnsetStrengthFromDetectKey) {
+  const std::string file_path = TEST_DATA_DIR + std::string("audio_files/impulses_1second_44100.wav");
+  WavDecoded wav_decoded = DecodeWav(file_path, true);
+  Span<const double> mono_samples = wav_decoded.normalized_samples.channel(0);
+  const double sample_rate = wav_decoded.sample_rate;
+  const int hop_size = 512;
+
+  OnsetStrength onset_strength;
+  KeyOutput key_output =
+      DetectKey(mono_samples, sample_rate, "Bgate", true, true, 4, 0.6, false, 36, 4096, hop_size, BlackmanHarris62dB,
+                100, .5, 0, 3, 0.01, 0., [&onset_strength](const std::vector<double> &spectrum) {
+                  onset_strength.process(spectrum);
+                });
+
+  const std::vector<double> &envelope = onset_strength.envelope();
+  ASSERT_EQ(static_cast<int>(envelope.size()), key_output.frames_processed);
+
+  // One impulse per second.
+  double max_strength = *std::max_element(envelope.begin(), envelope.end());
+  std::vector<double> onset_times;
+  for (size_t i = 1; i + 1 < envelope.size(); i++) {
+    if (envelope[i] > envelope[i - 1] && envelope[i] >= envelope[i + 1] && envelope[i] > 0.5 * max_strength) {
+      onset_times.push_back(i * hop_size / sample_rate);
+    }
+  }
+  ASSERT_EQ(onset_times.size(), 9u);
+  for (size_t i = 0; i < onset_times.size(); i++) {
+    EXPECT_NEAR(onset_times[i], i + 1., 2. * hop_size / sample_rate);
+  }
+}
@@ -1,8 +1,13 @@
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <random>
 #include <tuple>
 #include <vector>
 
 #include "gtest/gtest.h"
 #include "src/core/peak_detect.h"
+#include "src/core/spectral_peaks.h"
 #include "src/core/test/gtest_extras.h"
 
 using namespace musher::core;
@@ -288,3 +293,79 @@ TEST(PeakDetection, QuadraticInterpolation) {
   EXPECT_NEAR(expected_peak_location, actual_peak_location, 0.00001);
   EXPECT_NEAR(expected_peak_height_estimate, actual_peak_height_estimate, 0.00001);
 }
+
+/**
+ * @brief Peaks found in a frequency range are the same as the peaks of a full scan within that range,
+ * including interpolated and flat peaks at the edges of the range.
+ *
+ */
+TEST(PeakDetection, SpectralPeaksInRangeMatchesFullScan) {
+  std::vector<double> spectrum{ 0, 1, 3, 2, 4, 4, 4, 1, 2, 5, 3, 6, 6, 2, 1, 7, 1, 0, 2, 1, 3 };
+  double sample_rate = 40.;  // 1 Hz per bin
+  double min_frequency = 5.;
+  double max_frequency = 12.;
+
+  std::vector<std::tuple<double, double>> full_peaks = SpectralPeaks(spectrum, -1000.0, "position", 0, sample_rate);
+  std::vector<std::tuple<double, double>> expected_peaks;
+  std::copy_if(full_peaks.begin(), full_peaks.end(), std::back_inserter(expected_peaks),
+               [&min_frequency, &max_frequency](auto const& peak) {
+                 return std::get<0>(peak) >= min_frequency && std::get<0>(peak) <= max_frequency;
+               });
+
+  std::vector<std::tuple<double, double>> actual_peaks =
+      SpectralPeaksInRange(spectrum, -1000.0, "position", 0, sample_rate, min_frequency, max_frequency);
+
+  ASSERT_EQ(expected_peaks.size(), 3U);
+  EXPECT_EQ(expected_peaks, actual_peaks);
+}
+
+/**
+ * @brief The candidate bitmask flags exactly the elements that rise, do not rise after and are above the threshold.
+ *
+ */
+TEST(PeakDetection, CandidatePeaks) {
+  std::mt19937 generator(42);
+  std::uniform_int_distribution<int> level(0, 4);
+  for (int size : { 2, 3, 4, 5, 63, 64, 65, 130, 257 }) {
+    std::vector<double> inp(static_cast<size_t>(size));
+    for (double& value : inp) value = level(generator);
+    for (int begin : { 0, 1 }) {
+      std::vector<uint64_t> candidates = CandidatePeaks(inp, begin, size, 1.5);
+      for (int i = 0; i < size; i++) {
+        const bool expected = i > begin && i < size - 1 && inp[i] > inp[i - 1] && inp[i] >= inp[i + 1] && inp[i] > 1.5;
+        const bool actual = (candidates[static_cast<size_t>(i) / 64] >> (i % 64)) & 1;
+        EXPECT_EQ(actual, expected) << "size " << size << ", begin " << begin << ", index " << i;
+      }
+    }
+  }
+}
+
+/**
+ * @brief Skipping to the candidates finds the same peaks as walking every element, flat peaks, edges and maximum
+ * positions included.
+ *
+ */
+TEST(PeakDetection, SkipToCandidatesMatchesWalking) {
+  std::mt19937 generator(7);
+  // Few levels, so there are many flat stretches.
+  std::uniform_int_distribution<int> level(0, 5);
+  for (int trial = 0; trial < 200; trial++) {
+    const int size = 3 + trial;
+    std::vector<double> inp(static_cast<size_t>(size));
+    for (double& value : inp) value = level(generator);
+
+    for (double threshold : { -1000., 2.5 }) {
+      for (bool interpolate : { true, false }) {
+        for (int begin : { 0, 1, size / 3 }) {
+          for (double max_pos : { static_cast<double>(size - 1), size * 0.5 }) {
+            std::vector<std::tuple<double, double>> expected_peaks =
+                ScanPeaks(inp, begin, size, threshold, interpolate, 1., max_pos, false);
+            std::vector<std::tuple<double, double>> actual_peaks =
+                ScanPeaks(inp, begin, size, threshold, interpolate, 1., max_pos, true);
+            EXPECT_EQ(actual_peaks, expected_peaks) << "size " << size << ", begin " << begin;
+          }
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,128 @@
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "src/core/audio_decoders.h"
+#include "src/core/mono_mixer.h"
+#include "src/core/resample.h"
+#include "src/core/test/gtest_extras.h"
+
+using namespace musher::core;
+
+namespace {
+
+std::vector<double> Sine(double frequency, double sample_rate, size_t size) {
+  std::vector<double> signal(size);
+  for (size_t i = 0; i < size; i++) {
+    signal[i] = std::sin(2. * M_PI * frequency * i / sample_rate);
+  }
+  return signal;
+}
+
+double RootMeanSquare(const std::vector<double> &signal, size_t begin, size_t end) {
+  double sum = 0.;
+  for (size_t i = begin; i < end; i++) sum += signal[i] * signal[i];
+  return std::sqrt(sum / (end - begin));
+}
+
+}  // namespace
+
+/**
+ * @brief Kaiser lowpass filter is symmetric and has the requested DC gain.
+ *
+ */
+TEST(Resample, KaiserLowpassFilter) {
+  std::vector<double> taps = KaiserLowpassFilter(129, 0.25, 4.);
+
+  ASSERT_EQ(taps.size(), 129u);
+  for (size_t i = 0; i < taps.size() / 2; i++) {
+    EXPECT_DOUBLE_EQ(taps[i], taps[taps.size() - 1 - i]);
+  }
+  EXPECT_NEAR(std::accumulate(taps.begin(), taps.end(), 0.), 4., 1e-3);
+  EXPECT_THROW(KaiserLowpassFilter(0, 0.5), std::runtime_error);
+  EXPECT_THROW(KaiserLowpassFilter(31, 1.5), std::runtime_error);
+}
+
+/**
+ * @brief Equal factors leave the signal untouched and the output length follows the ratio.
+ *
+ */
+TEST(Resample, OutputLength) {
+  std::vector<double> signal = Sine(440., 44100., 1001);
+
+  std::vector<double> same = Resample(signal, 3, 3);
+  EXPECT_VEC_EQ(same, signal);
+
+  EXPECT_EQ(Resample(signal, 1, 4).size(), 251u);
+  EXPECT_EQ(Resample(signal, 2, 3).size(), 668u);
+  EXPECT_EQ(Resample(signal, 3, 2).size(), 1502u);
+  EXPECT_EQ(ResampleToRate(signal, 44100., 11025.).size(), 251u);
+  EXPECT_TRUE(Resample(std::vector<double>(), 1, 4).empty());
+  EXPECT_THROW(Resample(signal, 0, 4), std::runtime_error);
+}
+
+/**
+ * @brief A tone inside the passband keeps its shape and is time aligned after integer decimation.
+ *
+ */
+TEST(Resample, DecimateKeepsPassband) {
+  const double frequency = 1000.;
+  std::vector<double> signal = Sine(frequency, 44100., 44100);
+  std::vector<double> resampled = ResampleToRate(signal, 44100., 11025.);
+  std::vector<double> expected = Sine(frequency, 11025., resampled.size());
+
+  // Skip the edges, where the filter runs off the signal.
+  for (size_t i = 200; i < resampled.size() - 200; i++) {
+    EXPECT_NEAR(resampled[i], expected[i], 1e-3) << "Differ at index " << i;
+  }
+}
+
+/**
+ * @brief A tone inside the passband keeps its shape and is time aligned after rational resampling.
+ *
+ */
+TEST(Resample, RationalRatioKeepsPassband) {
+  const double frequency = 440.;
+  std::vector<double> signal = Sine(frequency, 48000., 48000);
+  std::vector<double> resampled = ResampleToRate(signal, 48000., 11025.);
+  std::vector<double> expected = Sine(frequency, 11025., resampled.size());
+
+  ASSERT_EQ(resampled.size(), 11025u);
+  for (size_t i = 200; i < resampled.size() - 200; i++) {
+    EXPECT_NEAR(resampled[i], expected[i], 1e-3) << "Differ at index " << i;
+  }
+}
+
+/**
+ * @brief Content above the new Nyquist frequency is removed instead of aliasing.
+ *
+ */
+TEST(Resample, DecimateRejectsAliases) {
+  // 9 kHz would alias to 2025 Hz at 11025 Hz.
+  std::vector<double> signal = Sine(9000., 44100., 44100);
+  std::vector<double> resampled = ResampleToRate(signal, 44100., 11025.);
+
+  double rms = RootMeanSquare(resampled, 200, resampled.size() - 200);
+  EXPECT_LT(rms, 1e-3);
+}
+
+/**
+ * @brief Decimating a decoded file keeps the low frequency content.
+ *
+ */
+TEST(Resample, DecimateMp3) {
+  const std::string file_path = TEST_DATA_DIR + std::string("audio_files/mozart_c_major_30sec.mp3");
+  Mp3Decoded mp3_decoded = DecodeMp3(file_path);
+  std::vector<double> mixed_audio = MonoMixer(mp3_decoded.normalized_samples);
+  std::vector<double> resampled = ResampleToRate(mixed_audio, mp3_decoded.sample_rate, 11025.);
+
+  EXPECT_EQ(resampled.size(), (mixed_audio.size() + 3) / 4);
+
+  // Solo piano has next to no energy above 5.5 kHz, so the loudness has to survive decimation.
+  double original_rms = RootMeanSquare(mixed_audio, 0, mixed_audio.size());
+  double resampled_rms = RootMeanSquare(resampled, 0, resampled.size());
+  EXPECT_NEAR(resampled_rms / original_rms, 1., 0.02);
+}
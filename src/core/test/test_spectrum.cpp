@@ -1,3 +1,7 @@
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
 #include "gtest/gtest.h"
 #include "src/core/spectrum.h"
 #include "src/core/test/gtest_extras.h"
@@ -34,4 +38,71 @@ TEST(Spectrum, Magnitude) {
   double actual_magnitude = Magnitude(complex_pair);
 
   EXPECT_DOUBLE_EQ(expected_magnitude, actual_magnitude);
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Band limited frequency spectrum only computes the requested bins.
+ *
+ */
+TEST(Spectrum, BandLimitedFrequencySpectrum) {
+  std::vector<double> inp(256);
+  for (size_t i = 0; i < inp.size(); i++) {
+    inp[i] = std::sin(0.3 * i) + 0.5 * std::cos(1.1 * i);
+  }
+
+  std::vector<double> full_out = ConvertToFrequencySpectrum(inp);
+  std::vector<double> actual_out = ConvertToFrequencySpectrum(inp, 10, 40);
+
+  std::vector<double> expected_out(full_out.size(), 0.0);
+  std::copy(full_out.begin() + 10, full_out.begin() + 41, expected_out.begin() + 10);
+
+  EXPECT_EQ(FrequencySpectrumSize(inp.size()), full_out.size());
+  EXPECT_VEC_EQ(expected_out, actual_out);
+}
+
+/**
+ * @brief Batched spectra match the spectrum of every frame, for any number of threads.
+ *
+ */
+TEST(Spectrum, ConvertToFrequencySpectra) {
+  std::vector<std::vector<double>> frames(13, std::vector<double>(101));
+  for (size_t i = 0; i < frames.size(); i++) {
+    for (size_t j = 0; j < frames[i].size(); j++) frames[i][j] = std::sin(.1 * static_cast<double>(i * j + j));
+  }
+
+  for (const unsigned int num_threads : { 1u, 3u, 0u }) {
+    std::vector<std::vector<double>> spectra = ConvertToFrequencySpectra(frames, num_threads);
+    ASSERT_EQ(spectra.size(), frames.size());
+    for (size_t frame = 0; frame < frames.size(); frame++) {
+      std::vector<double> expected_spectrum = ConvertToFrequencySpectrum(frames[frame]);
+      EXPECT_VEC_NEAR(spectra[frame], expected_spectrum, 1e-10);
+    }
+  }
+
+  frames.back().pop_back();
+  EXPECT_THROW(ConvertToFrequencySpectra(frames), std::runtime_error);
+}
+
+/**
+ * @brief Planar spectra hold the spectrum of every frame, row after row.
+ *
+ */
+TEST(Spectrum, ConvertToFrequencySpectraPlanar) {
+  std::vector<std::vector<double>> frames(13, std::vector<double>(101));
+  for (size_t i = 0; i < frames.size(); i++) {
+    for (size_t j = 0; j < frames[i].size(); j++) frames[i][j] = std::sin(.1 * static_cast<double>(i * j + j));
+  }
+  const std::vector<Span<const double>> frame_spans(frames.begin(), frames.end());
+  const size_t spectrum_size = FrequencySpectrumSize(frames[0].size());
+
+  for (const unsigned int num_threads : { 1u, 3u }) {
+    std::vector<double> spectra = ConvertToFrequencySpectraPlanar(frame_spans, num_threads);
+    ASSERT_EQ(spectra.size(), frames.size() * spectrum_size);
+    for (size_t frame = 0; frame < frames.size(); frame++) {
+      std::vector<double> expected_spectrum = ConvertToFrequencySpectrum(frames[frame]);
+      std::vector<double> actual_spectrum(spectra.begin() + frame * spectrum_size,
+                                          spectra.begin() + (frame + 1) * spectrum_size);
+      EXPECT_VEC_NEAR(actual_spectrum, expected_spectrum, 1e-10);
+    }
+  }
+}
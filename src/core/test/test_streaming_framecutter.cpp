@@ -0,0 +1,96 @@
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "src/core/framecutter.h"
+#include "src/core/streaming_framecutter.h"
+#include "src/core/test/gtest_extras.h"
+
+using namespace musher::core;
+using namespace musher::core::test;
+
+namespace {
+
+/**
+ * @brief Frames of a stream pushed block_size samples at a time, flushed at the end.
+ */
+std::vector<std::vector<double>> StreamFrames(StreamingFramecutter &framecutter,
+                                              const std::vector<double> &signal,
+                                              size_t block_size) {
+  std::vector<std::vector<double>> frames;
+  auto on_frame = [&frames](Span<const double> frame) { frames.emplace_back(frame.begin(), frame.end()); };
+  for (size_t begin = 0; begin < signal.size(); begin += block_size) {
+    const size_t size = std::min(block_size, signal.size() - begin);
+    framecutter.push(Span<const double>(signal.data() + begin, size), on_frame);
+  }
+  framecutter.flush(on_frame);
+  return frames;
+}
+
+}  // namespace
+
+/**
+ * @brief A stream gives the same frames as a Framecutter over the whole signal, however it is split into blocks.
+ *
+ */
+TEST(StreamingFramecutter, MatchesFramecutter) {
+  for (size_t signal_size : { 0, 1, 5, 8, 50, 1000 }) {
+    std::vector<double> signal(signal_size);
+    std::iota(signal.begin(), signal.end(), 1.);
+    for (int frame_size : { 1, 7, 8 }) {
+      for (int hop_size : { 1, 3, 8, 11 }) {
+        for (bool start_from_center : { true, false }) {
+          Framecutter framecutter(signal, frame_size, hop_size, start_from_center);
+          std::vector<std::vector<double>> expected_frames;
+          for (const std::vector<double> &frame : framecutter) expected_frames.push_back(frame);
+
+          StreamingFramecutter streaming_framecutter(frame_size, hop_size, start_from_center);
+          for (size_t block_size : { 1, 6, 256 }) {
+            std::vector<std::vector<double>> actual_frames = StreamFrames(streaming_framecutter, signal, block_size);
+            EXPECT_MATRIX_EQ(actual_frames, expected_frames);
+          }
+        }
+      }
+    }
+  }
+}
+
+/**
+ * @brief Frames are handed out as soon as their last sample is pushed.
+ *
+ */
+TEST(StreamingFramecutter, EmitsAsSamplesArrive) {
+  StreamingFramecutter framecutter(4, 2, false);
+  std::vector<std::vector<double>> frames;
+  auto on_frame = [&frames](Span<const double> frame) { frames.emplace_back(frame.begin(), frame.end()); };
+
+  EXPECT_EQ(framecutter.push(std::vector<double>({ 1., 2., 3. }), on_frame), 0u);
+  EXPECT_EQ(framecutter.push(std::vector<double>({ 4. }), on_frame), 1u);
+  EXPECT_EQ(framecutter.push(std::vector<double>({ 5., 6., 7., 8. }), on_frame), 2u);
+  EXPECT_EQ(framecutter.num_samples(), 8);
+
+  std::vector<std::vector<double>> expected_frames({ { 1., 2., 3., 4. }, { 3., 4., 5., 6. }, { 5., 6., 7., 8. } });
+  EXPECT_MATRIX_EQ(frames, expected_frames);
+
+  // The frame reaching the end of the stream was already complete, so there is nothing left to flush.
+  EXPECT_EQ(framecutter.flush(on_frame), 0u);
+  EXPECT_EQ(framecutter.num_samples(), 0);
+  EXPECT_THROW(StreamingFramecutter(0, 2), std::runtime_error);
+  EXPECT_THROW(StreamingFramecutter(4, 0), std::runtime_error);
+}
+
+/**
+ * @brief Pushing 256 sample callbacks never allocates.
+ *
+ */
+TEST(StreamingFramecutter, PushDoesNotAllocate) {
+  StreamingFramecutter framecutter(4096, 1024);
+  std::vector<double> block(256, 0.25);
+  double sum = 0.;
+  auto on_frame = [&sum](Span<const double> frame) { sum += frame[frame.size() - 1]; };
+  auto process_block = [&framecutter, &block, &on_frame](size_t) { framecutter.push(block, on_frame); };
+  EXPECT_NO_ALLOCATIONS_PER_FRAME(0, 64, process_block);
+  EXPECT_EQ(sum, 0.25 * 15);
+}
@@ -0,0 +1,52 @@
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "src/core/threading.h"
+
+using namespace musher::core;
+
+/**
+ * @brief A per call number of threads overrides the library default, 0 falls back to it.
+ *
+ */
+TEST(Threading, NumThreads) {
+  const unsigned int previous_num_threads = GetNumThreads();
+
+  SetNumThreads(3);
+  EXPECT_EQ(GetNumThreads(), 3u);
+  EXPECT_EQ(ResolveNumThreads(0), 3u);
+  EXPECT_EQ(ResolveNumThreads(5), 5u);
+
+  SetNumThreads(0);
+  EXPECT_EQ(GetNumThreads(), std::max(1u, std::thread::hardware_concurrency()));
+
+  SetNumThreads(previous_num_threads);
+}
+
+/**
+ * @brief Every item is visited exactly once, whatever the number of threads.
+ *
+ */
+TEST(Threading, ParallelFor) {
+  for (const unsigned int num_threads : { 1u, 2u, 3u, 8u, 64u }) {
+    std::vector<std::atomic<int>> visits(50);
+    for (std::atomic<int>& visit : visits) visit = 0;
+    std::atomic<int> num_ranges(0);
+
+    ParallelFor(visits.size(), num_threads, [&](size_t begin, size_t end) {
+      num_ranges += 1;
+      for (size_t i = begin; i < end; i++) visits[i] += 1;
+    });
+    for (const std::atomic<int>& visit : visits) EXPECT_EQ(visit, 1);
+    EXPECT_EQ(num_ranges, static_cast<int>(std::min<size_t>(num_threads, visits.size())));
+  }
+
+  EXPECT_THROW(ParallelFor(10, 4,
+                           [](size_t begin, size_t) {
+                             if (begin > 0) throw std::runtime_error("range failed");
+                           }),
+               std::runtime_error);
+}
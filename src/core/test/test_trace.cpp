@@ -0,0 +1,193 @@
+#include <chrono>
+#include <cmath>
+#include <future>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "src/core/batch.h"
+#include "src/core/instrumentation.h"
+#include "src/core/key.h"
+#include "src/core/trace.h"
+
+using namespace musher::core;
+
+/**
+ * @brief Every thread records into its own buffer and gets its own tid in the trace.
+ *
+ */
+TEST(Trace, RecordsPerThread) {
+  std::shared_ptr<Tracer> tracer = std::make_shared<Tracer>();
+  SetTracer(tracer);
+  auto record_file = [&tracer](const std::string& file_path) {
+    TraceFileScope trace_file(file_path);
+    const auto begin = std::chrono::steady_clock::now();
+    tracer->record(Stage::kDecode, begin, begin + std::chrono::microseconds(1500));
+    tracer->record(Stage::kHPCP, begin + std::chrono::microseconds(1500), begin + std::chrono::microseconds(2000));
+  };
+  std::thread first_thread(record_file, "first.wav");
+  first_thread.join();
+  std::thread second_thread(record_file, "dir\\second \"quoted\".mp3");
+  second_thread.join();
+  SetTracer(nullptr);
+
+  EXPECT_EQ(tracer->num_events(), 4u);
+  std::ostringstream output;
+  EXPECT_EQ(tracer->write_json(output), 4u);
+  const std::string json = output.str();
+
+  EXPECT_EQ(json.find("{\"displayTimeUnit\":\"ms\",\"traceEvents\":["), 0u);
+  EXPECT_NE(json.find("\"name\":\"decode\",\"cat\":\"musher\",\"ph\":\"X\""), std::string::npos);
+  EXPECT_NE(json.find("\"dur\":1500.000,\"pid\":1,\"tid\":1,\"args\":{\"file\":\"first.wav\"}"), std::string::npos);
+  EXPECT_NE(json.find("\"dur\":500.000,\"pid\":1,\"tid\":2,\"args\":{\"file\":\"dir\\\\second \\\"quoted\\\".mp3\"}"),
+            std::string::npos);
+  EXPECT_NE(json.find("\"ph\":\"M\",\"pid\":1,\"tid\":2"), std::string::npos);
+  EXPECT_EQ(json.find("\"tid\":3"), std::string::npos);
+}
+
+/**
+ * @brief File scopes nest and only label events while a tracer is set.
+ *
+ */
+TEST(Trace, FileScope) {
+  TraceFileScope untraced_file("untraced.wav");
+  std::shared_ptr<Tracer> tracer = std::make_shared<Tracer>();
+  SetTracer(tracer);
+  const auto now = std::chrono::steady_clock::now();
+  {
+    TraceFileScope outer_file("outer.wav");
+    {
+      TraceFileScope inner_file("inner.wav");
+      tracer->record(Stage::kSpectrum, now, now);
+    }
+    tracer->record(Stage::kWindowing, now, now);
+  }
+  tracer->record(Stage::kKeyEstimate, now, now);
+  SetTracer(nullptr);
+
+  std::ostringstream output;
+  tracer->write_json(output);
+  const std::string json = output.str();
+  EXPECT_NE(json.find("\"name\":\"spectrum\",\"cat\":\"musher\",\"ph\":\"X\",\"ts\":"), std::string::npos);
+  EXPECT_NE(json.find("\"tid\":1,\"args\":{\"file\":\"inner.wav\"}"), std::string::npos);
+  EXPECT_NE(json.find("\"tid\":1,\"args\":{\"file\":\"outer.wav\"}"), std::string::npos);
+  EXPECT_NE(json.find("\"name\":\"key_estimate\""), std::string::npos);
+  EXPECT_EQ(json.find("untraced.wav"), std::string::npos);
+}
+
+/**
+ * @brief DetectKeyBatch traces every file on the worker that analysed it when instrumentation is compiled in, and
+ * nothing otherwise.
+ *
+ */
+TEST(Trace, DetectKeyBatchTimeline) {
+  const std::string file_path = TEST_DATA_DIR + std::string("audio_files/impulses_1second_44100.wav");
+  const std::vector<std::string> file_paths({ file_path, file_path, file_path, file_path });
+  std::shared_ptr<Tracer> tracer = std::make_shared<Tracer>();
+  SetTracer(tracer);
+  std::vector<KeyBatchResult> results = DetectKeyBatch(file_paths, 2);
+  SetTracer(nullptr);
+
+  for (const KeyBatchResult& result : results) ASSERT_TRUE(result.ok) << result.error;
+  if (!InstrumentationCompiled()) {
+    EXPECT_EQ(tracer->num_events(), 0u);
+    return;
+  }
+
+  std::ostringstream output;
+  tracer->write_json(output);
+  const std::string json = output.str();
+  for (const char* stage : { "decode", "framecutter", "windowing", "spectrum", "spectral_peaks", "hpcp",
+                             "key_estimate", "detect_key" }) {
+    EXPECT_NE(json.find("\"name\":\"" + std::string(stage) + "\""), std::string::npos) << stage;
+  }
+  EXPECT_NE(json.find("\"args\":{\"file\":\"" + file_path + "\"}"), std::string::npos);
+
+  size_t num_detect_key = 0;
+  for (size_t pos = json.find("\"name\":\"detect_key\""); pos != std::string::npos;
+       pos = json.find("\"name\":\"detect_key\"", pos + 1)) {
+    num_detect_key++;
+  }
+  EXPECT_EQ(num_detect_key, file_paths.size());
+}
+
+/**
+ * @brief A trace can be stopped and its tracer released while another thread is analysing, the analysis keeps the
+ * tracer alive until it is done with it.
+ *
+ */
+TEST(Trace, StopWhileAnalysing) {
+  const double pi = std::acos(-1.);
+  std::vector<double> signal(44100);
+  for (size_t i = 0; i < signal.size(); i++) signal[i] = std::sin(2. * pi * 440. * static_cast<double>(i) / 44100.);
+
+  std::shared_ptr<Tracer> tracer = std::make_shared<Tracer>();
+  std::weak_ptr<Tracer> weak_tracer = tracer;
+  SetTracer(tracer);
+
+  std::promise<void> analysing;
+  std::promise<void> released;
+  std::shared_future<void> released_future = released.get_future().share();
+  std::thread worker([&signal, &analysing, released_future] {
+    TraceFileScope trace_file("worker.wav");
+    DetectKey(signal, 44100.);
+    analysing.set_value();
+    // Runs while the trace is stopped and written.
+    DetectKey(signal, 44100.);
+    released_future.wait();
+  });
+
+  analysing.get_future().wait();
+  SetTracer(nullptr);
+  std::ostringstream output;
+  tracer->write_json(output);
+  tracer.reset();
+  // The file scope of the worker is still open.
+  EXPECT_FALSE(weak_tracer.expired());
+  released.set_value();
+  worker.join();
+  EXPECT_TRUE(weak_tracer.expired());
+
+  if (InstrumentationCompiled()) {
+    EXPECT_NE(output.str().find("\"args\":{\"file\":\"worker.wav\"}"), std::string::npos);
+  }
+}
+
+/**
+ * @brief Events spill over into new chunks, and the trace can be written while a thread is still recording.
+ *
+ */
+TEST(Trace, WriteWhileRecording) {
+  const size_t num_events = 3 * Tracer::EventChunk::kCapacity + 7;
+  std::shared_ptr<Tracer> tracer = std::make_shared<Tracer>();
+  SetTracer(tracer);
+  std::thread recorder([&tracer, num_events] {
+    TraceFileScope trace_file("recorder.wav");
+    const auto now = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < num_events; i++) tracer->record(Stage::kSpectrum, now, now);
+  });
+  size_t previous_num_written = 0;
+  for (int i = 0; i < 20; i++) {
+    std::ostringstream output;
+    const size_t num_written = tracer->write_json(output);
+    EXPECT_GE(num_written, previous_num_written);
+    EXPECT_LE(num_written, num_events);
+    previous_num_written = num_written;
+  }
+  recorder.join();
+  SetTracer(nullptr);
+
+  EXPECT_EQ(tracer->num_events(), num_events);
+  std::ostringstream output;
+  EXPECT_EQ(tracer->write_json(output), num_events);
+  const std::string json = output.str();
+  size_t num_labelled = 0;
+  for (size_t pos = json.find("\"file\":\"recorder.wav\""); pos != std::string::npos;
+       pos = json.find("\"file\":\"recorder.wav\"", pos + 1)) {
+    num_labelled++;
+  }
+  EXPECT_EQ(num_labelled, num_events);
+}
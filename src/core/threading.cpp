@@ -0,0 +1,65 @@
+#include "src/core/threading.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace musher {
+namespace core {
+
+namespace {
+
+std::atomic<unsigned int> default_num_threads(0);
+
+unsigned int HardwareThreads() { return std::max(1u, std::thread::hardware_concurrency()); }
+
+}  // namespace
+
+void SetNumThreads(unsigned int num_threads) { default_num_threads = num_threads; }
+
+unsigned int GetNumThreads() {
+  const unsigned int num_threads = default_num_threads;
+  return num_threads == 0 ? HardwareThreads() : num_threads;
+}
+
+unsigned int ResolveNumThreads(unsigned int num_threads) { return num_threads == 0 ? GetNumThreads() : num_threads; }
+
+void ParallelFor(size_t count, unsigned int num_threads, const std::function<void(size_t, size_t)> &body) {
+  if (count == 0) return;
+  const size_t num_ranges = std::min<size_t>(ResolveNumThreads(num_threads), count);
+  if (num_ranges == 1) {
+    body(0, count);
+    return;
+  }
+
+  std::exception_ptr first_exception;
+  std::mutex exception_mutex;
+  auto run_range = [&](size_t range) {
+    // The first count % num_ranges ranges get one extra item.
+    const size_t base = count / num_ranges;
+    const size_t extra = count % num_ranges;
+    const size_t begin = range * base + std::min(range, extra);
+    const size_t end = begin + base + (range < extra ? 1 : 0);
+    try {
+      body(begin, end);
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(exception_mutex);
+      if (!first_exception) first_exception = std::current_exception();
+    }
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(num_ranges - 1);
+  for (size_t range = 1; range < num_ranges; range++) threads.emplace_back(run_range, range);
+  run_range(0);
+  for (std::thread &thread : threads) thread.join();
+
+  if (first_exception) std::rethrow_exception(first_exception);
+}
+
+}  // namespace core
+}  // namespace musher
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+
+namespace musher {
+namespace core {
+
+/**
+ * @brief Set the number of threads parallel functions use when they are not given one.
+ *
+ * This is the library wide default for every function with a `num_threads` parameter (0 meaning "use the default"),
+ * such as ConvertToFrequencySpectra and DetectKeyBatch. It can be changed at any time, calls already running keep the
+ * value they started with.
+ *
+ * @param num_threads Number of threads (set to 0 to use the number of hardware threads).
+ */
+void SetNumThreads(unsigned int num_threads);
+
+/**
+ * @brief Number of threads parallel functions use when they are not given one.
+ *
+ * @return unsigned int Default number of threads, at least 1.
+ */
+unsigned int GetNumThreads();
+
+/**
+ * @brief Resolve a per call number of threads against the library default.
+ *
+ * @param num_threads Number of threads requested by the caller (set to 0 to use GetNumThreads).
+ * @return unsigned int Number of threads to use, at least 1.
+ */
+unsigned int ResolveNumThreads(unsigned int num_threads);
+
+/**
+ * @brief Run body over [0, count) split into one contiguous range per thread.
+ *
+ * The calling thread runs the first range itself, so a single thread (or a single item) runs inline without spawning
+ * anything. If any range throws, the first exception is rethrown once every thread has finished.
+ *
+ * @param count Number of items.
+ * @param num_threads Number of threads (set to 0 to use GetNumThreads). Never more threads than items are used.
+ * @param body Function called with the [begin, end) range of items of one thread.
+ */
+void ParallelFor(size_t count, unsigned int num_threads, const std::function<void(size_t, size_t)> &body);
+
+}  // namespace core
+}  // namespace musher
@@ -0,0 +1,178 @@
+#include "src/core/trace.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "src/core/utils.h"
+
+namespace musher {
+namespace core {
+
+namespace {
+
+// Only read and written through std::atomic_load and std::atomic_store. The flag lets stages skip that when there is
+// no tracer, which is almost always.
+std::shared_ptr<Tracer> tracer;
+std::atomic<bool> tracing(false);
+std::atomic<uint64_t> next_tracer_id(1);
+
+/**
+ * @brief Buffer the calling thread last used, tracer ids are never reused so a stale entry can not match.
+ *
+ */
+struct CachedThreadBuffer {
+  uint64_t tracer_id = 0;
+  Tracer::ThreadBuffer *buffer = nullptr;
+};
+
+thread_local CachedThreadBuffer cached_thread_buffer;
+
+/**
+ * @brief Write a time in nanoseconds as the microseconds the trace format expects.
+ */
+void WriteMicroseconds(std::ostream &output, int64_t nanoseconds) {
+  const int64_t fraction = nanoseconds % 1000;
+  output << nanoseconds / 1000 << '.' << fraction / 100 << fraction / 10 % 10 << fraction % 10;
+}
+
+}  // namespace
+
+constexpr size_t Tracer::EventChunk::kCapacity;
+
+Tracer::ThreadBuffer::~ThreadBuffer() {
+  EventChunk *chunk = first_chunk.next.load(std::memory_order_relaxed);
+  while (chunk) {
+    EventChunk *next = chunk->next.load(std::memory_order_relaxed);
+    delete chunk;
+    chunk = next;
+  }
+}
+
+Tracer::Tracer() : id_(next_tracer_id.fetch_add(1)), origin_(std::chrono::steady_clock::now()) {}
+
+Tracer::ThreadBuffer &Tracer::thread_buffer() {
+  CachedThreadBuffer &cached = cached_thread_buffer;
+  if (cached.tracer_id == id_) return *cached.buffer;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::unique_ptr<ThreadBuffer> buffer(new ThreadBuffer());
+  buffer->thread_id = static_cast<int>(buffers_.size()) + 1;
+  buffers_.push_back(std::move(buffer));
+  cached.tracer_id = id_;
+  cached.buffer = buffers_.back().get();
+  return *cached.buffer;
+}
+
+void Tracer::record(Stage stage, std::chrono::steady_clock::time_point begin,
+                    std::chrono::steady_clock::time_point end) {
+  ThreadBuffer &buffer = thread_buffer();
+  Event event;
+  event.stage = stage;
+  event.begin_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(begin - origin_).count();
+  event.end_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - origin_).count();
+  event.label = buffer.current_label;
+
+  // Only this thread writes to the chunk, so its own size needs no synchronisation. The release stores make the new
+  // chunk and the event visible to write_json once it sees them.
+  EventChunk *chunk = buffer.last_chunk;
+  size_t size = chunk->size.load(std::memory_order_relaxed);
+  if (size == EventChunk::kCapacity) {
+    EventChunk *next = new EventChunk();
+    chunk->next.store(next, std::memory_order_release);
+    buffer.last_chunk = chunk = next;
+    size = 0;
+  }
+  chunk->events[size] = event;
+  chunk->size.store(size + 1, std::memory_order_release);
+}
+
+size_t Tracer::num_events() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  size_t num_events = 0;
+  for (const std::unique_ptr<ThreadBuffer> &buffer : buffers_) {
+    for (const EventChunk *chunk = &buffer->first_chunk; chunk; chunk = chunk->next.load(std::memory_order_acquire)) {
+      num_events += chunk->size.load(std::memory_order_acquire);
+    }
+  }
+  return num_events;
+}
+
+size_t Tracer::write_json(std::ostream &output) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  output << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+  bool first = true;
+  size_t num_events = 0;
+  for (const std::unique_ptr<ThreadBuffer> &buffer : buffers_) {
+    // Labels an event refers to were added before the event was published.
+    std::lock_guard<std::mutex> labels_lock(buffer->labels_mutex);
+    // Name the thread so viewers show "worker N" instead of a bare id.
+    output << (first ? "\n" : ",\n");
+    first = false;
+    output << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->thread_id
+           << ",\"args\":{\"name\":\"worker " << buffer->thread_id << "\"}}";
+
+    for (const EventChunk *chunk = &buffer->first_chunk; chunk; chunk = chunk->next.load(std::memory_order_acquire)) {
+      const size_t size = chunk->size.load(std::memory_order_acquire);
+      for (size_t i = 0; i < size; i++) {
+        const Event &event = chunk->events[i];
+        output << ",\n{\"name\":\"" << StageName(event.stage) << "\",\"cat\":\"musher\",\"ph\":\"X\",\"ts\":";
+        WriteMicroseconds(output, event.begin_ns);
+        output << ",\"dur\":";
+        WriteMicroseconds(output, event.end_ns - event.begin_ns);
+        output << ",\"pid\":1,\"tid\":" << buffer->thread_id;
+        if (event.label >= 0) {
+          output << ",\"args\":{\"file\":";
+          output << JsonQuote(buffer->labels[static_cast<size_t>(event.label)]);
+          output << "}";
+        }
+        output << "}";
+      }
+      num_events += size;
+    }
+  }
+  output << "\n]}\n";
+  return num_events;
+}
+
+size_t Tracer::write_json(const std::string &file_path) const {
+  std::ofstream output(file_path);
+  if (!output) throw std::runtime_error("Could not open trace file for writing: " + file_path);
+  const size_t num_events = write_json(output);
+  if (!output) throw std::runtime_error("Could not write trace file: " + file_path);
+  return num_events;
+}
+
+void SetTracer(std::shared_ptr<Tracer> new_tracer) {
+  tracing = static_cast<bool>(new_tracer);
+  std::atomic_store(&tracer, std::move(new_tracer));
+}
+
+std::shared_ptr<Tracer> GetTracer() {
+  if (!tracing.load(std::memory_order_acquire)) return nullptr;
+  return std::atomic_load(&tracer);
+}
+
+TraceFileScope::TraceFileScope(const std::string &file_path)
+    : tracer_(GetTracer()), buffer_(nullptr), previous_label_(-1) {
+  if (!tracer_) return;
+  buffer_ = &tracer_->thread_buffer();
+  previous_label_ = buffer_->current_label;
+  std::lock_guard<std::mutex> lock(buffer_->labels_mutex);
+  buffer_->labels.push_back(file_path);
+  buffer_->current_label = static_cast<int>(buffer_->labels.size()) - 1;
+}
+
+TraceFileScope::~TraceFileScope() {
+  if (buffer_) buffer_->current_label = previous_label_;
+}
+
+}  // namespace core
+}  // namespace musher
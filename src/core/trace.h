@@ -0,0 +1,164 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "src/core/instrumentation.h"
+
+namespace musher {
+namespace core {
+
+/**
+ * @brief Records a timeline of the instrumented stages and writes it as a Chrome trace (chrome://tracing, Perfetto).
+ *
+ * Every thread appends to its own buffer of fixed size event chunks and publishes each event with a release store of
+ * the chunk size, so recording takes no lock. Writing the trace reads up to the published sizes and can run while
+ * threads are still recording. Events are labelled with the file being analysed (see TraceFileScope) and the thread
+ * that ran them. File labels are the only part under a lock, taken once per file scope rather than per event.
+ *
+ * Stages are only traced when the library is built with MUSHER_INSTRUMENTATION, like the statistics of
+ * InstrumentationSink.
+ *
+ * Stages that are running and file scopes that are open share ownership of the tracer. So a trace can be stopped and
+ * its tracer released while other threads are still analysing. Those threads keep recording into the tracer until
+ * they finish with it.
+ *
+ * @code
+ *   std::shared_ptr<Tracer> tracer = std::make_shared<Tracer>();
+ *   SetTracer(tracer);
+ *   DetectKeyBatch(file_paths);
+ *   SetTracer(nullptr);
+ *   tracer->write_json("trace.json");
+ * @endcode
+ */
+class Tracer {
+ public:
+  /**
+   * @brief A single run of a stage.
+   *
+   */
+  struct Event {
+    Stage stage;
+    int64_t begin_ns;  //!< Start time, relative to the creation of the tracer \[ns\].
+    int64_t end_ns;    //!< End time, relative to the creation of the tracer \[ns\].
+    int label;         //!< Index of the file label in the thread buffer, -1 if none.
+  };
+
+  /**
+   * @brief Fixed size block of events. Only the owning thread writes to it, events below size are published.
+   *
+   */
+  struct EventChunk {
+    static constexpr size_t kCapacity = 512;
+
+    Event events[kCapacity];
+    std::atomic<size_t> size{ 0 };              //!< Number of published events, stored with release.
+    std::atomic<EventChunk *> next{ nullptr };  //!< Chunk after this one once it is full, stored with release.
+  };
+
+  /**
+   * @brief Events of one thread, a list of chunks only ever appended to by that thread.
+   *
+   */
+  struct ThreadBuffer {
+    int thread_id;
+    EventChunk first_chunk;
+    EventChunk *last_chunk = &first_chunk;  //!< Only used by the owning thread.
+    int current_label = -1;                 //!< Only used by the owning thread.
+    std::mutex labels_mutex;                //!< Guards labels against write_json.
+    std::vector<std::string> labels;
+
+    ThreadBuffer() = default;
+    ThreadBuffer(const ThreadBuffer &) = delete;
+    ThreadBuffer &operator=(const ThreadBuffer &) = delete;
+    ~ThreadBuffer();
+  };
+
+ private:
+  const uint64_t id_;
+  const std::chrono::steady_clock::time_point origin_;
+  mutable std::mutex mutex_;
+  std::vector<std::unique_ptr<ThreadBuffer>> buffers_;
+
+ public:
+  Tracer();
+  Tracer(const Tracer &) = delete;
+  Tracer &operator=(const Tracer &) = delete;
+
+  /**
+   * @brief Buffer of the calling thread, created on its first call.
+   */
+  ThreadBuffer &thread_buffer();
+
+  /**
+   * @brief Record a stage that ran on the calling thread.
+   *
+   * @param stage Stage that ran.
+   * @param begin Time it started.
+   * @param end Time it ended.
+   */
+  void record(Stage stage, std::chrono::steady_clock::time_point begin, std::chrono::steady_clock::time_point end);
+
+  /**
+   * @brief Number of events recorded by every thread.
+   */
+  size_t num_events() const;
+
+  /**
+   * @brief Write every event in the Chrome trace event JSON format.
+   *
+   * Can be called while other threads are still recording, it writes the events recorded so far.
+   *
+   * @param output Stream to write to.
+   * @return size_t Number of events written.
+   */
+  size_t write_json(std::ostream &output) const;
+
+  /**
+   * @brief Overloaded write_json that writes to a file.
+   *
+   * @param file_path Path of the .json file to create.
+   * @return size_t Number of events written.
+   */
+  size_t write_json(const std::string &file_path) const;
+};
+
+/**
+ * @brief Set the tracer instrumented stages record into.
+ *
+ * @param tracer Tracer to record into (set to nullptr to stop tracing). Calls that started recording into it keep it
+ * alive until they are done.
+ */
+void SetTracer(std::shared_ptr<Tracer> tracer);
+
+/**
+ * @brief Tracer instrumented stages currently record into, nullptr if none.
+ */
+std::shared_ptr<Tracer> GetTracer();
+
+/**
+ * @brief Labels the events the calling thread records while it exists with a file name, such as the file a batch
+ * worker is analysing. Scopes nest, the previous label is restored on destruction.
+ */
+class TraceFileScope {
+ private:
+  std::shared_ptr<Tracer> tracer_;
+  Tracer::ThreadBuffer *buffer_;
+  int previous_label_;
+
+ public:
+  explicit TraceFileScope(const std::string &file_path);
+  ~TraceFileScope();
+  TraceFileScope(const TraceFileScope &) = delete;
+  TraceFileScope &operator=(const TraceFileScope &) = delete;
+};
+
+}  // namespace core
+}  // namespace musher
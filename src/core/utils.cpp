@@ -40,7 +40,36 @@ std::string StrBetweenSQuotes(const std::string &s) {
   return s.substr(pos, len);
 }
 
-int16_t TwoBytesToInt(const std::vector<uint8_t> &source, const int startIndex) {
+std::string JsonQuote(const std::string &s) {
+  std::stringstream ss;
+  ss << '"';
+  for (const char c : s) {
+    switch (c) {
+      case '"':
+        ss << "\\\"";
+        break;
+      case '\\':
+        ss << "\\\\";
+        break;
+      case '\n':
+        ss << "\\n";
+        break;
+      case '\t':
+        ss << "\\t";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          ss << "\\u" << std::hex << std::setfill('0') << std::setw(4) << static_cast<unsigned>(c) << std::dec;
+        } else {
+          ss << c;
+        }
+    }
+  }
+  ss << '"';
+  return ss.str();
+}
+
+int16_t TwoBytesToInt(Span<const uint8_t> source, const int startIndex) {
   int16_t result;
 
   if (!IsBigEndian())
@@ -51,7 +80,7 @@ int16_t TwoBytesToInt(const std::vector<uint8_t> &source, const int startIndex)
   return result;
 }
 
-int32_t FourBytesToInt(const std::vector<uint8_t> &source, const int startIndex) {
+int32_t FourBytesToInt(Span<const uint8_t> source, const int startIndex) {
   int32_t result;
 
   if (!IsBigEndian())
@@ -92,14 +121,18 @@ double Median(std::vector<double> &inVec) {
 }
 
 std::vector<double> OnePoleFilter(const std::vector<double> &vec) {
+  std::vector<double> filtered_signal;
+  OnePoleFilter(vec, filtered_signal);
+  return filtered_signal;
+}
+
+void OnePoleFilter(const std::vector<double> &vec, std::vector<double> &filtered_signal) {
   double a = 0.99;
   double y = 0.0;
 
-  std::vector<double> filtered_signal;
+  filtered_signal.resize(vec.size());
   auto one_pool_equation = [a, &y](const double x) { return y += (1 - a) * x - a * y; };
-  std::transform(vec.begin(), vec.end(), std::back_inserter(filtered_signal), one_pool_equation);
-
-  return filtered_signal;
+  std::transform(vec.begin(), vec.end(), filtered_signal.begin(), one_pool_equation);
 }
 
 }  // namespace core
@@ -16,6 +16,8 @@
 #include <valarray>
 #include <vector>
 
+#include "src/core/span.h"
+
 namespace musher {
 namespace core {
 
@@ -37,6 +39,14 @@ std::string Uint8VectorToHexString(const std::vector<uint8_t> &v);
  */
 std::string StrBetweenSQuotes(const std::string &s);
 
+/**
+ * @brief Quote a string as a JSON string literal, escaping quotes, backslashes and control characters.
+ *
+ * @param s String to quote
+ * @return JSON string literal, quotes included
+ */
+std::string JsonQuote(const std::string &s);
+
 /**
  * @brief Check if the architecture of the machine running the code is big endian.
  *
@@ -44,8 +54,8 @@ std::string StrBetweenSQuotes(const std::string &s);
  * @return false If not big endian.
  */
 bool IsBigEndian(void);
-int16_t TwoBytesToInt(const std::vector<uint8_t> &source, const int startIndex);
-int32_t FourBytesToInt(const std::vector<uint8_t> &source, const int startIndex);
+int16_t TwoBytesToInt(Span<const uint8_t> source, const int startIndex);
+int32_t FourBytesToInt(Span<const uint8_t> source, const int startIndex);
 double NormalizeInt8_t(const uint8_t sample);
 double NormalizeInt16_t(const int16_t sample);
 double NormalizeInt32_t(const int32_t sample);
@@ -118,5 +128,15 @@ double Median(std::vector<double> &inVec);
  */
 std::vector<double> OnePoleFilter(const std::vector<double> &vec);
 
+/**
+ * @brief Compute a one pole filter on an audio signal into an existing buffer.
+ *
+ * The output buffer is resized to the size of the input and may be the input itself.
+ *
+ * @param vec Audio signal.
+ * @param filtered_signal Output, filtered audio signal.
+ */
+void OnePoleFilter(const std::vector<double> &vec, std::vector<double> &filtered_signal);
+
 }  // namespace core
 }  // namespace musher
\ No newline at end of file
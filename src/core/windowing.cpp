@@ -66,7 +66,7 @@ std::vector<double> Normalize(const std::vector<double> &input) {
   return Normalized_output;
 }
 
-std::vector<double> Windowing(const std::vector<double> &audio_frame,
+std::vector<double> Windowing(Span<const double> audio_frame,
                               const std::function<std::vector<double>(const std::vector<double> &)> &window_type_func,
                               unsigned int zero_padding_size,
                               bool zero_phase,
@@ -4,6 +4,8 @@
 #include <functional>
 #include <vector>
 
+#include "src/core/span.h"
+
 namespace musher {
 namespace core {
 
@@ -73,7 +75,7 @@ std::vector<double> Normalize(const std::vector<double> &input);
  * @return std::vector<double> Windowed audio frame.
  */
 std::vector<double> Windowing(
-    const std::vector<double> &audio_frame,
+    Span<const double> audio_frame,
     const std::function<std::vector<double>(const std::vector<double> &)> &window_type_func = BlackmanHarris62dB,
     unsigned zero_padding_size = 0,
     bool zero_phase = true,
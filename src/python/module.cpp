@@ -4,6 +4,8 @@
 #include <pybind11/stl_bind.h>
 
 #include "src/core/framecutter.h"
+#include "src/core/instrumentation.h"
+#include "src/core/threading.h"
 #include "src/python/module_descriptions.h"
 #include "src/python/wrapper.h"
 
@@ -18,22 +20,45 @@ PYBIND11_MODULE(musher_python, m) {
 
   py::bind_vector<std::vector<std::tuple<double, double>>>(m, "peaks");
 
+  // Every compute heavy function releases the GIL once its arguments are converted. Functions returning Python
+  // objects release it inside the wrapper (see CallWithoutGil), the others with a call_guard.
+
+  m.def("set_num_threads", &SetNumThreads, set_num_threads_description, py::arg("num_threads"));
+
+  m.def("get_num_threads", &GetNumThreads, get_num_threads_description);
+
+  m.def("enable_instrumentation", &_EnableInstrumentation, enable_instrumentation_description,
+        py::arg("enabled") = true);
+
+  m.def("instrumentation_stats", &_InstrumentationStats, instrumentation_stats_description);
+
+  m.def("reset_instrumentation", &_ResetInstrumentation, reset_instrumentation_description);
+
+  m.def("instrumentation_compiled", &InstrumentationCompiled, instrumentation_compiled_description);
+
+  m.def("start_trace", &_StartTrace, start_trace_description);
+
+  m.def("stop_trace", &_StopTrace, stop_trace_description, py::arg("file_path"));
+
   m.def("load_audio_file", &_LoadAudioFile, load_audio_file_description, py::arg("file_path"));
 
-  m.def("decode_wav_from_data", &_DecodeWavFromData, decode_wav_from_data_description, py::arg("file_data"));
+  m.def("decode_wav_from_data", &_DecodeWavFromData, decode_wav_from_data_description, py::arg("file_data"),
+        py::arg("mono_downmix") = false);
 
-  m.def("decode_wav_from_file", &_DecodeWavFromFile, decode_wav_from_file_description, py::arg("file_path"));
+  m.def("decode_wav_from_file", &_DecodeWavFromFile, decode_wav_from_file_description, py::arg("file_path"),
+        py::arg("mono_downmix") = false);
 
-  m.def("decode_mp3_from_file", &_DecodeMp3FromFile, decode_mp3_from_file_description, py::arg("file_path"));
+  m.def("decode_mp3_from_file", &_DecodeMp3FromFile, decode_mp3_from_file_description, py::arg("file_path"),
+        py::arg("mono_downmix") = false);
 
   m.def("mono_mixer", &_MonoMixer, mono_mixer_description, py::arg("input"));
 
   // Framecutter will be treated like an iterator in python.
   py::class_<Framecutter>(m, "Framecutter", framecutter_description)
-      .def(py::init<const std::vector<double>, int, int, bool, bool, double>(), framecutter_init_description,
-           py::arg("buffer"), py::arg("frame_size") = 1024, py::arg("hop_size") = 512,
-           py::arg("start_from_center") = true, py::arg("last_frame_to_end_of_file") = false,
-           py::arg("valid_frame_threshold_ratio") = 0.)
+      .def(py::init(&_Framecutter), framecutter_init_description, py::arg("buffer"), py::arg("frame_size") = 1024,
+           py::arg("hop_size") = 512, py::arg("start_from_center") = true, py::arg("last_frame_to_end_of_file") = false,
+           py::arg("valid_frame_threshold_ratio") = 0., py::keep_alive<1, 2>())
+      .def("frames", &_FramecutterFrames, framecutter_frames_description)
       .def(
           "__iter__", [](const Framecutter& fcutter) { return py::make_iterator(fcutter.begin(), fcutter.end()); },
           py::keep_alive<0, 1>());
@@ -53,13 +78,18 @@ PYBIND11_MODULE(musher_python, m) {
   m.def("convert_to_frequency_spectrum", &_ConvertToFrequencySpectrum, convert_to_frequency_spectrum_description,
         py::arg("audio_frame"));
 
+  m.def("convert_to_frequency_spectra", &_ConvertToFrequencySpectra, convert_to_frequency_spectra_description,
+        py::arg("audio_frames"), py::arg("num_threads") = 0);
+
   m.def("peak_detect", &_PeakDetect, peak_detect_description, py::arg("inp"), py::arg("threshold") = -1000.0,
         py::arg("interpolate") = true, py::arg("sort_by") = "position", py::arg("max_num_peaks") = 0,
-        py::arg("range") = 0., py::arg("min_pos") = 0, py::arg("max_pos") = 0);
+        py::arg("range") = 0., py::arg("min_pos") = 0, py::arg("max_pos") = 0,
+        py::call_guard<py::gil_scoped_release>());
 
   m.def("spectral_peaks", &_SpectralPeaks, spectral_peaks_description, py::arg("input_spectrum"),
         py::arg("threshold") = -1000.0, py::arg("sort_by") = "position", py::arg("max_num_peaks") = 100,
-        py::arg("sample_rate") = 44100., py::arg("min_pos") = 0, py::arg("max_pos") = 0);
+        py::arg("sample_rate") = 44100., py::arg("min_pos") = 0, py::arg("max_pos") = 0,
+        py::call_guard<py::gil_scoped_release>());
 
   m.def("hpcp", &_HPCP, hpcp_description, py::arg("frequencies"), py::arg("magnitudes"), py::arg("size") = 12,
         py::arg("reference_frequency") = 440.0, py::arg("harmonics") = 0, py::arg("band_preset") = true,
@@ -82,5 +112,20 @@ PYBIND11_MODULE(musher_python, m) {
         py::arg("use_three_chords") = true, py::arg("num_harmonics") = 4, py::arg("slope") = .6,
         py::arg("use_maj_min") = false, py::arg("pcp_size") = 36, py::arg("frame_size") = 4096,
         py::arg("hop_size") = 512, py::arg("window_type_func") = py::cpp_function(BlackmanHarris62dB),
-        py::arg("max_num_peaks") = 100, py::arg("window_size") = .5);
+        py::arg("max_num_peaks") = 100, py::arg("window_size") = .5, py::arg("early_stop_interval") = 0,
+        py::arg("early_stop_stable_checks") = 3, py::arg("early_stop_tolerance") = .01,
+        py::arg("analysis_sample_rate") = 0.);
+
+  m.def("detect_key_batch", &_DetectKeyBatch, detect_key_batch_description, py::arg("file_paths"),
+        py::arg("n_jobs") = 0, py::arg("max_files_in_flight") = 0, py::arg("profile_type") = "Bgate",
+        py::arg("max_num_peaks") = 100, py::arg("early_stop_interval") = 0, py::arg("early_stop_stable_checks") = 3,
+        py::arg("early_stop_tolerance") = .01, py::arg("analysis_sample_rate") = 0.);
+
+  m.def("bpm_over_window", &_BPMOverWindow, bpm_over_window_description, py::arg("samples"), py::arg("sample_rate"),
+        py::arg("window_seconds") = 3, py::arg("wavelet_name") = "db4", py::arg("levels") = 4, py::arg("min_bpm") = 40.,
+        py::arg("max_bpm") = 220., py::call_guard<py::gil_scoped_release>());
+
+  m.def("analyze_track", &_AnalyzeTrack, analyze_track_description, py::arg("file_path"),
+        py::arg("profile_type") = "Bgate", py::arg("frame_size") = 4096, py::arg("hop_size") = 512,
+        py::arg("min_bpm") = 40., py::arg("max_bpm") = 220.);
 }
@@ -14,6 +14,85 @@
  */
 #pragma once
 
+const char* set_num_threads_description = R"(
+  Set the number of threads parallel functions use when they are not given one.
+
+  This is the default of every `num_threads` or `n_jobs` argument set to 0, such as in
+  :func:`musher.convert_to_frequency_spectra` and :func:`musher.detect_key_batch`.
+
+  Args:
+    num_threads (int): Number of threads. Set to 0 to use the number of hardware threads.
+)";
+
+const char* get_num_threads_description = R"(
+  Number of threads parallel functions use when they are not given one, see :func:`musher.set_num_threads`.
+
+  Returns:
+    int: Default number of threads.
+)";
+
+const char* enable_instrumentation_description = R"(
+  Start or stop recording the time spent in every stage of the key pipeline.
+
+  Stages are only timed when musher was built with instrumentation compiled in (set MUSHER_INSTRUMENTATION=1
+  when building), see :func:`musher.instrumentation_compiled`. Otherwise this has no effect.
+
+  Args:
+    enabled (bool): True to start recording, False to stop.
+)";
+
+const char* instrumentation_stats_description = R"(
+  Statistics recorded since instrumentation was enabled or last reset, see :func:`musher.enable_instrumentation`.
+
+  Returns:
+    dict: One dict per stage (decode, mono_mix, resample, framecutter, windowing, spectrum, spectral_peaks, hpcp,
+    key_estimate and detect_key) with the number of ``calls``, the total ``seconds``, the ``frames`` processed and the
+    ``output_bytes`` of the buffers the stage returned (not every allocation it made).
+
+  Example:
+    >>> musher.enable_instrumentation()
+    >>> key_output = musher.detect_key(normalized_samples, sample_rate)
+    >>> musher.instrumentation_stats()["spectrum"]
+    {'calls': 646, 'seconds': 0.0312, 'frames': 646, 'output_bytes': 10592192}
+)";
+
+const char* reset_instrumentation_description = R"(
+  Set every statistic returned by :func:`musher.instrumentation_stats` back to 0.
+)";
+
+const char* instrumentation_compiled_description = R"(
+  Whether musher was built with instrumentation compiled in.
+
+  Returns:
+    bool: True if stages are timed while instrumentation is enabled.
+)";
+
+const char* start_trace_description = R"(
+  Start recording a timeline of the stages of the key pipeline, per file and per thread.
+
+  Like :func:`musher.enable_instrumentation`, stages are only traced when musher was built with instrumentation
+  compiled in. Stop the trace and write it with :func:`musher.stop_trace`.
+)";
+
+const char* stop_trace_description = R"(
+  Stop the trace started by :func:`musher.start_trace` and write it as a Chrome trace event JSON file.
+
+  Open the file in https://ui.perfetto.dev or chrome://tracing to see every stage on the timeline of the thread
+  that ran it, labelled with the file being analysed.
+
+  Args:
+    file_path (str): Path of the .json file to write.
+
+  Returns:
+    int: Number of events written.
+
+  Example:
+    >>> musher.start_trace()
+    >>> results = musher.detect_key_batch(file_paths)
+    >>> musher.stop_trace("musher_trace.json")
+    5848
+)";
+
 const char* load_audio_file_description = R"(
   Load the data from an audio file.
 
@@ -51,7 +130,9 @@ const char* decode_wav_from_data_description = R"(
   See :ref:`notes<notes_label>` for extra details.
 
   Args:
-    file_data (List[int]): WAV file data.
+    file_data (numpy.ndarray[numpy.uint8]): WAV file data, as returned by :func:`musher.load_audio_file`.
+    mono_downmix (bool, optional): Average the channels into a single channel while decoding. Gives the same samples as
+      :func:`musher.mono_mixer` without holding every channel in memory. Defaults to False.
 
   Returns:
     dict: .wav file information.
@@ -66,6 +147,8 @@ const char* decode_wav_from_file_description = R"(
 
   Args:
     file_path (str): File path to a .wav file.
+    mono_downmix (bool, optional): Average the channels into a single channel while decoding. Gives the same samples as
+      :func:`musher.mono_mixer` without holding every channel in memory. Defaults to False.
 
   Returns:
     dict: .wav file information.
@@ -97,6 +180,8 @@ const char* decode_mp3_from_file_description = R"(
 
   Args:
     file_path (str): File path to a .mp3 file.
+    mono_downmix (bool, optional): Average the channels into a single channel while decoding. Gives the same samples as
+      :func:`musher.mono_mixer` without holding every channel in memory. Defaults to False.
 
   Returns:
     dict: .mp3 file information.
@@ -105,10 +190,11 @@ const char* decode_mp3_from_file_description = R"(
 const char* mono_mixer_description = R"(
   Downmixes the signal into a single channel given a stereo signal.
 
-  If the signal was already a monoaural, it is left unchanged.
+  If the signal was already a monoaural, it is left unchanged. Contiguous float64 arrays are read in place, anything
+  else is converted to one first.
 
   Args:
-    input (List[List[float]]): Stereo or mono audio signal
+    input (numpy.ndarray[numpy.float64]): Stereo or mono audio signal, channels x samples (or a single 1-D channel).
 
   Returns:
     numpy.ndarray[numpy.float64]: Downmixed audio signal
@@ -134,8 +220,11 @@ const char* framecutter_description = R"(
 const char* framecutter_init_description = R"(
   Construct a new Framecutter object
 
+  A contiguous float64 array is read in place (and kept alive by the Framecutter), so changing it while iterating
+  changes the frames. Anything else is converted and copied once.
+
   Args:
-    buffer (List[float]): Buffer from which to read data.
+    buffer (numpy.ndarray[numpy.float64]): Buffer from which to read data.
     frame_size (int, optional): Output frame size. Defaults to 1024.
     hop_size (int, optional): Hop size between frames. Defaults to 512.
     start_from_center (bool, optional): If true start from the center of the buffer (zero-centered at -frameSize/2) or
@@ -150,6 +239,24 @@ const char* framecutter_init_description = R"(
     List[float]: Cut frame.
 )";
 
+const char* framecutter_frames_description = R"(
+  All frames at once, as a 2-D array.
+
+  The array is read-only. When every frame lies within the buffer it is a strided view of the buffer, otherwise it is
+  a view of a single zero-padded copy of the buffer. Either way no frame is copied on its own.
+
+  Examples:
+    >>> buffer = np.arange(1., 6.)
+    >>> musher.Framecutter(buffer, 3, 2, True, False, 0.).frames()
+    array([[0., 0., 1.],
+           [1., 2., 3.],
+           [3., 4., 5.],
+           [5., 0., 0.]])
+
+  Returns:
+    numpy.ndarray[numpy.float64]: Frames x frame size matrix, the same frames as iterating over the Framecutter.
+)";
+
 const char* windowing_description = R"(
   Applies windowing to an audio signal.
   
@@ -165,7 +272,7 @@ const char* windowing_description = R"(
   [2] Window function - Wikipedia, the free encyclopedia, http://en.wikipedia.org/wiki/Window_function
 
   Args:
-    audio_frame (List[float]): Input audio frame.
+    audio_frame (numpy.ndarray[numpy.float64]): Input audio frame.
     window_type_func (Callable[[List[float]], List[float]], optional): The window type function. Examples: BlackmanHarris92dB, BlackmanHarris62dB...
       Defaults to BlackmanHarris92dB.
     zero_padding_size (int, optional): Size of the zero-padding. Defaults to 0.
@@ -180,7 +287,7 @@ const char* square_description = R"(
   Square windowing function.
 
   Args:
-    window (List[float]): Audio signal window.
+    window (numpy.ndarray[numpy.float64]): Audio signal window, only its size is used.
 
   Returns:
     numpy.ndarray[numpy.float64]: Square window.
@@ -192,7 +299,7 @@ const char* blackmanharris_description = R"(
   Window functions help control spectral leakage when doing Fourier Analysis.
 
   Args:
-    window (List[float]): Audio signal window.
+    window (numpy.ndarray[numpy.float64]): Audio signal window, only its size is used.
     a0 (float): Constant a0.
     a1 (float): Constant a1.
     a2 (float): Constant a2.
@@ -206,7 +313,7 @@ const char* blackmanharris62dB_description = R"(
   Blackmanharris62db windowing algorithm.
 
   Args:
-    window (List[float]): Audio signal window.
+    window (numpy.ndarray[numpy.float64]): Audio signal window, only its size is used.
 
   Returns:
     numpy.ndarray[numpy.float64]: Blackmanharris62db window.
@@ -216,7 +323,7 @@ const char* blackmanharris92dB_description = R"(
   Blackmanharris92db windowing algorithm.
 
   Args:
-    window (List[float]): Audio signal window.
+    window (numpy.ndarray[numpy.float64]): Audio signal window, only its size is used.
 
   Returns:
     numpy.ndarray[numpy.float64]: Blackmanharris92db window.
@@ -229,12 +336,26 @@ const char* convert_to_frequency_spectrum_description = R"(
   Bins contain raw (linear) magnitude values.
 
   Args:
-    frame (List[float]): Input audio frame.
+    frame (numpy.ndarray[numpy.float64]): Input audio frame.
 
   Returns:
     numpy.ndarray[numpy.float64]: Frequency spectrum of the input audio signal.
 )";
 
+const char* convert_to_frequency_spectra_description = R"(
+  Computes the frequency spectra of many frames of the same size in parallel.
+
+  Each spectrum is the same as :func:`musher.convert_to_frequency_spectrum` of its frame. The GIL is released while
+  the spectra are computed.
+
+  Args:
+    audio_frames (numpy.ndarray[numpy.float64]): Input audio frames, frames x frame size.
+    num_threads (int, optional): Number of threads. Set to 0 to use :func:`musher.get_num_threads`. Defaults to 0.
+
+  Returns:
+    numpy.ndarray[numpy.float64]: Frequency spectrum of every frame, frames x frequency bins.
+)";
+
 const char* peak_detect_description = R"(
   Computes the frequency spectrum of an array of Reals.
 
@@ -242,7 +363,7 @@ const char* peak_detect_description = R"(
   Bins contain raw (linear) magnitude values.
 
   Args:
-    inp (List[float]): Input vector.
+    inp (numpy.ndarray[numpy.float64]): Input vector.
     threshold (float, optional): Peaks below this given threshold are not outputted. Defaults to -1000.0.
     interpolate (bool, optional): Enables interpolation. Defaults to True.
     sort_by (str, optional): Ordering type of the outputted peaks (ascending by position
@@ -271,7 +392,7 @@ const char* spectral_peaks_description = R"(
   [1] Peak Detection, http://ccrma.stanford.edu/~jos/parshl/Peak_Detection_Steps_3.html
 
   Args:
-    input_spectrum (List[float]): Input spectrum.
+    input_spectrum (numpy.ndarray[numpy.float64]): Input spectrum.
     threshold (float, optional): Peaks below this given threshold are not outputted. Defaults to -1000.0.
     sort_by (str, optional): Ordering type of the outputted peaks (ascending by frequency (position)
       or descending by magnitude (height)). Defaults to 'position'.
@@ -291,8 +412,8 @@ const char* hpcp_description = R"(
   (corresponsing to notes from A to G#), or subdivisions of these (k>1).
 
   Args:
-    frequencies (List[float]): Frequencies (positions) of the spectral peaks [Hz].
-    magnitudes (List[float]): Magnitudes (heights) of the spectral peaks.
+    frequencies (numpy.ndarray[numpy.float64]): Frequencies (positions) of the spectral peaks [Hz].
+    magnitudes (numpy.ndarray[numpy.float64]): Magnitudes (heights) of the spectral peaks.
     size (int, optional): Size of the output HPCP (must be a positive nonzero multiple of 12). Defaults to 12.
     reference_frequency (float, optional): Reference frequency for semitone index calculation, corresponding to A3 [Hz]. Defaults to 440.0.
     harmonics (int, optional): Number of harmonics for frequency contribution, 0 indicates exclusive fundamental frequency
@@ -346,7 +467,7 @@ const char* estimate_key_description = R"(
   Computes key estimate given a pitch class profile (HPCP).
 
   Args:
-    pcp (List[float]): The input pitch class profile.
+    pcp (numpy.ndarray[numpy.float64]): The input pitch class profile.
     use_polphony (bool, optional): Enables the use of polyphonic profiles to define key profiles (this includes the contributions
       from triads as well as pitch harmonics). Defaults to True.
     use_three_chords (bool, optional): Consider only the 3 main triad chords of the key (T, D, SD) to build the polyphonic profiles. Defaults to True.
@@ -364,8 +485,11 @@ const char* estimate_key_description = R"(
 const char* detect_key_description = R"(
   Computes key estimate given normalized samples.
 
+  Contiguous float64 samples are read in place, only stereo samples are mixed down into a new buffer.
+
   Args:
-    normalized_samples (List[List[float]]): Normalized samples from a decoded file.
+    normalized_samples (numpy.ndarray[numpy.float64]): Normalized samples from a decoded file, channels x samples (or
+      a single 1-D channel).
     sample_rate (float, optional): Sampling rate of the audio signal [Hz]. Defaults to 44100.0.
     profile_type (str, optional): The type of polyphic profile to use for correlation calculation. Defaults to 'Bgate'.
     use_polphony (bool, optional): Enables the use of polyphonic profiles to define key profiles (this includes the contributions
@@ -381,9 +505,120 @@ const char* detect_key_description = R"(
     hop_size (int, optional): Hop size between frames of framecutter. Defaults to 512.
     window_type_func (Callable[[List[float]], List[float]], optional): The window type function.
       Examples: BlackmanHarris92dB, BlackmanHarris62dB... Defaults to BlackmanHarris62dB.
-    max_num_peaks (int, optional): Maximum number of returned peaks (set to 0 to return all peaks) for spectral peaks. Defaults to 100.
+    max_num_peaks (int, optional): Maximum number of returned peaks (set to 0 to return all peaks) for spectral peaks. With 0,
+      only the part of the spectrum within the HPCP frequency range is computed and searched for peaks. Defaults to 100.
     window_size (float, optional): Size, in semitones, of the window used for the weighting for HPCP. Defaults to 0.5.
+    early_stop_interval (int, optional): Number of frames between intermediate key estimates on the running HPCP average.
+      Set to 0 to disable early stopping and process every frame. Defaults to 0.
+    early_stop_stable_checks (int, optional): Number of consecutive intermediate estimates that must agree with the previous
+      one before processing stops. Defaults to 3.
+    early_stop_tolerance (float, optional): Maximum change of first_to_second_relative_strength between two intermediate
+      estimates for them to be considered in agreement. Defaults to 0.01.
+    analysis_sample_rate (float, optional): Sampling rate to analyse the audio at. When lower than sample_rate the audio is
+      resampled first and frame_size and hop_size are scaled by the same ratio. It must be at least 10000 so the HPCP
+      range (up to 5000 Hz) is preserved. Set to 0 to analyse at sample_rate. Defaults to 0.
 
   Returns:
-    KeyOutput: Details of key estimate.
+    KeyOutput: Details of key estimate, including the number of frames processed.
+)";
+
+const char* detect_key_batch_description = R"(
+  Detect the key of many .wav or .mp3 files in parallel.
+
+  Files are read from disk by the calling thread while a pool of workers decodes (straight to mono) and analyses them,
+  so file I/O overlaps with computation. At most max_files_in_flight loaded files wait for a worker at any time, which
+  bounds memory use. The GIL is released while the batch runs.
+
+  Example:
+
+    >>> results = musher.detect_key_batch(["a.mp3", "b.wav", "missing.mp3"], n_jobs=4)
+    >>> print(results[0])
+    {
+      'key': 'C',
+      'scale': 'major',
+      'strength': 0.760328,
+      'first_to_second_relative_strength': 0.608866,
+      'frames_processed': 2591,
+      'file_path': 'a.mp3',
+      'error': None
+    }
+    >>> print(results[2])
+    {'file_path': 'missing.mp3', 'error': "Failed to load file 'missing.mp3'"}
+
+  Args:
+    file_paths (List[str]): Paths of .wav or .mp3 files.
+    n_jobs (int, optional): Number of worker threads. Set to 0 to use :func:`musher.get_num_threads`. Defaults to 0.
+    max_files_in_flight (int, optional): Maximum number of loaded files waiting for a worker. Set to 0 to use
+      2 * n_jobs. Defaults to 0.
+    profile_type (str, optional): The type of polyphic profile to use for correlation calculation. Defaults to "Bgate".
+    max_num_peaks (int, optional): Maximum number of spectral peaks per frame, see :func:`musher.detect_key`.
+      Defaults to 100.
+    early_stop_interval (int, optional): See :func:`musher.detect_key`. Defaults to 0.
+    early_stop_stable_checks (int, optional): See :func:`musher.detect_key`. Defaults to 3.
+    early_stop_tolerance (float, optional): See :func:`musher.detect_key`. Defaults to 0.01.
+    analysis_sample_rate (float, optional): See :func:`musher.detect_key`. Defaults to 0.
+
+  Returns:
+    List[dict]: One result per path, in the same order as file_paths. Successful results hold the same fields as
+    :func:`musher.detect_key` plus 'file_path' and 'error' (None). Failed results only hold 'file_path' and 'error'.
+)";
+
+const char* bpm_over_window_description = R"(
+  Calculate the BPM (Beats per minute) of mono audio samples.
+
+  The samples are sliced into windows. The BPM of every window is taken from the autocorrelation of the summed band
+  envelopes of a discrete wavelet transform, and the median over windows is returned.
+
+  Example:
+
+    >>> mp3_decoded = musher.decode_mp3_from_file(path_to_mp3_file, mono_downmix=True)
+    >>> musher.bpm_over_window(mp3_decoded["normalized_samples"][0], mp3_decoded["sample_rate"])
+    125.0
+
+  Args:
+    samples (numpy.ndarray[numpy.float64]): Mono audio samples.
+    sample_rate (float): Sampling rate of the audio signal [Hz].
+    window_seconds (int, optional): Size of the window [Seconds] that will be scanned to determine the bpm, typically
+      less than 10 seconds. Defaults to 3.
+    wavelet_name (str, optional): Wavelet used for the decomposition, "db4" or "haar". Defaults to "db4".
+    levels (int, optional): Number of decomposition levels. Defaults to 4.
+    min_bpm (float, optional): Lowest tempo that can be detected. Defaults to 40.
+    max_bpm (float, optional): Highest tempo that can be detected. Defaults to 220.
+
+  Returns:
+    float: Median BPM over windows rounded to the nearest integer, 0 if no tempo was found.
+)";
+
+const char* analyze_track_description = R"(
+  Detect the key, the tempo and the beats of a .wav or .mp3 file in a single pass.
+
+  The file is decoded straight to mono once, and every frame is windowed and transformed once. Each magnitude spectrum
+  feeds both the HPCP used for the key and an onset strength envelope used for the tempo, which is cheaper than
+  calling :func:`musher.detect_key` and :func:`musher.bpm_over_window` on separately decoded audio. Beats are tracked
+  on the onset strength envelope with dynamic programming (Ellis, 2007).
+
+  Example:
+
+    >>> musher.analyze_track(path_to_mp3_file)
+    {
+      'key': 'Ab',
+      'scale': 'minor',
+      'strength': 0.558504,
+      'first_to_second_relative_strength': 0.087878,
+      'frames_processed': 14098,
+      'bpm': 124.987,
+      'beat_times': [0.18576, 0.661769, 1.14939, ...]
+    }
+
+  Args:
+    file_path (str): Path of a .wav or .mp3 file.
+    profile_type (str, optional): The type of polyphic profile to use for correlation calculation. Defaults to "Bgate".
+    frame_size (int, optional): Number of samples in each frame. Defaults to 4096.
+    hop_size (int, optional): Number of samples between the starts of consecutive frames. Defaults to 512.
+    min_bpm (float, optional): Lowest tempo that can be detected. Defaults to 40.
+    max_bpm (float, optional): Highest tempo that can be detected. Defaults to 220.
+
+  Returns:
+    dict: The same fields as :func:`musher.detect_key` plus 'bpm' (0 if no tempo was found) and 'beat_times', the
+    time of every beat in seconds.
 )";
@@ -1,6 +1,7 @@
 #include "src/python/utils.h"
 
 #include <stdexcept>
+#include <string>
 #include <vector>
 
 using namespace musher::core;
@@ -8,58 +9,64 @@ using namespace musher::core;
 namespace musher {
 namespace python {
 
-py::dict ConvertWavDecodedToPyDict(WavDecoded wav_decoded) {
-  py::dict output_dict;
-  output_dict["sample_rate"] = wav_decoded.sample_rate;
-  output_dict["bit_depth"] = wav_decoded.bit_depth;
-  output_dict["channels"] = wav_decoded.channels;
-  output_dict["mono"] = wav_decoded.mono;
-  output_dict["stereo"] = wav_decoded.stereo;
-  output_dict["samples_per_channel"] = wav_decoded.samples_per_channel;
-  output_dict["length_in_seconds"] = wav_decoded.length_in_seconds;
-  output_dict["file_type"] = wav_decoded.file_type;
-  output_dict["avg_bitrate_kbps"] = wav_decoded.avg_bitrate_kbps;
+Span<const double> ConvertPyarrayToSpan(const DoubleArray& array) {
+  if (array.ndim() != 1) {
+    throw std::runtime_error("Expected a 1-D array, got " + std::to_string(array.ndim()) + " dimensions.");
+  }
+  return Span<const double>(array.data(), static_cast<size_t>(array.shape(0)));
+}
 
-  // Convert 2D vector to 2D numpy array with copy.
-  std::vector<std::vector<double>> normalized_samples = wav_decoded.normalized_samples;
-  size_t rows = normalized_samples.size();
-  size_t cols = normalized_samples[0].size();
-  py::array_t<double, py::array::c_style> numpy_arr({ rows, cols });
-  auto ra = numpy_arr.mutable_unchecked();
-  for (size_t i = 0; i < rows; i++) {
-    for (size_t j = 0; j < cols; j++) {
-      ra(i, j) = normalized_samples[i][j];
-    };
-  };
-  output_dict["normalized_samples"] = numpy_arr;
+Span<const uint8_t> ConvertPyarrayToSpan(const ByteArray& array) {
+  if (array.ndim() != 1) {
+    throw std::runtime_error("Expected a 1-D array, got " + std::to_string(array.ndim()) + " dimensions.");
+  }
+  return Span<const uint8_t>(array.data(), static_cast<size_t>(array.shape(0)));
+}
 
-  return output_dict;
+std::vector<Span<const double>> ConvertPyarrayToRowSpans(const DoubleArray& array) {
+  if (array.ndim() == 1) return { ConvertPyarrayToSpan(array) };
+  if (array.ndim() != 2) {
+    throw std::runtime_error("Expected a 1-D or 2-D array, got " + std::to_string(array.ndim()) + " dimensions.");
+  }
+  const size_t rows = static_cast<size_t>(array.shape(0));
+  const size_t cols = static_cast<size_t>(array.shape(1));
+  std::vector<Span<const double>> row_spans;
+  row_spans.reserve(rows);
+  for (size_t row = 0; row < rows; row++) row_spans.emplace_back(array.data() + row * cols, cols);
+  return row_spans;
 }
 
-py::dict ConvertMp3DecodedToPyDict(Mp3Decoded mp3_decoded) {
-  py::dict output_dict;
-  output_dict["sample_rate"] = mp3_decoded.sample_rate;
-  output_dict["channels"] = mp3_decoded.channels;
-  output_dict["mono"] = mp3_decoded.mono;
-  output_dict["stereo"] = mp3_decoded.stereo;
-  output_dict["samples_per_channel"] = mp3_decoded.samples_per_channel;
-  output_dict["length_in_seconds"] = mp3_decoded.length_in_seconds;
-  output_dict["file_type"] = mp3_decoded.file_type;
-  output_dict["avg_bitrate_kbps"] = mp3_decoded.avg_bitrate_kbps;
+namespace {
+
+/**
+ * @brief Fill the attributes common to every decoded file, handing the samples over to numpy without copying.
+ */
+void AddAudioDecodedToPyDict(AudioDecoded& audio_decoded, py::dict& output_dict) {
+  output_dict["sample_rate"] = audio_decoded.sample_rate;
+  output_dict["channels"] = audio_decoded.channels;
+  output_dict["mono"] = audio_decoded.mono;
+  output_dict["stereo"] = audio_decoded.stereo;
+  output_dict["samples_per_channel"] = audio_decoded.samples_per_channel;
+  output_dict["length_in_seconds"] = audio_decoded.length_in_seconds;
+  output_dict["file_type"] = audio_decoded.file_type;
+  output_dict["avg_bitrate_kbps"] = audio_decoded.avg_bitrate_kbps;
+  output_dict["normalized_samples"] =
+      ConvertPlanarToPyarray(audio_decoded.normalized_samples, static_cast<size_t>(audio_decoded.channels),
+                             static_cast<size_t>(audio_decoded.samples_per_channel));
+}
 
-  // Convert 2D vector to 2D numpy array with copy.
-  std::vector<std::vector<double>> normalized_samples = mp3_decoded.normalized_samples;
-  size_t rows = normalized_samples.size();
-  size_t cols = normalized_samples[0].size();
-  py::array_t<double, py::array::c_style> numpy_arr({ rows, cols });
-  auto ra = numpy_arr.mutable_unchecked();
-  for (size_t i = 0; i < rows; i++) {
-    for (size_t j = 0; j < cols; j++) {
-      ra(i, j) = normalized_samples[i][j];
-    };
-  };
-  output_dict["normalized_samples"] = numpy_arr;
+}  // namespace
 
+py::dict ConvertWavDecodedToPyDict(WavDecoded&& wav_decoded) {
+  py::dict output_dict;
+  output_dict["bit_depth"] = wav_decoded.bit_depth;
+  AddAudioDecodedToPyDict(wav_decoded, output_dict);
+  return output_dict;
+}
+
+py::dict ConvertMp3DecodedToPyDict(Mp3Decoded&& mp3_decoded) {
+  py::dict output_dict;
+  AddAudioDecodedToPyDict(mp3_decoded, output_dict);
   return output_dict;
 }
 
@@ -69,6 +76,7 @@ py::dict ConvertKeyOutputToPyDict(KeyOutput key_output) {
   key_output_dict["scale"] = key_output.scale;
   key_output_dict["strength"] = key_output.strength;
   key_output_dict["first_to_second_relative_strength"] = key_output.first_to_second_relative_strength;
+  key_output_dict["frames_processed"] = key_output.frames_processed;
   return key_output_dict;
 }
 
@@ -2,8 +2,12 @@
 
 #include <pybind11/numpy.h>
 
+#include <utility>
+#include <vector>
+
 #include "src/core/audio_decoders.h"
 #include "src/core/key.h"
+#include "src/core/span.h"
 
 using namespace musher::core;
 namespace py = pybind11;
@@ -11,6 +15,19 @@ namespace py = pybind11;
 namespace musher {
 namespace python {
 
+/**
+ * @brief Numpy array of doubles in C order.
+ *
+ * Arrays that already are contiguous float64 are passed through as they are, anything else (lists, other dtypes,
+ * strided views) is converted once in bulk.
+ */
+using DoubleArray = py::array_t<double, py::array::c_style | py::array::forcecast>;
+
+/**
+ * @brief Numpy array of bytes in C order, passed through or converted the same way as DoubleArray.
+ */
+using ByteArray = py::array_t<uint8_t, py::array::c_style | py::array::forcecast>;
+
 /**
  * @brief Convert a sequence C++ type to a numpy array WITHOUT copying.
  * 
@@ -29,8 +46,85 @@ py::array_t<typename Sequence::value_type> ConvertSequenceToPyarray(Sequence& se
     );
 }
 
-py::dict ConvertWavDecodedToPyDict(WavDecoded wav_decoded);
-py::dict ConvertMp3DecodedToPyDict(Mp3Decoded mp3_decoded);
+/**
+ * @brief Convert a planar (rows x cols, row after row) C++ sequence to a 2-D numpy array WITHOUT copying.
+ *
+ * @tparam Sequence
+ * @param seq A sequence holding rows * cols elements, it is moved out.
+ * @param rows Number of rows.
+ * @param cols Number of columns.
+ * @return py::array_t<typename Sequence::value_type> 2-D numpy array.
+ */
+template <typename Sequence>
+py::array_t<typename Sequence::value_type> ConvertPlanarToPyarray(Sequence& seq, size_t rows, size_t cols) {
+  using T = typename Sequence::value_type;
+  Sequence* seq_ptr = new Sequence(std::move(seq));
+  auto capsule = py::capsule(seq_ptr, [](void* p) { delete reinterpret_cast<Sequence*>(p); });
+  const std::vector<py::ssize_t> shape{ static_cast<py::ssize_t>(rows), static_cast<py::ssize_t>(cols) };
+  const std::vector<py::ssize_t> strides{ static_cast<py::ssize_t>(cols * sizeof(T)),
+                                          static_cast<py::ssize_t>(sizeof(T)) };
+  return py::array_t<T>(shape,            // shape of array
+                        strides,          // c-style contiguous strides
+                        seq_ptr->data(),  // data owned by the capsule
+                        capsule           // numpy array references this parent
+  );
+}
+
+/**
+ * @brief Call a function with the GIL released, so other Python threads run meanwhile.
+ *
+ * The function must not touch Python objects. Views of numpy arguments are fine, the arguments stay referenced for
+ * the whole call. Python callbacks wrapped in a std::function acquire the GIL themselves.
+ *
+ * @tparam Function
+ * @param function Function taking no arguments.
+ * @return decltype(function()) Result of the function.
+ */
+template <typename Function>
+auto CallWithoutGil(Function&& function) -> decltype(function()) {
+  py::gil_scoped_release release;
+  return function();
+}
+
+/**
+ * @brief View of a 1-D numpy array WITHOUT copying.
+ *
+ * @param array 1-D numpy array, it must outlive the view.
+ * @return Span<const double> View of the array.
+ */
+Span<const double> ConvertPyarrayToSpan(const DoubleArray& array);
+
+/**
+ * @brief Overloaded ConvertPyarrayToSpan for a 1-D array of bytes.
+ *
+ * @param array 1-D numpy array, it must outlive the view.
+ * @return Span<const uint8_t> View of the array.
+ */
+Span<const uint8_t> ConvertPyarrayToSpan(const ByteArray& array);
+
+/**
+ * @brief Views of the rows of a 2-D (channels x samples) numpy array WITHOUT copying. A 1-D array is a single row.
+ *
+ * @param array 1-D or 2-D numpy array, it must outlive the views.
+ * @return std::vector<Span<const double>> View of every row.
+ */
+std::vector<Span<const double>> ConvertPyarrayToRowSpans(const DoubleArray& array);
+
+/**
+ * @brief Convert a decoded file to a dict, its samples become a 2-D (channels x samples) numpy array WITHOUT copying.
+ *
+ * @param wav_decoded Decoded file, its samples are moved out.
+ * @return py::dict Attributes of the decoded file.
+ */
+py::dict ConvertWavDecodedToPyDict(WavDecoded&& wav_decoded);
+
+/**
+ * @brief Convert a decoded file to a dict, its samples become a 2-D (channels x samples) numpy array WITHOUT copying.
+ *
+ * @param mp3_decoded Decoded file, its samples are moved out.
+ * @return py::dict Attributes of the decoded file.
+ */
+py::dict ConvertMp3DecodedToPyDict(Mp3Decoded&& mp3_decoded);
 py::dict ConvertKeyOutputToPyDict(KeyOutput key_output);
 
 }  // namespace python
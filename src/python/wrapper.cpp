@@ -2,12 +2,24 @@
 
 #include <pybind11/numpy.h>
 
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "src/core/analyze.h"
 #include "src/core/audio_decoders.h"
+#include "src/core/batch.h"
+#include "src/core/bpm.h"
+#include "src/core/framecutter.h"
 #include "src/core/hpcp.h"
+#include "src/core/instrumentation.h"
 #include "src/core/mono_mixer.h"
 #include "src/core/peak_detect.h"
 #include "src/core/spectral_peaks.h"
 #include "src/core/spectrum.h"
+#include "src/core/trace.h"
 #include "src/core/windowing.h"
 #include "src/python/utils.h"
 
@@ -17,66 +29,132 @@ namespace py = pybind11;
 namespace musher {
 namespace python {
 
+namespace {
+
+/**
+ * @brief Sink the Python module records into while instrumentation is enabled.
+ */
+InstrumentationSink& PythonInstrumentationSink() {
+  static InstrumentationSink sink;
+  return sink;
+}
+
+/**
+ * @brief Tracer of the trace started by start_trace, nullptr if none.
+ */
+std::shared_ptr<Tracer>& PythonTracer() {
+  static std::shared_ptr<Tracer> tracer;
+  return tracer;
+}
+
+}  // namespace
+
+void _EnableInstrumentation(bool enabled) { SetInstrumentationSink(enabled ? &PythonInstrumentationSink() : nullptr); }
+
+py::dict _InstrumentationStats() {
+  py::dict stats_dict;
+  for (const StageStats& stats : PythonInstrumentationSink().stats()) {
+    py::dict stage_dict;
+    stage_dict["calls"] = stats.calls;
+    stage_dict["seconds"] = stats.seconds;
+    stage_dict["frames"] = stats.frames;
+    stage_dict["output_bytes"] = stats.output_bytes;
+    stats_dict[stats.stage.c_str()] = stage_dict;
+  }
+  return stats_dict;
+}
+
+void _ResetInstrumentation() { PythonInstrumentationSink().reset(); }
+
+void _StartTrace() {
+  if (PythonTracer()) throw std::runtime_error("A trace is already running, stop it with stop_trace first.");
+  PythonTracer() = std::make_shared<Tracer>();
+  SetTracer(PythonTracer());
+}
+
+size_t _StopTrace(const std::string& file_path) {
+  if (!PythonTracer()) throw std::runtime_error("No trace is running, start one with start_trace first.");
+  SetTracer(nullptr);
+  // Calls still running on other threads share the tracer, so it lives until the last of them is done with it.
+  std::shared_ptr<Tracer> tracer = std::move(PythonTracer());
+  return tracer->write_json(file_path);
+}
+
 py::array_t<uint8_t> _LoadAudioFile(const std::string& file_path) {
-  std::vector<uint8_t> fileData = LoadAudioFile(file_path);
+  std::vector<uint8_t> fileData = CallWithoutGil([&] { return LoadAudioFile(file_path); });
   return ConvertSequenceToPyarray(fileData);
 }
 
-py::dict _DecodeWavFromData(std::vector<uint8_t>& file_data) {
-  WavDecoded wav_decoded = DecodeWav(file_data);
-  return ConvertWavDecodedToPyDict(wav_decoded);
+py::dict _DecodeWavFromData(const ByteArray& file_data, bool mono_downmix) {
+  Span<const uint8_t> file_data_span = ConvertPyarrayToSpan(file_data);
+  WavDecoded wav_decoded = CallWithoutGil([&] { return DecodeWav(file_data_span, mono_downmix); });
+  return ConvertWavDecodedToPyDict(std::move(wav_decoded));
 }
 
-py::dict _DecodeWavFromFile(const std::string file_path) {
-  WavDecoded wav_decoded = DecodeWav(file_path);
-  return ConvertWavDecodedToPyDict(wav_decoded);
+py::dict _DecodeWavFromFile(const std::string file_path, bool mono_downmix) {
+  WavDecoded wav_decoded = CallWithoutGil([&] { return DecodeWav(file_path, mono_downmix); });
+  return ConvertWavDecodedToPyDict(std::move(wav_decoded));
 }
 
-py::dict _DecodeMp3FromFile(const std::string file_path) {
-  Mp3Decoded mp3_decoded = DecodeMp3(file_path);
-  return ConvertMp3DecodedToPyDict(mp3_decoded);
+py::dict _DecodeMp3FromFile(const std::string file_path, bool mono_downmix) {
+  Mp3Decoded mp3_decoded = CallWithoutGil([&] { return DecodeMp3(file_path, mono_downmix); });
+  return ConvertMp3DecodedToPyDict(std::move(mp3_decoded));
 }
 
-py::array_t<double> _MonoMixer(const std::vector<std::vector<double>>& normalized_samples) {
-  std::vector<double> mixed_audio = MonoMixer(normalized_samples);
+py::array_t<double> _MonoMixer(const DoubleArray& normalized_samples) {
+  std::vector<Span<const double>> channels = ConvertPyarrayToRowSpans(normalized_samples);
+  std::vector<double> mixed_audio = CallWithoutGil([&] { return MonoMixer(channels); });
   return ConvertSequenceToPyarray(mixed_audio);
 }
 
-py::array_t<double> _Windowing(const std::vector<double>& audio_frame,
+py::array_t<double> _Windowing(const DoubleArray& audio_frame,
                                const std::function<std::vector<double>(const std::vector<double>&)>& window_type_func,
                                unsigned int zero_padding_size,
                                bool zero_phase,
                                bool _normalize) {
-  const std::vector<double> vec = Windowing(audio_frame, window_type_func, zero_padding_size, zero_phase, _normalize);
+  Span<const double> audio_frame_span = ConvertPyarrayToSpan(audio_frame);
+  std::vector<double> vec = CallWithoutGil(
+      [&] { return Windowing(audio_frame_span, window_type_func, zero_padding_size, zero_phase, _normalize); });
   return ConvertSequenceToPyarray(vec);
 }
 
-py::array_t<double> _Square(const std::vector<double>& window) {
-  const std::vector<double> vec = Square(window);
+// The window functions only use the size of their input, so there is nothing to read from the array.
+
+py::array_t<double> _Square(const DoubleArray& window) {
+  const std::vector<double> vec = Square(std::vector<double>(ConvertPyarrayToSpan(window).size()));
   return ConvertSequenceToPyarray(vec);
 }
 
-py::array_t<double> _BlackmanHarris(const std::vector<double>& window, double a0, double a1, double a2, double a3) {
-  const std::vector<double> vec = BlackmanHarris(window, a0, a1, a2, a3);
+py::array_t<double> _BlackmanHarris(const DoubleArray& window, double a0, double a1, double a2, double a3) {
+  const std::vector<double> vec =
+      BlackmanHarris(std::vector<double>(ConvertPyarrayToSpan(window).size()), a0, a1, a2, a3);
   return ConvertSequenceToPyarray(vec);
 }
 
-py::array_t<double> _BlackmanHarris62dB(const std::vector<double>& window) {
-  const std::vector<double> vec = BlackmanHarris62dB(window);
+py::array_t<double> _BlackmanHarris62dB(const DoubleArray& window) {
+  const std::vector<double> vec = BlackmanHarris62dB(std::vector<double>(ConvertPyarrayToSpan(window).size()));
   return ConvertSequenceToPyarray(vec);
 }
 
-py::array_t<double> _BlackmanHarris92dB(const std::vector<double>& window) {
-  const std::vector<double> vec = BlackmanHarris92dB(window);
+py::array_t<double> _BlackmanHarris92dB(const DoubleArray& window) {
+  const std::vector<double> vec = BlackmanHarris92dB(std::vector<double>(ConvertPyarrayToSpan(window).size()));
   return ConvertSequenceToPyarray(vec);
 }
 
-py::array_t<double> _ConvertToFrequencySpectrum(const std::vector<double>& audio_frame) {
-  const std::vector<double> vec = ConvertToFrequencySpectrum(audio_frame);
+py::array_t<double> _ConvertToFrequencySpectrum(const DoubleArray& audio_frame) {
+  Span<const double> audio_frame_span = ConvertPyarrayToSpan(audio_frame);
+  std::vector<double> vec = CallWithoutGil([&] { return ConvertToFrequencySpectrum(audio_frame_span); });
   return ConvertSequenceToPyarray(vec);
 }
 
-std::vector<std::tuple<double, double>> _PeakDetect(const std::vector<double>& inp,
+py::array_t<double> _ConvertToFrequencySpectra(const DoubleArray& audio_frames, unsigned int num_threads) {
+  const std::vector<Span<const double>> frames = ConvertPyarrayToRowSpans(audio_frames);
+  const size_t spectrum_size = frames.empty() ? 0 : FrequencySpectrumSize(frames[0].size());
+  std::vector<double> spectra = CallWithoutGil([&] { return ConvertToFrequencySpectraPlanar(frames, num_threads); });
+  return ConvertPlanarToPyarray(spectra, frames.size(), spectrum_size);
+}
+
+std::vector<std::tuple<double, double>> _PeakDetect(const DoubleArray& inp,
                                                     double threshold,
                                                     bool interpolate,
                                                     std::string sort_by,
@@ -86,11 +164,11 @@ std::vector<std::tuple<double, double>> _PeakDetect(const std::vector<double>& i
                                                     int max_pos) {
   // Figure out how to pass vector of tuples back without copy.
   std::vector<std::tuple<double, double>> vec =
-      PeakDetect(inp, threshold, interpolate, sort_by, max_num_peaks, range, min_pos, max_pos);
+      PeakDetect(ConvertPyarrayToSpan(inp), threshold, interpolate, sort_by, max_num_peaks, range, min_pos, max_pos);
   return vec;
 }
 
-std::vector<std::tuple<double, double>> _SpectralPeaks(const std::vector<double>& input_spectrum,
+std::vector<std::tuple<double, double>> _SpectralPeaks(const DoubleArray& input_spectrum,
                                                        double threshold,
                                                        std::string sort_by,
                                                        unsigned int max_num_peaks,
@@ -98,8 +176,8 @@ std::vector<std::tuple<double, double>> _SpectralPeaks(const std::vector<double>
                                                        int min_pos,
                                                        int max_pos) {
   // Figure out how to pass vector of tuples back without copy.
-  std::vector<std::tuple<double, double>> vec =
-      SpectralPeaks(input_spectrum, threshold, sort_by, max_num_peaks, sample_rate, min_pos, max_pos);
+  std::vector<std::tuple<double, double>> vec = SpectralPeaks(ConvertPyarrayToSpan(input_spectrum), threshold, sort_by,
+                                                              max_num_peaks, sample_rate, min_pos, max_pos);
   return vec;
 }
 
@@ -116,14 +194,15 @@ py::array_t<double> _HPCPFromPeaks(const std::vector<std::tuple<double, double>>
                                    bool max_shifted,
                                    bool non_linear,
                                    std::string _normalized) {
-  const std::vector<double> vec =
-      HPCP(peaks, size, reference_frequency, harmonics, band_preset, band_split_frequency, min_frequency, max_frequency,
-           _weight_type, window_size, max_shifted, non_linear, _normalized);
+  std::vector<double> vec = CallWithoutGil([&] {
+    return HPCP(peaks, size, reference_frequency, harmonics, band_preset, band_split_frequency, min_frequency,
+                max_frequency, _weight_type, window_size, max_shifted, non_linear, _normalized);
+  });
   return ConvertSequenceToPyarray(vec);
 }
 
-py::array_t<double> _HPCP(const std::vector<double>& frequencies,
-                          const std::vector<double>& magnitudes,
+py::array_t<double> _HPCP(const DoubleArray& frequencies,
+                          const DoubleArray& magnitudes,
                           unsigned int size,
                           double reference_frequency,
                           unsigned int harmonics,
@@ -136,25 +215,33 @@ py::array_t<double> _HPCP(const std::vector<double>& frequencies,
                           bool max_shifted,
                           bool non_linear,
                           std::string _normalized) {
-  const std::vector<double> vec =
-      HPCP(frequencies, magnitudes, size, reference_frequency, harmonics, band_preset, band_split_frequency,
-           min_frequency, max_frequency, _weight_type, window_size, max_shifted, non_linear, _normalized);
+  Span<const double> frequencies_span = ConvertPyarrayToSpan(frequencies);
+  Span<const double> magnitudes_span = ConvertPyarrayToSpan(magnitudes);
+  std::vector<double> vec = CallWithoutGil([&] {
+    return HPCP(frequencies_span, magnitudes_span, size, reference_frequency, harmonics, band_preset,
+                band_split_frequency, min_frequency, max_frequency, _weight_type, window_size, max_shifted, non_linear,
+                _normalized);
+  });
   return ConvertSequenceToPyarray(vec);
 }
 
-py::dict _EstimateKey(const std::vector<double>& pcp,
+py::dict _EstimateKey(const DoubleArray& pcp,
                       const bool use_polphony,
                       const bool use_three_chords,
                       const unsigned int num_harmonics,
                       const double slope,
                       const std::string profile_type,
                       const bool use_maj_min) {
-  KeyOutput key_output =
-      EstimateKey(pcp, use_polphony, use_three_chords, num_harmonics, slope, profile_type, use_maj_min);
+  // A pcp only has a few dozen bins, a single bulk copy is cheaper than threading a view through EstimateKey.
+  Span<const double> pcp_span = ConvertPyarrayToSpan(pcp);
+  KeyOutput key_output = CallWithoutGil([&] {
+    return EstimateKey(std::vector<double>(pcp_span.begin(), pcp_span.end()), use_polphony, use_three_chords,
+                       num_harmonics, slope, profile_type, use_maj_min);
+  });
   return ConvertKeyOutputToPyDict(key_output);
 }
 
-py::dict _DetectKey(const std::vector<std::vector<double>>& normalized_samples,
+py::dict _DetectKey(const DoubleArray& normalized_samples,
                     double sample_rate,
                     const std::string profile_type,
                     const bool use_polphony,
@@ -167,12 +254,134 @@ py::dict _DetectKey(const std::vector<std::vector<double>>& normalized_samples,
                     const int hop_size,
                     const std::function<std::vector<double>(const std::vector<double>&)>& window_type_func,
                     unsigned int max_num_peaks,
-                    double window_size) {
-  KeyOutput key_output =
-      DetectKey(normalized_samples, sample_rate, profile_type, use_polphony, use_three_chords, num_harmonics, slope,
-                use_maj_min, pcp_size, frame_size, hop_size, window_type_func, max_num_peaks, window_size);
+                    double window_size,
+                    unsigned int early_stop_interval,
+                    unsigned int early_stop_stable_checks,
+                    double early_stop_tolerance,
+                    double analysis_sample_rate) {
+  std::vector<Span<const double>> channels = ConvertPyarrayToRowSpans(normalized_samples);
+  KeyOutput key_output = CallWithoutGil([&] {
+    // A single channel is analysed in place, only multichannel audio is mixed down into a new buffer.
+    std::vector<double> mixed_samples;
+    Span<const double> mono_samples;
+    if (channels.size() == 1) {
+      mono_samples = channels[0];
+    } else {
+      mixed_samples = MonoMixer(channels);
+      mono_samples = mixed_samples;
+    }
+    return DetectKey(mono_samples, sample_rate, profile_type, use_polphony, use_three_chords, num_harmonics, slope,
+                     use_maj_min, pcp_size, frame_size, hop_size, window_type_func, max_num_peaks, window_size,
+                     early_stop_interval, early_stop_stable_checks, early_stop_tolerance, analysis_sample_rate);
+  });
   return ConvertKeyOutputToPyDict(key_output);
 }
 
+py::list _DetectKeyBatch(const std::vector<std::string>& file_paths,
+                         unsigned int n_jobs,
+                         unsigned int max_files_in_flight,
+                         const std::string profile_type,
+                         unsigned int max_num_peaks,
+                         unsigned int early_stop_interval,
+                         unsigned int early_stop_stable_checks,
+                         double early_stop_tolerance,
+                         double analysis_sample_rate) {
+  auto detect_key = [=](Span<const double> mono_samples, double sample_rate) {
+    return DetectKey(mono_samples, sample_rate, profile_type, true, true, 4, 0.6, false, 36, 4096, 512,
+                     BlackmanHarris62dB, max_num_peaks, .5, early_stop_interval, early_stop_stable_checks,
+                     early_stop_tolerance, analysis_sample_rate);
+  };
+
+  std::vector<KeyBatchResult> results;
+  {
+    // Nothing in the batch touches Python objects, so other Python threads can run meanwhile.
+    py::gil_scoped_release release;
+    results = DetectKeyBatch(file_paths, n_jobs, max_files_in_flight, detect_key);
+  }
+
+  py::list output;
+  for (const KeyBatchResult& result : results) {
+    py::dict result_dict = result.ok ? ConvertKeyOutputToPyDict(result.key_output) : py::dict();
+    result_dict["file_path"] = result.file_path;
+    result_dict["error"] = result.ok ? py::object(py::none()) : py::object(py::str(result.error));
+    output.append(result_dict);
+  }
+  return output;
+}
+
+double _BPMOverWindow(const DoubleArray& samples,
+                      double sample_rate,
+                      unsigned int window_seconds,
+                      const std::string wavelet_name,
+                      unsigned int levels,
+                      double min_bpm,
+                      double max_bpm) {
+  return BPMOverWindow(ConvertPyarrayToSpan(samples), sample_rate, window_seconds, wavelet_name, levels, min_bpm,
+                       max_bpm);
+}
+
+Framecutter _Framecutter(const py::object& buffer,
+                         int frame_size,
+                         int hop_size,
+                         bool start_from_center,
+                         bool last_frame_to_end_of_file,
+                         double valid_frame_threshold_ratio) {
+  // Only a buffer that needed no conversion can be read in place, it is kept alive by the binding. A converted
+  // array would be freed on return, so the Framecutter keeps a copy of it instead.
+  DoubleArray array = DoubleArray::ensure(buffer);
+  if (!array) throw std::runtime_error("Framecutter: buffer must be convertible to an array of floats.");
+  Span<const double> buffer_span = ConvertPyarrayToSpan(array);
+  if (array.ptr() == buffer.ptr()) {
+    return Framecutter(buffer_span, frame_size, hop_size, start_from_center, last_frame_to_end_of_file,
+                       valid_frame_threshold_ratio);
+  }
+  return Framecutter(std::vector<double>(buffer_span.begin(), buffer_span.end()), frame_size, hop_size,
+                     start_from_center, last_frame_to_end_of_file, valid_frame_threshold_ratio);
+}
+
+py::array_t<double> _FramecutterFrames(const py::object& framecutter_object) {
+  const Framecutter& framecutter = framecutter_object.cast<const Framecutter&>();
+  const std::vector<int>& starts = framecutter.frame_starts();
+  Span<const double> buffer = framecutter.buffer();
+  const int frame_size = framecutter.frame_size();
+
+  const std::vector<py::ssize_t> shape{ static_cast<py::ssize_t>(starts.size()), frame_size };
+  if (starts.empty()) return py::array_t<double>(shape);
+  const std::vector<py::ssize_t> strides{ static_cast<py::ssize_t>(framecutter.hop_size() * sizeof(double)),
+                                          static_cast<py::ssize_t>(sizeof(double)) };
+
+  // A numpy array has a single stride per axis, so either every frame is a view of the buffer or none is.
+  const int pad_before = std::max(0, -starts.front());
+  const int pad_after = std::max(0, starts.back() + frame_size - static_cast<int>(buffer.size()));
+  py::array_t<double> frames;
+  if (pad_before == 0 && pad_after == 0) {
+    // The Framecutter keeps its buffer alive, so it is the owner of the view.
+    frames = py::array_t<double>(shape, strides, buffer.data() + starts.front(), framecutter_object);
+  } else {
+    // Zero-pad the signal once, the frames are a view of the padded copy.
+    std::vector<double>* padded = new std::vector<double>(pad_before + buffer.size() + pad_after, 0.);
+    std::copy(buffer.begin(), buffer.end(), padded->begin() + pad_before);
+    py::capsule capsule(padded, [](void* p) { delete reinterpret_cast<std::vector<double>*>(p); });
+    frames = py::array_t<double>(shape, strides, padded->data() + pad_before + starts.front(), capsule);
+  }
+  // Frames overlap each other (and the buffer), writing to one would change the others.
+  py::detail::array_proxy(frames.ptr())->flags &= ~py::detail::npy_api::NPY_ARRAY_WRITEABLE_;
+  return frames;
+}
+
+py::dict _AnalyzeTrack(const std::string& file_path,
+                       const std::string profile_type,
+                       const int frame_size,
+                       const int hop_size,
+                       double min_bpm,
+                       double max_bpm) {
+  TrackAnalysis track_analysis =
+      CallWithoutGil([&] { return AnalyzeTrack(file_path, profile_type, frame_size, hop_size, min_bpm, max_bpm); });
+  py::dict track_analysis_dict = ConvertKeyOutputToPyDict(track_analysis);
+  track_analysis_dict["bpm"] = track_analysis.bpm;
+  track_analysis_dict["beat_times"] = track_analysis.beat_times;
+  return track_analysis_dict;
+}
+
 }  // namespace python
 }  // namespace musher
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include <string>
 #include <vector>
 
+#include "src/core/framecutter.h"
 #include "src/python/utils.h"
 
 using namespace musher::core;
@@ -12,30 +13,42 @@ namespace py = pybind11;
 namespace musher {
 namespace python {
 
+void _EnableInstrumentation(bool enabled);
+
+py::dict _InstrumentationStats();
+
+void _ResetInstrumentation();
+
+void _StartTrace();
+
+size_t _StopTrace(const std::string& file_path);
+
 py::array_t<uint8_t> _LoadAudioFile(const std::string& file_path);
 
-py::dict _DecodeWavFromData(std::vector<uint8_t>& file_data);
+py::dict _DecodeWavFromData(const ByteArray& file_data, bool mono_downmix);
 
-py::dict _DecodeWavFromFile(const std::string file_path);
+py::dict _DecodeWavFromFile(const std::string file_path, bool mono_downmix);
 
-py::dict _DecodeMp3FromFile(const std::string file_path);
+py::dict _DecodeMp3FromFile(const std::string file_path, bool mono_downmix);
 
-py::array_t<double> _MonoMixer(const std::vector<std::vector<double>>& normalized_samples);
+py::array_t<double> _MonoMixer(const DoubleArray& normalized_samples);
 
-py::array_t<double> _Windowing(const std::vector<double>& audio_frame,
+py::array_t<double> _Windowing(const DoubleArray& audio_frame,
                                const std::function<std::vector<double>(const std::vector<double>&)>& window_type_func,
                                unsigned zero_padding_size,
                                bool zero_phase,
                                bool _normalize);
 
-py::array_t<double> _Square(const std::vector<double>& window);
-py::array_t<double> _BlackmanHarris(const std::vector<double>& window, double a0, double a1, double a2, double a3);
-py::array_t<double> _BlackmanHarris62dB(const std::vector<double>& window);
-py::array_t<double> _BlackmanHarris92dB(const std::vector<double>& window);
+py::array_t<double> _Square(const DoubleArray& window);
+py::array_t<double> _BlackmanHarris(const DoubleArray& window, double a0, double a1, double a2, double a3);
+py::array_t<double> _BlackmanHarris62dB(const DoubleArray& window);
+py::array_t<double> _BlackmanHarris92dB(const DoubleArray& window);
+
+py::array_t<double> _ConvertToFrequencySpectrum(const DoubleArray& audio_frame);
 
-py::array_t<double> _ConvertToFrequencySpectrum(const std::vector<double>& audio_frame);
+py::array_t<double> _ConvertToFrequencySpectra(const DoubleArray& audio_frames, unsigned int num_threads);
 
-std::vector<std::tuple<double, double>> _PeakDetect(const std::vector<double>& inp,
+std::vector<std::tuple<double, double>> _PeakDetect(const DoubleArray& inp,
                                                     double threshold,
                                                     bool interpolate,
                                                     std::string sort_by,
@@ -44,7 +57,7 @@ std::vector<std::tuple<double, double>> _PeakDetect(const std::vector<double>& i
                                                     int min_pos,
                                                     int max_pos);
 
-std::vector<std::tuple<double, double>> _SpectralPeaks(const std::vector<double>& input_spectrum,
+std::vector<std::tuple<double, double>> _SpectralPeaks(const DoubleArray& input_spectrum,
                                                        double threshold,
                                                        std::string sort_by,
                                                        unsigned int max_num_peaks,
@@ -65,8 +78,8 @@ py::array_t<double> _HPCPFromPeaks(const std::vector<std::tuple<double, double>>
                                    bool non_linear,
                                    std::string _normalized);
 
-py::array_t<double> _HPCP(const std::vector<double>& frequencies,
-                          const std::vector<double>& magnitudes,
+py::array_t<double> _HPCP(const DoubleArray& frequencies,
+                          const DoubleArray& magnitudes,
                           unsigned int size,
                           double reference_frequency,
                           unsigned int harmonics,
@@ -80,7 +93,7 @@ py::array_t<double> _HPCP(const std::vector<double>& frequencies,
                           bool non_linear,
                           std::string _normalized);
 
-py::dict _EstimateKey(const std::vector<double>& pcp,
+py::dict _EstimateKey(const DoubleArray& pcp,
                       const bool use_polphony,
                       const bool use_three_chords,
                       const unsigned int num_harmonics,
@@ -88,7 +101,7 @@ py::dict _EstimateKey(const std::vector<double>& pcp,
                       const std::string profile_type,
                       const bool use_maj_min);
 
-py::dict _DetectKey(const std::vector<std::vector<double>>& normalized_samples,
+py::dict _DetectKey(const DoubleArray& normalized_samples,
                     double sample_rate,
                     const std::string profile_type,
                     const bool use_polphony,
@@ -101,6 +114,44 @@ py::dict _DetectKey(const std::vector<std::vector<double>>& normalized_samples,
                     const int hop_size,
                     const std::function<std::vector<double>(const std::vector<double>&)>& window_type_func,
                     unsigned int max_num_peaks,
-                    double window_size);
+                    double window_size,
+                    unsigned int early_stop_interval,
+                    unsigned int early_stop_stable_checks,
+                    double early_stop_tolerance,
+                    double analysis_sample_rate);
+
+py::list _DetectKeyBatch(const std::vector<std::string>& file_paths,
+                         unsigned int n_jobs,
+                         unsigned int max_files_in_flight,
+                         const std::string profile_type,
+                         unsigned int max_num_peaks,
+                         unsigned int early_stop_interval,
+                         unsigned int early_stop_stable_checks,
+                         double early_stop_tolerance,
+                         double analysis_sample_rate);
+
+double _BPMOverWindow(const DoubleArray& samples,
+                      double sample_rate,
+                      unsigned int window_seconds,
+                      const std::string wavelet_name,
+                      unsigned int levels,
+                      double min_bpm,
+                      double max_bpm);
+
+Framecutter _Framecutter(const py::object& buffer,
+                         int frame_size,
+                         int hop_size,
+                         bool start_from_center,
+                         bool last_frame_to_end_of_file,
+                         double valid_frame_threshold_ratio);
+
+py::array_t<double> _FramecutterFrames(const py::object& framecutter_object);
+
+py::dict _AnalyzeTrack(const std::string& file_path,
+                       const std::string profile_type,
+                       const int frame_size,
+                       const int hop_size,
+                       double min_bpm,
+                       double max_bpm);
 }  // namespace python
 }  // namespace musher
\ No newline at end of file
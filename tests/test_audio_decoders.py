@@ -35,6 +35,22 @@ def test_decode_wav_from_data(test_data_dir: str):
     assert actual_normalized_samples_sum == expected_normalized_samples_sum
 
 
+def test_decode_wav_from_read_only_buffer(test_data_dir: str):
+    """Wav data in a read-only buffer, such as bytes read from a file, is decoded in place.
+    """
+    audio_file_path = os.path.join(
+        test_data_dir, "audio_files", "CantinaBand3sec.wav")
+    with open(audio_file_path, "rb") as audio_file:
+        file_data = np.frombuffer(audio_file.read(), dtype=np.uint8)
+
+    actual_decoded_wav = musher.decode_wav_from_data(file_data)
+    expected_decoded_wav = musher.decode_wav_from_file(audio_file_path)
+
+    assert actual_decoded_wav["sample_rate"] == expected_decoded_wav["sample_rate"]
+    assert np.array_equal(actual_decoded_wav["normalized_samples"],
+                          expected_decoded_wav["normalized_samples"])
+
+
 def test_decode_wav_from_file(test_data_dir: str):
     audio_file_path = os.path.join(
         test_data_dir, "audio_files", "mozart_c_major_30sec.wav")
@@ -94,6 +110,38 @@ def test_decode_mp3_from_file(test_data_dir: str):
         expected_normalized_samples_sum, expected_normalized_samples_sum_linux_i686)
 
 
+def test_decode_mp3_from_file_mono_downmix(test_data_dir: str):
+    audio_file_path = os.path.join(
+        test_data_dir, "audio_files", "mozart_c_major_30sec.mp3")
+    decoded_mp3 = musher.decode_mp3_from_file(audio_file_path)
+    actual_decoded_mp3 = musher.decode_mp3_from_file(
+        audio_file_path, mono_downmix=True)
+
+    expected_normalized_samples = musher.mono_mixer(
+        decoded_mp3["normalized_samples"])
+
+    assert actual_decoded_mp3["channels"] == 1
+    assert actual_decoded_mp3["mono"]
+    assert not actual_decoded_mp3["stereo"]
+    assert len(actual_decoded_mp3["normalized_samples"]) == 1
+    np.testing.assert_array_equal(
+        actual_decoded_mp3["normalized_samples"][0], expected_normalized_samples)
+
+
+def test_decode_mp3_from_file_samples_array(test_data_dir: str):
+    audio_file_path = os.path.join(
+        test_data_dir, "audio_files", "mozart_c_major_30sec.mp3")
+    decoded_mp3 = musher.decode_mp3_from_file(audio_file_path)
+    normalized_samples = decoded_mp3["normalized_samples"]
+
+    assert normalized_samples.shape == (
+        decoded_mp3["channels"], decoded_mp3["samples_per_channel"])
+    assert normalized_samples.dtype == np.float64
+    assert normalized_samples.flags["C_CONTIGUOUS"]
+    # The array is a view of the decoded buffer, not a copy of it.
+    assert not normalized_samples.flags["OWNDATA"]
+
+
 # OTHERS
 
 def test_load_audio_file(test_data_dir: str):
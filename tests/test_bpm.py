@@ -0,0 +1,38 @@
+import os
+
+import musher
+
+
+def test_bpm_over_window(test_data_dir: str):
+    """Detect the tempo of a file with a known BPM.
+    """
+    audio_file_path = os.path.join(
+        test_data_dir, "audio_files", "126bpm.mp3")
+    mp3_decoded = musher.decode_mp3_from_file(
+        audio_file_path, mono_downmix=True)
+
+    actual_bpm = musher.bpm_over_window(
+        mp3_decoded["normalized_samples"][0], mp3_decoded["sample_rate"])
+
+    assert actual_bpm == 125.0
+
+
+def test_analyze_track(test_data_dir: str):
+    """Analyze key and tempo together, the key matches detect_key.
+    """
+    audio_file_path = os.path.join(
+        test_data_dir, "audio_files", "126bpm.mp3")
+    mp3_decoded = musher.decode_mp3_from_file(
+        audio_file_path, mono_downmix=True)
+
+    track_analysis = musher.analyze_track(audio_file_path)
+    key_output = musher.detect_key(
+        mp3_decoded["normalized_samples"], mp3_decoded["sample_rate"])
+
+    assert track_analysis["key"] == key_output["key"]
+    assert track_analysis["scale"] == key_output["scale"]
+    assert abs(track_analysis["bpm"] - 126.) < 2.
+    beat_times = track_analysis["beat_times"]
+    assert len(beat_times) > 2
+    mean_beat_interval = (beat_times[-1] - beat_times[0]) / (len(beat_times) - 1)
+    assert abs(60. / mean_beat_interval - 126.) < 2.
@@ -1,3 +1,4 @@
+import numpy as np
 import musher
 
 
@@ -24,3 +25,32 @@ def test_framecutter():
     ]
 
     assert list(actual_framecutter) == expacted_framecutter
+
+
+def test_framecutter_numpy_buffer():
+    buffer = np.arange(1., 8.)
+    expected_frames = list(musher.Framecutter(buffer.tolist(), 4, 2, False, True, 0.))
+
+    # Contiguous float64 buffers are read in place, strided views are copied first, both cut the same frames.
+    assert list(musher.Framecutter(buffer, 4, 2, False, True, 0.)) == expected_frames
+    strided_buffer = np.arange(1., 15.)[::2]
+    assert list(musher.Framecutter(strided_buffer, 4, 2, False, True, 0.)) == expected_frames
+
+
+def test_framecutter_frames():
+    buffer = np.arange(1., 21.)
+
+    # Every frame within the buffer, the frames are a view of it.
+    framecutter = musher.Framecutter(buffer, 4, 2, False, False, 0.)
+    frames = framecutter.frames()
+    assert np.array_equal(frames, list(framecutter))
+    assert np.shares_memory(frames, buffer)
+    assert not frames.flags.writeable
+
+    # Zero-padded edge frames.
+    framecutter = musher.Framecutter(buffer, 5, 3, True, False, 0.)
+    frames = framecutter.frames()
+    expected_frames = list(framecutter)
+    assert frames.shape == (len(expected_frames), 5)
+    assert np.array_equal(frames, expected_frames)
+    assert not np.shares_memory(frames, buffer)
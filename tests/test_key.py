@@ -1,5 +1,7 @@
 import os
+import json
 import math
+from concurrent.futures import ThreadPoolExecutor
 
 import musher
 
@@ -78,3 +80,113 @@ def test_estimate_key(test_data_dir: str):
                         expected_key_output['strength'], rel_tol=1e-6)
     assert math.isclose(actual_key_output['first_to_second_relative_strength'],
                         expected_key_output['first_to_second_relative_strength'], rel_tol=1e-6)
+
+
+def test_detect_key_batch(test_data_dir: str):
+    """Detect the key of several files in parallel, with per file errors.
+    """
+    audio_file_path = os.path.join(
+        test_data_dir, "audio_files", "mozart_c_major_30sec.mp3")
+    missing_file_path = os.path.join(
+        test_data_dir, "audio_files", "does_not_exist.mp3")
+    file_paths = [audio_file_path, missing_file_path, audio_file_path]
+
+    results = musher.detect_key_batch(file_paths, n_jobs=2, profile_type="Temperley")
+
+    mp3_decoded = musher.decode_mp3_from_file(audio_file_path)
+    expected_key_output = musher.detect_key(
+        mp3_decoded["normalized_samples"], mp3_decoded["sample_rate"], "Temperley")
+
+    assert [result['file_path'] for result in results] == file_paths
+    assert results[1]['error'] is not None
+    assert 'key' not in results[1]
+    for result in (results[0], results[2]):
+        assert result['error'] is None
+        assert result['key'] == expected_key_output['key']
+        assert result['scale'] == expected_key_output['scale']
+        assert math.isclose(result['strength'],
+                            expected_key_output['strength'], rel_tol=1e-9)
+
+
+def test_detect_key_threads(test_data_dir: str):
+    """detect_key releases the GIL, so it can run from several Python threads at once.
+    """
+    audio_file_path = os.path.join(
+        test_data_dir, "audio_files", "mozart_c_major_30sec.mp3")
+    mp3_decoded = musher.decode_mp3_from_file(audio_file_path, mono_downmix=True)
+    normalized_samples = mp3_decoded["normalized_samples"]
+    sample_rate = mp3_decoded["sample_rate"]
+
+    expected_key_output = musher.detect_key(normalized_samples, sample_rate, "Temperley")
+    with ThreadPoolExecutor(max_workers=2) as executor:
+        key_outputs = list(executor.map(
+            lambda _: musher.detect_key(normalized_samples, sample_rate, "Temperley"), range(2)))
+
+    for key_output in key_outputs:
+        assert key_output == expected_key_output
+
+
+def test_detect_key_instrumentation(test_data_dir: str):
+    audio_file_path = os.path.join(
+        test_data_dir, "audio_files", "impulses_1second_44100.wav")
+    wav_decoded = musher.decode_wav_from_file(audio_file_path)
+
+    musher.reset_instrumentation()
+    musher.enable_instrumentation()
+    try:
+        key_output = musher.detect_key(
+            wav_decoded["normalized_samples"], wav_decoded["sample_rate"])
+    finally:
+        musher.enable_instrumentation(False)
+    stats = musher.instrumentation_stats()
+
+    expected_calls = key_output["frames_processed"] if musher.instrumentation_compiled() else 0
+    for stage in ("windowing", "spectrum", "spectral_peaks", "hpcp"):
+        assert stats[stage]["calls"] == expected_calls
+        assert stats[stage]["frames"] == expected_calls
+    assert set(stats["detect_key"]) == {"calls", "seconds", "frames", "output_bytes"}
+
+
+def test_detect_key_batch_trace(test_data_dir: str, tmp_path):
+    """Trace a batch run and write it as a Chrome trace event file.
+    """
+    audio_file_path = os.path.join(
+        test_data_dir, "audio_files", "impulses_1second_44100.wav")
+    trace_path = str(tmp_path / "trace.json")
+
+    musher.start_trace()
+    try:
+        musher.detect_key_batch([audio_file_path, audio_file_path], n_jobs=2)
+    finally:
+        num_events = musher.stop_trace(trace_path)
+
+    with open(trace_path) as trace_file:
+        trace = json.load(trace_file)
+    events = [event for event in trace["traceEvents"] if event["ph"] == "X"]
+    assert len(events) == num_events
+    if not musher.instrumentation_compiled():
+        assert num_events == 0
+        return
+    assert sum(event["name"] == "detect_key" for event in events) == 2
+    assert all(event["args"]["file"] == audio_file_path for event in events)
+
+
+def test_stop_trace_while_analysing(test_data_dir: str, tmp_path):
+    """Stop a trace while another thread is still analysing.
+    """
+    audio_file_path = os.path.join(
+        test_data_dir, "audio_files", "mozart_c_major_30sec.mp3")
+    mp3_decoded = musher.decode_mp3_from_file(audio_file_path, mono_downmix=True)
+    trace_path = str(tmp_path / "trace.json")
+
+    musher.start_trace()
+    with ThreadPoolExecutor(max_workers=1) as executor:
+        future = executor.submit(musher.detect_key, mp3_decoded["normalized_samples"],
+                                 mp3_decoded["sample_rate"], "Temperley")
+        num_events = musher.stop_trace(trace_path)
+        key_output = future.result()
+
+    with open(trace_path) as trace_file:
+        trace = json.load(trace_file)
+    assert len([event for event in trace["traceEvents"] if event["ph"] == "X"]) == num_events
+    assert key_output["key"] == "C"
@@ -1,5 +1,6 @@
 import os
 
+import numpy as np
 import musher
 
 
@@ -18,3 +19,11 @@ def test_mono_mixer(test_data_dir: str):
 
     assert actual_mixed_audio_len == expected_mixed_audio_len
     assert actual_mixed_audio_sum == expected_mixed_audio_sum
+
+
+def test_mono_mixer_arrays():
+    left = np.array([1., 2., 3., 4.])
+    right = np.array([3., 2., 1., 0.])
+
+    assert np.array_equal(musher.mono_mixer(np.stack([left, right])), [2., 2., 2., 2.])
+    assert np.array_equal(musher.mono_mixer(left), left)
@@ -10,3 +10,21 @@ def test_spectrum():
     expected_spectrum = [100.] + [0.] * int((inp_size / 2))
 
     assert np.array_equal(actual_spectrum, expected_spectrum)
+
+
+def test_spectra_num_threads():
+    frames = [[float(i * j % 7) for j in range(64)] for i in range(10)]
+    previous_num_threads = musher.get_num_threads()
+
+    musher.set_num_threads(2)
+    assert musher.get_num_threads() == 2
+    spectra = musher.convert_to_frequency_spectra(frames)
+    single_thread_spectra = musher.convert_to_frequency_spectra(frames, num_threads=1)
+    musher.set_num_threads(previous_num_threads)
+
+    assert isinstance(spectra, np.ndarray)
+    assert spectra.shape == (len(frames), len(musher.convert_to_frequency_spectrum(frames[0])))
+    for frame, spectrum, single_thread_spectrum in zip(frames, spectra, single_thread_spectra):
+        expected_spectrum = musher.convert_to_frequency_spectrum(frame)
+        assert np.allclose(spectrum, expected_spectrum)
+        assert np.allclose(single_thread_spectrum, expected_spectrum)